@@ -63,6 +63,7 @@ extern "C" {
 FLUIDSYNTH_API int fluid_is_soundfont(const char *filename);
 FLUIDSYNTH_API int fluid_is_midifile(const char *filename);
 FLUIDSYNTH_API void fluid_free(void* ptr);
+FLUIDSYNTH_API unsigned int fluid_get_alloc_count(void);
 
 
 #ifdef __cplusplus
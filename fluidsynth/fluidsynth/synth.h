@@ -182,6 +182,9 @@ FLUIDSYNTH_API float fluid_synth_get_gain(fluid_synth_t *synth);
 FLUIDSYNTH_API int fluid_synth_set_polyphony(fluid_synth_t *synth, int polyphony);
 FLUIDSYNTH_API int fluid_synth_get_polyphony(fluid_synth_t *synth);
 FLUIDSYNTH_API int fluid_synth_get_active_voice_count(fluid_synth_t *synth);
+FLUIDSYNTH_API int fluid_synth_set_voice_cap(fluid_synth_t *synth, int cap);
+FLUIDSYNTH_API int fluid_synth_get_voice_cap(fluid_synth_t *synth);
+FLUIDSYNTH_API int fluid_synth_stop_quiet_voices(fluid_synth_t *synth, float level, int max_count);
 FLUIDSYNTH_API int fluid_synth_get_internal_bufsize(fluid_synth_t *synth);
 
 FLUIDSYNTH_API
@@ -196,6 +199,7 @@ enum fluid_interp
     FLUID_INTERP_LINEAR = 1,      /**< Straight-line interpolation: A bit slower, reasonable audio quality */
     FLUID_INTERP_4THORDER = 4,    /**< Fourth-order interpolation, good quality, the default */
     FLUID_INTERP_7THORDER = 7,    /**< Seventh-order interpolation */
+    FLUID_INTERP_SINC = 16,       /**< Windowed sinc interpolation, highest quality, number of points set by synth.sinc-taps */
 
     FLUID_INTERP_DEFAULT = FLUID_INTERP_4THORDER, /**< Default interpolation method */
     FLUID_INTERP_HIGHEST = FLUID_INTERP_7THORDER, /**< Highest interpolation method */
@@ -235,6 +239,112 @@ FLUIDSYNTH_API int fluid_synth_tuning_dump(fluid_synth_t *synth, int bank, int p
 FLUIDSYNTH_API double fluid_synth_get_cpu_load(fluid_synth_t *synth);
 const char *fluid_synth_error(fluid_synth_t *synth);
 
+/**
+ * Rendering stages timed by the synth, see fluid_synth_get_stage_stats().
+ */
+enum fluid_synth_stage
+{
+    FLUID_SYNTH_STAGE_WRITE,      /**< Write calls as a whole, including all stages below */
+    FLUID_SYNTH_STAGE_BLOCKS,     /**< Rendering of internal blocks, including the stages below */
+    FLUID_SYNTH_STAGE_CLEAR,      /**< Clearing the mix buffers */
+    FLUID_SYNTH_STAGE_VOICES,     /**< Voice synthesis and mixing, including the filters */
+    FLUID_SYNTH_STAGE_FILTER,     /**< Resonant filters of the voices (single threaded rendering only) */
+    FLUID_SYNTH_STAGE_REVERB,     /**< Reverb unit */
+    FLUID_SYNTH_STAGE_CHORUS,     /**< Chorus unit */
+    FLUID_SYNTH_STAGE_LAST        /**< @internal Value defines the count of rendering stages (#fluid_synth_stage) @warning Only valid in context of the fluidsynth version it was compiled against */
+};
+
+/**
+ * Time spent in a rendering stage, see fluid_synth_get_stage_stats().
+ * Cycles are CPU time stamp counter ticks where available, nanoseconds
+ * otherwise.
+ */
+typedef struct
+{
+    unsigned long long cycles;      /**< Accumulated cycles of all passes */
+    unsigned long long max_cycles;  /**< Cycles of the longest pass */
+    unsigned int count;             /**< Count of passes */
+} fluid_stage_stats_t;
+
+FLUIDSYNTH_API int fluid_synth_get_stage_stats(fluid_synth_t *synth,
+        fluid_stage_stats_t *stats, int count, int reset);
+
+/**
+ * Rendering cost of the voices of a MIDI channel, see
+ * fluid_synth_get_channel_costs().
+ */
+typedef struct
+{
+    unsigned long long cycles;      /**< Cycles spent rendering the voices of the channel, see #fluid_stage_stats_t */
+    unsigned long long samples;     /**< Samples rendered by the voices of the channel */
+    double share;                   /**< Fraction of the voice rendering cycles of all channels */
+    int voices;                     /**< Voices rendered by the last rendering pass */
+    int peak_voices;                /**< Highest count of voices rendered by one pass */
+    int bank;                       /**< Bank of the preset of the most recently started voice, or -1 */
+    int program;                    /**< Program of the preset of the most recently started voice, or -1 */
+} fluid_channel_cost_t;
+
+FLUIDSYNTH_API void fluid_synth_set_cost_accounting(fluid_synth_t *synth, int on);
+FLUIDSYNTH_API int fluid_synth_get_channel_costs(fluid_synth_t *synth,
+        fluid_channel_cost_t *costs, int count, int reset);
+
+/**
+ * Kinds of trace records, see fluid_synth_read_trace().
+ */
+enum fluid_trace_type
+{
+    FLUID_TRACE_STAGE,        /**< A pass of rendering stage 'arg' (#fluid_synth_stage), from 'start' to 'end' */
+    FLUID_TRACE_EVENT,        /**< A MIDI message was dispatched, 'arg' holds its bytes, the first one in the lowest 8 bits */
+    FLUID_TRACE_VOICE_START,  /**< A voice for key 'arg' was started */
+    FLUID_TRACE_VOICE_STEAL,  /**< The voice of key 'arg' was killed to make room for a new one */
+    FLUID_TRACE_VOICE_STOP    /**< A voice finished and was returned to the pool */
+};
+
+/**
+ * A record of the trace of the synthesis thread, see fluid_synth_read_trace().
+ */
+typedef struct
+{
+    unsigned long long start;   /**< Time stamp, see #fluid_stage_stats_t and fluid_synth_get_cycles() */
+    unsigned long long end;     /**< End of a stage, equal to 'start' for all other records */
+    int type;                   /**< #fluid_trace_type */
+    int chan;                   /**< MIDI channel, or -1 */
+    int arg;                    /**< Depends on 'type' */
+} fluid_trace_record_t;
+
+FLUIDSYNTH_API int fluid_synth_set_tracing(fluid_synth_t *synth, int size);
+FLUIDSYNTH_API int fluid_synth_read_trace(fluid_synth_t *synth,
+        fluid_trace_record_t *records, int count, unsigned int *dropped);
+FLUIDSYNTH_API unsigned long long fluid_synth_get_cycles(void);
+
+/**
+ * Kinds of memory accounted, see fluid_synth_get_memory_stats().
+ */
+enum fluid_memory_type
+{
+    FLUID_MEMORY_SAMPLES_SHARED,  /**< Sample data of the sample cache, shared by all synths which load the same SoundFont */
+    FLUID_MEMORY_SAMPLES_PRIVATE, /**< Sample data owned by one synth, i.e. the mipmaps of its samples */
+    FLUID_MEMORY_PRESETS,         /**< Presets, instruments, zones and modulators of the loaded SoundFonts */
+    FLUID_MEMORY_VOICES,          /**< Voices and rvoices */
+    FLUID_MEMORY_MIXER,           /**< Mixing buffers of the audio and effects channels, and the voice lists of the mixer */
+    FLUID_MEMORY_FX,              /**< Delay lines of the reverb and chorus units */
+    FLUID_MEMORY_EVENTS,          /**< Event queues between the API and the synthesis thread, and the trace */
+    FLUID_MEMORY_LAST             /**< @internal Value defines the count of memory types (#fluid_memory_type) @warning Only valid in context of the fluidsynth version it was compiled against */
+};
+
+/**
+ * Memory allocated by fluidsynth, see fluid_synth_get_memory_stats() and
+ * fluid_get_memory_stats().
+ */
+typedef struct
+{
+    unsigned long long bytes[FLUID_MEMORY_LAST];  /**< Bytes allocated, by #fluid_memory_type */
+    unsigned long long locked;                    /**< Part of 'bytes' pinned to RAM with mlock(), the rest is pageable */
+} fluid_memory_stats_t;
+
+FLUIDSYNTH_API int fluid_synth_get_memory_stats(fluid_synth_t *synth, fluid_memory_stats_t *stats);
+FLUIDSYNTH_API void fluid_get_memory_stats(fluid_memory_stats_t *stats);
+
 
 /* Default modulators */
 
@@ -272,6 +382,21 @@ FLUIDSYNTH_API int fluid_synth_process(fluid_synth_t *synth, int len,
                                        int nfx, float *fx[],
                                        int nout, float *out[]);
 
+/**
+ * Raw MIDI channel message applied at a frame of a block,
+ * see fluid_synth_write_float_midi().
+ */
+typedef struct
+{
+    unsigned int frame;     /**< Offset from the start of the block, in frames */
+    unsigned char data[3];  /**< Status byte and up to two data bytes */
+} fluid_midi_raw_event_t;
+
+FLUIDSYNTH_API int fluid_synth_write_float_midi(fluid_synth_t *synth, int len,
+        const fluid_midi_raw_event_t *events, int nevents,
+        void *lout, int loff, int lincr,
+        void *rout, int roff, int rincr);
+
 
 /* Synthesizer's interface to handle SoundFont loaders */
 
@@ -63,15 +63,13 @@ struct _fluid_adsr_env_t
 
 /* For performance, all functions are inlined */
 
-static FLUID_INLINE void
-fluid_adsr_env_calc(fluid_adsr_env_t *env, int is_volenv)
+/* Skip to the next section of the envelope if necessary.
+   Returns the data of the section to calculate the next value from. */
+static FLUID_INLINE fluid_env_data_t *
+fluid_adsr_env_advance(fluid_adsr_env_t *env, int is_volenv)
 {
-    fluid_env_data_t *env_data;
-    fluid_real_t x;
+    fluid_env_data_t *env_data = &env->data[env->section];
 
-    env_data = &env->data[env->section];
-
-    /* skip to the next section of the envelope if necessary */
     while(env->count >= env_data->count)
     {
         // If we're switching envelope stages from decay to sustain, force the value to be the end value of the previous stage
@@ -85,6 +83,36 @@ fluid_adsr_env_calc(fluid_adsr_env_t *env, int is_volenv)
         env->count = 0;
     }
 
+    return env_data;
+}
+
+/* Store a value that has been calculated from the data returned by
+   fluid_adsr_env_advance(). If it had to be clamped to the range of the
+   section, the envelope moves on to the next section. */
+static FLUID_INLINE void
+fluid_adsr_env_step(fluid_adsr_env_t *env, fluid_real_t x, int clamped)
+{
+    if(clamped)
+    {
+        env->section++;
+        env->count = 0;
+    }
+    else
+    {
+        env->count++;
+    }
+
+    env->val = x;
+}
+
+static FLUID_INLINE void
+fluid_adsr_env_calc(fluid_adsr_env_t *env, int is_volenv)
+{
+    fluid_env_data_t *env_data;
+    fluid_real_t x;
+
+    env_data = fluid_adsr_env_advance(env, is_volenv);
+
     /* calculate the envelope value and check for valid range */
     x = env_data->coeff * env->val + env_data->increment;
 
@@ -519,6 +519,8 @@ static int new_mod_delay_line(fluid_chorus_t *chorus, int delay_length)
         return FLUID_FAILED;
     }
 
+    fluid_memory_account(FLUID_MEMORY_FX, fluid_chorus_get_memory(chorus));
+
     /* clears the buffer:
      - delay line
      - interpolator member: buffer, frac_pos_mod
@@ -597,10 +599,21 @@ delete_fluid_chorus(fluid_chorus_t *chorus)
 {
     fluid_return_if_fail(chorus != NULL);
 
+    fluid_memory_account(FLUID_MEMORY_FX, -(ptrdiff_t)fluid_chorus_get_memory(chorus));
     FLUID_FREE(chorus->line);
     FLUID_FREE(chorus);
 }
 
+/**
+ * Get the bytes allocated for the delay line of the chorus unit.
+ * @param chorus pointer on chorus unit.
+ */
+size_t
+fluid_chorus_get_memory(fluid_chorus_t *chorus)
+{
+    return chorus->line != NULL ? chorus->size * sizeof(fluid_real_t) : 0;
+}
+
 /**
  * Clear the internal delay line and associate filter.
  * @param chorus pointer on chorus unit returned by new_fluid_chorus().
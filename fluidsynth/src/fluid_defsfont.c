@@ -39,8 +39,9 @@ static int unload_preset_samples(fluid_defsfont_t *defsfont, fluid_preset_t *pre
 static void unload_sample(fluid_sample_t *sample);
 static int dynamic_samples_preset_notify(fluid_preset_t *preset, int reason, int chan);
 static int dynamic_samples_sample_notify(fluid_sample_t *sample, int reason);
-static int fluid_preset_zone_create_voice_zones(fluid_preset_zone_t *preset_zone);
+static int fluid_preset_zone_create_voice_zones(fluid_preset_zone_t *preset_zone, fluid_defsfont_t *defsfont);
 static fluid_inst_t *find_inst_by_idx(fluid_defsfont_t *defsfont, int idx);
+static void fluid_defsfont_account(fluid_defsfont_t *defsfont, size_t bytes);
 
 
 /***************************************************************
@@ -99,6 +100,7 @@ fluid_sfont_t *fluid_defsfloader_load(fluid_sfloader_t *loader, const char *file
     }
 
     fluid_sfont_set_data(sfont, defsfont);
+    sfont->get_memory = fluid_defsfont_sfont_get_memory;
 
     defsfont->sfont = sfont;
 
@@ -150,6 +152,11 @@ fluid_preset_t *fluid_defsfont_sfont_iteration_next(fluid_sfont_t *sfont)
     return fluid_defsfont_iteration_next(fluid_sfont_get_data(sfont));
 }
 
+void fluid_defsfont_sfont_get_memory(fluid_sfont_t *sfont, fluid_memory_stats_t *stats)
+{
+    fluid_defsfont_get_memory(fluid_sfont_get_data(sfont), stats);
+}
+
 void fluid_defpreset_preset_delete(fluid_preset_t *preset)
 {
     fluid_defsfont_t *defsfont;
@@ -213,6 +220,7 @@ fluid_defsfont_t *new_fluid_defsfont(fluid_settings_t *settings)
 
     fluid_settings_getint(settings, "synth.lock-memory", &defsfont->mlock);
     fluid_settings_getint(settings, "synth.dynamic-sample-loading", &defsfont->dynamic_samples);
+    fluid_settings_getint(settings, "synth.sample-mipmap-levels", &defsfont->mipmap_levels);
 
     return defsfont;
 }
@@ -285,10 +293,56 @@ int delete_fluid_defsfont(fluid_defsfont_t *defsfont)
 
     delete_fluid_list(defsfont->inst);
 
+    fluid_memory_account(FLUID_MEMORY_PRESETS, -(ptrdiff_t)defsfont->tree_bytes);
+
     FLUID_FREE(defsfont);
     return FLUID_OK;
 }
 
+/*
+ * Account bytes allocated for the samples, presets, instruments, zones and
+ * modulators of a SoundFont. They are all freed together with it.
+ */
+static void fluid_defsfont_account(fluid_defsfont_t *defsfont, size_t bytes)
+{
+    defsfont->tree_bytes += bytes;
+    fluid_memory_account(FLUID_MEMORY_PRESETS, bytes);
+}
+
+/*
+ * Add the memory used by a SoundFont to stats: the sample data it references
+ * in the sample cache, the mipmaps of its samples and its preset tree.
+ */
+void fluid_defsfont_get_memory(fluid_defsfont_t *defsfont, fluid_memory_stats_t *stats)
+{
+    fluid_list_t *list;
+    fluid_sample_t *sample;
+    size_t shared = 0, locked = 0, mipmaps = 0;
+
+    if(defsfont->sampledata != NULL)
+    {
+        fluid_samplecache_get_memory(defsfont->sampledata, &shared, &locked);
+    }
+
+    for(list = defsfont->sample; list; list = fluid_list_next(list))
+    {
+        sample = (fluid_sample_t *) fluid_list_get(list);
+
+        /* individually loaded samples, see delete_fluid_defsfont() */
+        if((sample->data != NULL) && (sample->data != defsfont->sampledata))
+        {
+            fluid_samplecache_get_memory(sample->data, &shared, &locked);
+        }
+
+        mipmaps += fluid_sample_get_mipmap_memory(sample);
+    }
+
+    stats->bytes[FLUID_MEMORY_SAMPLES_SHARED] += shared;
+    stats->bytes[FLUID_MEMORY_SAMPLES_PRIVATE] += mipmaps;
+    stats->bytes[FLUID_MEMORY_PRESETS] += defsfont->tree_bytes;
+    stats->locked += locked;
+}
+
 /*
  * fluid_defsfont_get_name
  */
@@ -404,6 +458,7 @@ int fluid_defsfont_load_all_sampledata(fluid_defsfont_t *defsfont, SFData *sfdat
         }
 
         fluid_voice_optimize_sample(sample);
+        fluid_sample_build_mipmap(sample, defsfont->mipmap_levels);
     }
 
     return FLUID_OK;
@@ -536,6 +591,7 @@ err_exit:
 int fluid_defsfont_add_sample(fluid_defsfont_t *defsfont, fluid_sample_t *sample)
 {
     defsfont->sample = fluid_list_append(defsfont->sample, sample);
+    fluid_defsfont_account(defsfont, sizeof(fluid_sample_t) + sizeof(fluid_list_t));
     return FLUID_OK;
 }
 
@@ -567,6 +623,8 @@ int fluid_defsfont_add_preset(fluid_defsfont_t *defsfont, fluid_defpreset_t *def
     fluid_preset_set_data(preset, defpreset);
 
     defsfont->preset = fluid_list_append(defsfont->preset, preset);
+    fluid_defsfont_account(defsfont, sizeof(fluid_preset_t) + sizeof(fluid_defpreset_t)
+                           + sizeof(fluid_list_t));
 
     return FLUID_OK;
 }
@@ -1033,6 +1091,8 @@ fluid_defpreset_import_sfont(fluid_defpreset_t *defpreset,
             return FLUID_FAILED;
         }
 
+        fluid_defsfont_account(defsfont, sizeof(fluid_preset_zone_t) + FLUID_STRLEN(zone_name) + 1);
+
         if(fluid_preset_zone_import_sfont(zone, sfzone, defsfont) != FLUID_OK)
         {
             delete_fluid_preset_zone(zone);
@@ -1186,7 +1246,7 @@ delete_fluid_preset_zone(fluid_preset_zone_t *zone)
     FLUID_FREE(zone);
 }
 
-static int fluid_preset_zone_create_voice_zones(fluid_preset_zone_t *preset_zone)
+static int fluid_preset_zone_create_voice_zones(fluid_preset_zone_t *preset_zone, fluid_defsfont_t *defsfont)
 {
     fluid_inst_zone_t *inst_zone;
     fluid_sample_t *sample;
@@ -1230,6 +1290,7 @@ static int fluid_preset_zone_create_voice_zones(fluid_preset_zone_t *preset_zone
         voice_zone->range.ignore = FALSE;
 
         preset_zone->voice_zone = fluid_list_append(preset_zone->voice_zone, voice_zone);
+        fluid_defsfont_account(defsfont, sizeof(fluid_voice_zone_t) + sizeof(fluid_list_t));
 
         inst_zone = fluid_inst_zone_next(inst_zone);
     }
@@ -1493,11 +1554,14 @@ fluid_zone_mod_source_import_sfont(unsigned char *src, unsigned char *flags, uns
  * @param zone_name, zone name.
  * @param mod, address of pointer on modulators list to return.
  * @param sfzone, pointer on soundfont zone.
+ * @param defsfont, SoundFont the modulators are accounted to.
  * @return FLUID_OK if success, FLUID_FAILED otherwise.
  */
 static int
-fluid_zone_mod_import_sfont(char *zone_name, fluid_mod_t **mod, SFZone *sfzone)
+fluid_zone_mod_import_sfont(char *zone_name, fluid_mod_t **mod, SFZone *sfzone,
+                            fluid_defsfont_t *defsfont)
 {
+    fluid_mod_t *mod_list;
     fluid_list_t *r;
     int count;
 
@@ -1595,6 +1659,12 @@ fluid_zone_mod_import_sfont(char *zone_name, fluid_mod_t **mod, SFZone *sfzone)
 
     /* checks and removes invalid modulators in modulators list*/
     fluid_zone_check_mod(zone_name, mod);
+
+    for(mod_list = *mod; mod_list != NULL; mod_list = mod_list->next)
+    {
+        fluid_defsfont_account(defsfont, sizeof(fluid_mod_t));
+    }
+
     return FLUID_OK;
 }
 
@@ -1623,14 +1693,14 @@ fluid_preset_zone_import_sfont(fluid_preset_zone_t *zone, SFZone *sfzone, fluid_
             return FLUID_FAILED;
         }
 
-        if(fluid_preset_zone_create_voice_zones(zone) == FLUID_FAILED)
+        if(fluid_preset_zone_create_voice_zones(zone, defsfont) == FLUID_FAILED)
         {
             return FLUID_FAILED;
         }
     }
 
     /* Import the modulators (only SF2.1 and higher) */
-    return fluid_zone_mod_import_sfont(zone->name, &zone->mod, sfzone);
+    return fluid_zone_mod_import_sfont(zone->name, &zone->mod, sfzone, defsfont);
 }
 
 /*
@@ -1753,6 +1823,8 @@ fluid_inst_import_sfont(SFInst *sfinst, fluid_defsfont_t *defsfont)
             return NULL;
         }
 
+        fluid_defsfont_account(defsfont, sizeof(fluid_inst_zone_t) + FLUID_STRLEN(zone_name) + 1);
+
         if(fluid_inst_zone_import_sfont(inst_zone, sfzone, defsfont) != FLUID_OK)
         {
             delete_fluid_inst_zone(inst_zone);
@@ -1774,6 +1846,7 @@ fluid_inst_import_sfont(SFInst *sfinst, fluid_defsfont_t *defsfont)
     }
 
     defsfont->inst = fluid_list_append(defsfont->inst, inst);
+    fluid_defsfont_account(defsfont, sizeof(fluid_inst_t) + sizeof(fluid_list_t));
     return inst;
 }
 
@@ -1902,7 +1975,7 @@ fluid_inst_zone_import_sfont(fluid_inst_zone_t *inst_zone, SFZone *sfzone, fluid
     }
 
     /* Import the modulators (only SF2.1 and higher) */
-    return fluid_zone_mod_import_sfont(inst_zone->name, &inst_zone->mod, sfzone);
+    return fluid_zone_mod_import_sfont(inst_zone->name, &inst_zone->mod, sfzone, defsfont);
 }
 
 /*
@@ -2065,6 +2138,7 @@ static int load_preset_samples(fluid_defsfont_t *defsfont, fluid_preset_t *prese
                     {
                         fluid_sample_sanitize_loop(sample, (sample->end + 1) * sizeof(short));
                         fluid_voice_optimize_sample(sample);
+                        fluid_sample_build_mipmap(sample, defsfont->mipmap_levels);
                     }
                     else
                     {
@@ -2145,6 +2219,8 @@ static void unload_sample(fluid_sample_t *sample)
 
     FLUID_LOG(FLUID_DBG, "Unloading sample '%s'", sample->name);
 
+    fluid_sample_free_mipmap(sample);
+
     if(fluid_samplecache_unload(sample->data) == FLUID_FAILED)
     {
         FLUID_LOG(FLUID_ERR, "Unable to unload sample '%s'", sample->name);
@@ -87,6 +87,7 @@ const char *fluid_defsfont_sfont_get_name(fluid_sfont_t *sfont);
 fluid_preset_t *fluid_defsfont_sfont_get_preset(fluid_sfont_t *sfont, int bank, int prenum);
 void fluid_defsfont_sfont_iteration_start(fluid_sfont_t *sfont);
 fluid_preset_t *fluid_defsfont_sfont_iteration_next(fluid_sfont_t *sfont);
+void fluid_defsfont_sfont_get_memory(fluid_sfont_t *sfont, fluid_memory_stats_t *stats);
 
 
 void fluid_defpreset_preset_delete(fluid_preset_t *preset);
@@ -118,6 +119,8 @@ struct _fluid_defsfont_t
     fluid_list_t *inst;        /* the instruments of this soundfont */
     int mlock;                 /* Should we try memlock (avoid swapping)? */
     int dynamic_samples;       /* Enables dynamic sample loading if set */
+    int mipmap_levels;         /* Number of octave-decimated copies to build per sample */
+    size_t tree_bytes;         /* Bytes allocated for samples, presets, instruments and zones */
 
     fluid_list_t *preset_iter_cur;       /* the current preset in the iteration */
 };
@@ -130,6 +133,7 @@ const char *fluid_defsfont_get_name(fluid_defsfont_t *defsfont);
 fluid_preset_t *fluid_defsfont_get_preset(fluid_defsfont_t *defsfont, int bank, int prenum);
 void fluid_defsfont_iteration_start(fluid_defsfont_t *defsfont);
 fluid_preset_t *fluid_defsfont_iteration_next(fluid_defsfont_t *defsfont);
+void fluid_defsfont_get_memory(fluid_defsfont_t *defsfont, fluid_memory_stats_t *stats);
 int fluid_defsfont_load_sampledata(fluid_defsfont_t *defsfont, SFData *sfdata, fluid_sample_t *sample);
 int fluid_defsfont_load_all_sampledata(fluid_defsfont_t *defsfont, SFData *sfdata);
 
@@ -22,6 +22,45 @@
 #include "fluid_sys.h"
 #include "fluid_conv.h"
 
+/* Largest linear Q that still gives a flat passband (0 dB SoundFont Q) */
+#define FLUID_IIR_FLAT_Q_LIN 0.7072f
+
+/* Cutoff frequency of a wide open filter in Hz, this is the SoundFont
+ * maximum of initialFilterFc (13500 cents) */
+#define FLUID_IIR_OPEN_FRES 19900.0f
+
+/* Lowest output rate at which a wide open lowpass is inaudible */
+#define FLUID_IIR_BYPASS_MIN_RATE 44100.0f
+
+/**
+ * Applies the passband gain of a transparent filter instead of the filter
+ * itself.
+ *
+ * The filter history is set to the steady state the filter would reach for
+ * the last input samples, so that it can take over again without a click
+ * once its cutoff frequency is modulated down.
+ */
+static FLUID_INLINE void
+fluid_iir_filter_apply_bypass(fluid_iir_filter_t *iir_filter,
+                              fluid_real_t *FLUID_RESTRICT dsp_buf, int count)
+{
+    fluid_real_t gain = iir_filter->filter_gain;
+    int dsp_i;
+
+    if(count >= 2)
+    {
+        /* DC gain of the recursive part, never zero near nyquist */
+        fluid_real_t dc_inv = 1.0f / (1.0f + iir_filter->a1 + iir_filter->a2);
+        iir_filter->hist1 = dsp_buf[count - 1] * dc_inv;
+        iir_filter->hist2 = dsp_buf[count - 2] * dc_inv;
+    }
+
+    for(dsp_i = 0; dsp_i < count; dsp_i++)
+    {
+        dsp_buf[dsp_i] *= gain;
+    }
+}
+
 /**
  * Applies a low- or high-pass filter with variable cutoff frequency and quality factor
  * for a given biquad transfer function:
@@ -54,6 +93,10 @@ fluid_iir_filter_apply(fluid_iir_filter_t *iir_filter,
     {
         return;
     }
+    else if(iir_filter->bypass)
+    {
+        fluid_iir_filter_apply_bypass(iir_filter, dsp_buf, count);
+    }
     else
     {
         /* IIR filter sample history */
@@ -142,6 +185,220 @@ fluid_iir_filter_apply(fluid_iir_filter_t *iir_filter,
     }
 }
 
+/**
+ * Applies several filters to as many audio buffers at once.
+ *
+ * The filter states are gathered into a structure-of-arrays layout and the
+ * samples of all buffers are interleaved, so that the inner loop runs across
+ * filters (lanes) rather than along time. This breaks the serial dependency
+ * of the biquad recursion and lets the compiler vectorize the loop. The result
+ * is the same as calling fluid_iir_filter_apply() for each filter in turn.
+ *
+ * @param iir_filters Filters to apply, one per buffer
+ * @param dsp_bufs Audio buffers, each containing #FLUID_BUFSIZE samples
+ * @param filter_count Number of filters (at most #FLUID_IIR_FILTER_LANES)
+ */
+void
+fluid_iir_filter_apply_multi(fluid_iir_filter_t **iir_filters,
+                             fluid_real_t **dsp_bufs, int filter_count)
+{
+    /* interleaved sample buffer, lanes are the fastest running index */
+    fluid_real_t dsp_buf[FLUID_BUFSIZE][FLUID_IIR_FILTER_LANES];
+
+    /* IIR filter sample history and coefficients, one entry per lane */
+    fluid_real_t dsp_hist1[FLUID_IIR_FILTER_LANES];
+    fluid_real_t dsp_hist2[FLUID_IIR_FILTER_LANES];
+    fluid_real_t dsp_a1[FLUID_IIR_FILTER_LANES];
+    fluid_real_t dsp_a2[FLUID_IIR_FILTER_LANES];
+    fluid_real_t dsp_b02[FLUID_IIR_FILTER_LANES];
+    fluid_real_t dsp_b1[FLUID_IIR_FILTER_LANES];
+    fluid_real_t dsp_a1_incr[FLUID_IIR_FILTER_LANES];
+    fluid_real_t dsp_a2_incr[FLUID_IIR_FILTER_LANES];
+    fluid_real_t dsp_b02_incr[FLUID_IIR_FILTER_LANES];
+    fluid_real_t dsp_b1_incr[FLUID_IIR_FILTER_LANES];
+    int dsp_filter_coeff_incr_count[FLUID_IIR_FILTER_LANES];
+    int dsp_compensate_incr[FLUID_IIR_FILTER_LANES];
+
+    fluid_iir_filter_t *lane_filter[FLUID_IIR_FILTER_LANES];
+    fluid_real_t *lane_buf[FLUID_IIR_FILTER_LANES];
+
+    /* number of samples during which at least one filter is changing */
+    int ramp_count = 0;
+    int lane_count = 0;
+    int dsp_i, lane;
+
+    FLUID_ASSERT(filter_count <= FLUID_IIR_FILTER_LANES);
+
+    /* sort out filters that are switched off */
+    for(lane = 0; lane < filter_count; lane++)
+    {
+        fluid_iir_filter_t *iir_filter = iir_filters[lane];
+
+        if(iir_filter->type == FLUID_IIR_DISABLED || iir_filter->q_lin == 0)
+        {
+            continue;
+        }
+
+        if(iir_filter->bypass)
+        {
+            fluid_iir_filter_apply_bypass(iir_filter, dsp_bufs[lane], FLUID_BUFSIZE);
+            continue;
+        }
+
+        lane_filter[lane_count] = iir_filter;
+        lane_buf[lane_count] = dsp_bufs[lane];
+        lane_count++;
+    }
+
+    if(lane_count == 0)
+    {
+        return;
+    }
+    else if(lane_count == 1)
+    {
+        /* nothing to gain from interleaving */
+        fluid_iir_filter_apply(lane_filter[0], lane_buf[0], FLUID_BUFSIZE);
+        return;
+    }
+
+    /* gather */
+    for(lane = 0; lane < FLUID_IIR_FILTER_LANES; lane++)
+    {
+        if(lane < lane_count)
+        {
+            fluid_iir_filter_t *iir_filter = lane_filter[lane];
+
+            dsp_hist1[lane] = iir_filter->hist1;
+            dsp_hist2[lane] = iir_filter->hist2;
+            dsp_a1[lane] = iir_filter->a1;
+            dsp_a2[lane] = iir_filter->a2;
+            dsp_b02[lane] = iir_filter->b02;
+            dsp_b1[lane] = iir_filter->b1;
+            dsp_filter_coeff_incr_count[lane] = iir_filter->filter_coeff_incr_count;
+
+            /* Check for denormal number (too close to zero). */
+            if(FLUID_FABS(dsp_hist1[lane]) < 1e-20f)
+            {
+                dsp_hist1[lane] = 0.0f;
+            }
+
+            if(dsp_filter_coeff_incr_count[lane] > 0)
+            {
+                dsp_a1_incr[lane] = iir_filter->a1_incr;
+                dsp_a2_incr[lane] = iir_filter->a2_incr;
+                dsp_b02_incr[lane] = iir_filter->b02_incr;
+                dsp_b1_incr[lane] = iir_filter->b1_incr;
+                dsp_compensate_incr[lane] = iir_filter->compensate_incr;
+
+                if(dsp_filter_coeff_incr_count[lane] > ramp_count)
+                {
+                    ramp_count = dsp_filter_coeff_incr_count[lane];
+                }
+            }
+            else
+            {
+                dsp_a1_incr[lane] = dsp_a2_incr[lane] = 0.0f;
+                dsp_b02_incr[lane] = dsp_b1_incr[lane] = 0.0f;
+                dsp_compensate_incr[lane] = 0;
+            }
+
+            for(dsp_i = 0; dsp_i < FLUID_BUFSIZE; dsp_i++)
+            {
+                dsp_buf[dsp_i][lane] = lane_buf[lane][dsp_i];
+            }
+        }
+        else
+        {
+            /* unused lane, runs a silent filter */
+            dsp_hist1[lane] = dsp_hist2[lane] = 0.0f;
+            dsp_a1[lane] = dsp_a2[lane] = dsp_b02[lane] = dsp_b1[lane] = 0.0f;
+            dsp_a1_incr[lane] = dsp_a2_incr[lane] = 0.0f;
+            dsp_b02_incr[lane] = dsp_b1_incr[lane] = 0.0f;
+            dsp_filter_coeff_incr_count[lane] = 0;
+            dsp_compensate_incr[lane] = 0;
+
+            for(dsp_i = 0; dsp_i < FLUID_BUFSIZE; dsp_i++)
+            {
+                dsp_buf[dsp_i][lane] = 0.0f;
+            }
+        }
+    }
+
+    if(ramp_count > FLUID_BUFSIZE)
+    {
+        ramp_count = FLUID_BUFSIZE;
+    }
+
+    /* Two versions of the filter loop, like in fluid_iir_filter_apply().
+     * The first one runs as long as any of the filters is changing towards
+     * its new setting. Lanes whose filter has already settled add a zero
+     * increment, which leaves their coefficients untouched.
+     */
+    for(dsp_i = 0; dsp_i < ramp_count; dsp_i++)
+    {
+        for(lane = 0; lane < FLUID_IIR_FILTER_LANES; lane++)
+        {
+            int ramping = dsp_i < dsp_filter_coeff_incr_count[lane];
+            fluid_real_t step = ramping ? 1.0f : 0.0f;
+            fluid_real_t old_b02 = dsp_b02[lane];
+            fluid_real_t compensate;
+
+            /* The filter is implemented in Direct-II form. */
+            fluid_real_t dsp_centernode = dsp_buf[dsp_i][lane] - dsp_a1[lane] * dsp_hist1[lane] - dsp_a2[lane] * dsp_hist2[lane];
+            dsp_buf[dsp_i][lane] = dsp_b02[lane] * (dsp_centernode + dsp_hist2[lane]) + dsp_b1[lane] * dsp_hist1[lane];
+            dsp_hist2[lane] = dsp_hist1[lane];
+            dsp_hist1[lane] = dsp_centernode;
+
+            dsp_a1[lane] += step * dsp_a1_incr[lane];
+            dsp_a2[lane] += step * dsp_a2_incr[lane];
+            dsp_b02[lane] += step * dsp_b02_incr[lane];
+            dsp_b1[lane] += step * dsp_b1_incr[lane];
+
+            /* Compensate history to avoid the filter going havoc with large frequency changes */
+            compensate = (ramping && dsp_compensate_incr[lane] && FLUID_FABS(dsp_b02[lane]) > 0.001f)
+                         ? old_b02 / dsp_b02[lane] : 1.0f;
+            dsp_hist1[lane] *= compensate;
+            dsp_hist2[lane] *= compensate;
+        }
+    }
+
+    for(; dsp_i < FLUID_BUFSIZE; dsp_i++)
+    {
+        for(lane = 0; lane < FLUID_IIR_FILTER_LANES; lane++)
+        {
+            fluid_real_t dsp_centernode = dsp_buf[dsp_i][lane] - dsp_a1[lane] * dsp_hist1[lane] - dsp_a2[lane] * dsp_hist2[lane];
+            dsp_buf[dsp_i][lane] = dsp_b02[lane] * (dsp_centernode + dsp_hist2[lane]) + dsp_b1[lane] * dsp_hist1[lane];
+            dsp_hist2[lane] = dsp_hist1[lane];
+            dsp_hist1[lane] = dsp_centernode;
+        }
+    }
+
+    /* scatter */
+    for(lane = 0; lane < lane_count; lane++)
+    {
+        fluid_iir_filter_t *iir_filter = lane_filter[lane];
+
+        for(dsp_i = 0; dsp_i < FLUID_BUFSIZE; dsp_i++)
+        {
+            lane_buf[lane][dsp_i] = dsp_buf[dsp_i][lane];
+        }
+
+        iir_filter->hist1 = dsp_hist1[lane];
+        iir_filter->hist2 = dsp_hist2[lane];
+        iir_filter->a1 = dsp_a1[lane];
+        iir_filter->a2 = dsp_a2[lane];
+        iir_filter->b02 = dsp_b02[lane];
+        iir_filter->b1 = dsp_b1[lane];
+
+        if(dsp_filter_coeff_incr_count[lane] > 0)
+        {
+            iir_filter->filter_coeff_incr_count = dsp_filter_coeff_incr_count[lane] - FLUID_BUFSIZE;
+        }
+    }
+
+    fluid_check_fpe("voice_filter");
+}
+
 
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_iir_filter_init)
 {
@@ -151,6 +408,7 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_iir_filter_init)
 
     iir_filter->type = type;
     iir_filter->flags = flags;
+    iir_filter->bypass = 0;
 
     if(type != FLUID_IIR_DISABLED)
     {
@@ -166,6 +424,7 @@ fluid_iir_filter_reset(fluid_iir_filter_t *iir_filter)
     iir_filter->last_fres = -1.;
     iir_filter->q_lin = 0;
     iir_filter->filter_startup = 1;
+    iir_filter->bypass = 0;
 }
 
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_iir_filter_set_fres)
@@ -412,6 +671,17 @@ void fluid_iir_filter_calc(fluid_iir_filter_t *iir_filter,
                                                 output_rate);
     }
 
+    /* The clamped filter is kept on at low sample rates for anti-aliasing
+     * (see above). At full bandwidth rates a wide open lowpass without
+     * resonance hump is inaudible though, so skip it unless its
+     * coefficients are still moving. */
+    iir_filter->bypass = (fres >= 0.45f * output_rate || fres >= FLUID_IIR_OPEN_FRES)
+                         && iir_filter->type == FLUID_IIR_LOWPASS
+                         && output_rate >= FLUID_IIR_BYPASS_MIN_RATE
+                         && iir_filter->q_lin > 0
+                         && iir_filter->q_lin < FLUID_IIR_FLAT_Q_LIN
+                         && !iir_filter->filter_startup
+                         && iir_filter->filter_coeff_incr_count <= 0;
 
     fluid_check_fpe("voice_write DSP coefficients");
 
@@ -25,6 +25,9 @@
 
 typedef struct _fluid_iir_filter_t fluid_iir_filter_t;
 
+/* Number of filters processed side by side by fluid_iir_filter_apply_multi() */
+#define FLUID_IIR_FILTER_LANES 4
+
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_iir_filter_init);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_iir_filter_set_fres);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_iir_filter_set_q);
@@ -32,6 +35,9 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_iir_filter_set_q);
 void fluid_iir_filter_apply(fluid_iir_filter_t *iir_filter,
                             fluid_real_t *dsp_buf, int dsp_buf_count);
 
+void fluid_iir_filter_apply_multi(fluid_iir_filter_t **iir_filters,
+                                  fluid_real_t **dsp_bufs, int filter_count);
+
 void fluid_iir_filter_reset(fluid_iir_filter_t *iir_filter);
 
 void fluid_iir_filter_calc(fluid_iir_filter_t *iir_filter,
@@ -62,6 +68,8 @@ struct _fluid_iir_filter_t
     fluid_real_t hist1, hist2;      /* Sample history for the IIR filter */
     int filter_startup;             /* Flag: If set, the filter will be set directly.
 					   Else it changes smoothly. */
+    int bypass;                     /* Flag: If set, the filter is acoustically transparent
+                                       and only its passband gain is applied. */
 
     fluid_real_t fres;              /* the resonance frequency, in cents (not absolute cents) */
     fluid_real_t last_fres;         /* Current resonance frequency of the IIR filter */
@@ -35,26 +35,33 @@ static long fluid_getlength(unsigned char *s);
  * Returns NULL if there was an error reading or allocating memory.
  */
 typedef FILE  *fluid_file;
+#if !HAVE_SYS_MMAN_H
 static char *fluid_file_read_full(fluid_file fp, size_t *length);
+#endif
+static char *fluid_file_map(const char *filename, size_t *length, char *owner);
+static void fluid_file_unmap(const char *data, size_t length, char owner);
 static void fluid_midi_event_set_sysex_LOCAL(fluid_midi_event_t *evt, int type, void *data, int size, int dynamic);
 static void fluid_midi_event_get_sysex_LOCAL(fluid_midi_event_t *evt, void **data, int *size);
 #define READ_FULL_INITIAL_BUFLEN 1024
 
+/* How the contents of the loaded MIDI file are owned (fluid_player.file_data_owner) */
+enum
+{
+    FLUID_FILE_DATA_BORROWED,   /* owned by the playlist */
+    FLUID_FILE_DATA_HEAP,       /* read into a heap buffer */
+    FLUID_FILE_DATA_MAPPED      /* memory mapped */
+};
+
 static fluid_track_t *new_fluid_track(int num);
 static void delete_fluid_track(fluid_track_t *track);
-static int fluid_track_set_name(fluid_track_t *track, char *name);
-static int fluid_track_add_event(fluid_track_t *track, fluid_midi_event_t *evt);
-static fluid_midi_event_t *fluid_track_next_event(fluid_track_t *track);
-static int fluid_track_get_duration(fluid_track_t *track);
-static int fluid_track_reset(fluid_track_t *track);
-
-static void fluid_track_send_events(fluid_track_t *track,
-                                   fluid_synth_t *synth,
-                                   fluid_player_t *player,
-                                   unsigned int ticks);
+static int fluid_track_set_name(fluid_track_t *track, const char *name, int len);
+static fluid_midi_event_t *fluid_track_new_event(fluid_track_t *track);
+static int fluid_track_shrink(fluid_track_t *track);
 
 
 static int fluid_player_add_track(fluid_player_t *player, fluid_track_t *track);
+static int fluid_player_build_timeline(fluid_player_t *player);
+static void fluid_player_send_events(fluid_player_t *player, unsigned int ticks);
 static int fluid_player_callback(void *data, unsigned int msec);
 static int fluid_player_reset(fluid_player_t *player);
 static int fluid_player_load(fluid_player_t *player, fluid_playlist_item *item);
@@ -66,18 +73,17 @@ static void delete_fluid_midi_file(fluid_midi_file *mf);
 static int fluid_midi_file_read_mthd(fluid_midi_file *midifile);
 static int fluid_midi_file_load_tracks(fluid_midi_file *midifile, fluid_player_t *player);
 static int fluid_midi_file_read_track(fluid_midi_file *mf, fluid_player_t *player, int num);
-static int fluid_midi_file_read_event(fluid_midi_file *mf, fluid_track_t *track);
-static int fluid_midi_file_read_varlen(fluid_midi_file *mf);
-static int fluid_midi_file_getc(fluid_midi_file *mf);
-static int fluid_midi_file_push(fluid_midi_file *mf, int c);
+static int fluid_midi_file_read_events(fluid_midi_file *mf, fluid_track_t *track,
+                                       const unsigned char **data, const unsigned char *end);
+static int fluid_midi_file_read_varlen(const unsigned char **data, const unsigned char *end,
+                                       int *value);
 static int fluid_midi_file_read(fluid_midi_file *mf, void *buf, int len);
 static int fluid_midi_file_skip(fluid_midi_file *mf, int len);
 static int fluid_midi_file_eof(fluid_midi_file *mf);
 static int fluid_midi_file_read_tracklen(fluid_midi_file *mf);
-static int fluid_midi_file_eot(fluid_midi_file *mf);
 static int fluid_midi_file_get_division(fluid_midi_file *midifile);
 
-#if 0 // disable file I/O with Ardour
+#ifdef WITH_MIDI_PLAYER // file I/O is only used by the standalone renderer
 /***************************************************************
  *
  *                      MIDIFILE
@@ -141,9 +147,6 @@ new_fluid_midi_file(const char *buffer, size_t length)
 
     FLUID_MEMSET(mf, 0, sizeof(fluid_midi_file));
 
-    mf->c = -1;
-    mf->running_status = -1;
-
     mf->buffer = buffer;
     mf->buf_len = length;
     mf->buf_pos = 0;
@@ -158,6 +161,7 @@ new_fluid_midi_file(const char *buffer, size_t length)
     return mf;
 }
 
+#if !HAVE_SYS_MMAN_H
 static char *
 fluid_file_read_full(fluid_file fp, size_t *length)
 {
@@ -203,59 +207,104 @@ fluid_file_read_full(fluid_file fp, size_t *length)
 
     return buffer;
 }
+#endif
 
-/**
- * Delete a MIDI file handle.
- * @internal
- * @param mf MIDI file handle to close and free.
+/*
+ * Makes the contents of a file available in memory: the file is mapped
+ * where memory mapping is available, and read into a heap buffer
+ * otherwise. owner tells fluid_file_unmap() how to release it.
+ * Returns NULL on error.
  */
-void
-delete_fluid_midi_file(fluid_midi_file *mf)
+static char *
+fluid_file_map(const char *filename, size_t *length, char *owner)
 {
-    fluid_return_if_fail(mf != NULL);
+#if HAVE_SYS_MMAN_H
+    struct stat st;
+    void *data;
+    int fd = open(filename, O_RDONLY);
 
-    FLUID_FREE(mf);
+    if(fd < 0)
+    {
+        FLUID_LOG(FLUID_ERR, "Couldn't open the MIDI file");
+        return NULL;
+    }
+
+    if(fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        FLUID_LOG(FLUID_ERR, "File load: Could not get the size of the file");
+        close(fd);
+        return NULL;
+    }
+
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data == MAP_FAILED)
+    {
+        FLUID_LOG(FLUID_ERR, "File load: Could not map the file");
+        return NULL;
+    }
+
+    /* the file is parsed front to back, once */
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    *length = st.st_size;
+    *owner = FLUID_FILE_DATA_MAPPED;
+    return data;
+#else
+    char *buffer;
+    fluid_file fp = FLUID_FOPEN(filename, "rb");
+
+    if(fp == NULL)
+    {
+        FLUID_LOG(FLUID_ERR, "Couldn't open the MIDI file");
+        return NULL;
+    }
+
+    buffer = fluid_file_read_full(fp, length);
+    FLUID_FCLOSE(fp);
+
+    *owner = FLUID_FILE_DATA_HEAP;
+    return buffer;
+#endif
 }
 
 /*
- * Gets the next byte in a MIDI file, taking into account previous running status.
- *
- * returns -1 if EOF or read error
+ * Releases file contents obtained from fluid_file_map() or borrowed.
  */
-int
-fluid_midi_file_getc(fluid_midi_file *mf)
+static void
+fluid_file_unmap(const char *data, size_t length, char owner)
 {
-    unsigned char c;
-
-    if(mf->c >= 0)
+    if(data == NULL)
     {
-        c = mf->c;
-        mf->c = -1;
+        return;
     }
-    else
+
+    if(owner == FLUID_FILE_DATA_HEAP)
     {
-        if(mf->buf_pos >= mf->buf_len)
-        {
-            mf->eof = TRUE;
-            return -1;
-        }
+        FLUID_FREE((char *) data);
+    }
 
-        c = mf->buffer[mf->buf_pos++];
-        mf->trackpos++;
+#if HAVE_SYS_MMAN_H
+    else if(owner == FLUID_FILE_DATA_MAPPED)
+    {
+        munmap((void *) data, length);
     }
 
-    return (int) c;
+#endif
 }
 
-/*
- * Saves a byte to be returned the next time fluid_midi_file_getc() is called,
- * when it is necessary according to running status.
+/**
+ * Delete a MIDI file handle.
+ * @internal
+ * @param mf MIDI file handle to close and free.
  */
-int
-fluid_midi_file_push(fluid_midi_file *mf, int c)
+void
+delete_fluid_midi_file(fluid_midi_file *mf)
 {
-    mf->c = c;
-    return FLUID_OK;
+    fluid_return_if_fail(mf != NULL);
+
+    FLUID_FREE(mf);
 }
 
 /*
@@ -277,19 +326,13 @@ fluid_midi_file_read(fluid_midi_file *mf, void *buf, int len)
         num = 0;
     }
 
-    /* Note: Read bytes, even if there aren't enough, but only increment
-     * trackpos if successful (emulates old behaviour of fluid_midi_file_read)
-     */
+    /* Note: Read bytes, even if there aren't enough */
     FLUID_MEMCPY(buf, mf->buffer + mf->buf_pos, num);
     mf->buf_pos += num;
 
-    if(num == len)
-    {
-        mf->trackpos += num;
-    }
-
 #if DEBUG
-    else
+
+    if(num != len)
     {
         FLUID_LOG(FLUID_DBG, "Could not read the requested number of bytes");
     }
@@ -394,7 +437,7 @@ fluid_midi_file_load_tracks(fluid_midi_file *mf, fluid_player_t *player)
         }
     }
 
-    return FLUID_OK;
+    return fluid_player_build_timeline(player);
 }
 
 /*
@@ -447,28 +490,9 @@ fluid_midi_file_read_tracklen(fluid_midi_file *mf)
     }
 
     mf->tracklen = fluid_getlength(length);
-    mf->trackpos = 0;
-    mf->eot = 0;
     return FLUID_OK;
 }
 
-/*
- * fluid_midi_file_eot
- */
-int
-fluid_midi_file_eot(fluid_midi_file *mf)
-{
-#if DEBUG
-
-    if(mf->trackpos > mf->tracklen)
-    {
-        printf("track overrun: %d > %d\n", mf->trackpos, mf->tracklen);
-    }
-
-#endif
-    return mf->eot || (mf->trackpos >= mf->tracklen);
-}
-
 /*
  * fluid_midi_file_read_track
  */
@@ -477,6 +501,7 @@ fluid_midi_file_read_track(fluid_midi_file *mf, fluid_player_t *player, int num)
 {
     fluid_track_t *track;
     unsigned char id[5], length[5];
+    const unsigned char *data, *end;
     int found_track = 0;
     int skip;
 
@@ -486,7 +511,6 @@ fluid_midi_file_read_track(fluid_midi_file *mf, fluid_player_t *player, int num)
     }
 
     id[4] = '\0';
-    mf->dtime = 0;
 
     while(!found_track)
     {
@@ -516,23 +540,22 @@ fluid_midi_file_read_track(fluid_midi_file *mf, fluid_player_t *player, int num)
                 return FLUID_FAILED;
             }
 
-            while(!fluid_midi_file_eot(mf))
+            data = (const unsigned char *) mf->buffer + mf->buf_pos;
+            end = (const unsigned char *) mf->buffer + mf->buf_len;
+
+            if(fluid_midi_file_read_events(mf, track, &data, end) != FLUID_OK)
             {
-                if(fluid_midi_file_read_event(mf, track) != FLUID_OK)
-                {
-                    delete_fluid_track(track);
-                    return FLUID_FAILED;
-                }
+                delete_fluid_track(track);
+                return FLUID_FAILED;
             }
 
             /* Skip remaining track data, if any */
-            if(mf->trackpos < mf->tracklen)
+            skip = (int)(data - (const unsigned char *) mf->buffer) - mf->buf_pos;
+
+            if(fluid_midi_file_skip(mf, skip > mf->tracklen ? skip : mf->tracklen) != FLUID_OK)
             {
-                if(fluid_midi_file_skip(mf, mf->tracklen - mf->trackpos) != FLUID_OK)
-                {
-                    delete_fluid_track(track);
-                    return FLUID_FAILED;
-                }
+                delete_fluid_track(track);
+                return FLUID_FAILED;
             }
 
             if(fluid_player_add_track(player, track) != FLUID_OK)
@@ -572,13 +595,17 @@ fluid_midi_file_read_track(fluid_midi_file *mf, fluid_player_t *player, int num)
 
 /*
  * fluid_midi_file_read_varlen
+ *
+ * Decodes a variable length number at *data and advances *data past it.
  */
 int
-fluid_midi_file_read_varlen(fluid_midi_file *mf)
+fluid_midi_file_read_varlen(const unsigned char **data, const unsigned char *end,
+                            int *value)
 {
+    const unsigned char *p = *data;
     int i;
-    int c;
-    mf->varlen = 0;
+
+    *value = 0;
 
     for(i = 0;; i++)
     {
@@ -588,456 +615,314 @@ fluid_midi_file_read_varlen(fluid_midi_file *mf)
             return FLUID_FAILED;
         }
 
-        c = fluid_midi_file_getc(mf);
-
-        if(c < 0)
+        if(p >= end)
         {
             FLUID_LOG(FLUID_ERR, "Unexpected end of file");
             return FLUID_FAILED;
         }
 
-        if(c & 0x80)
-        {
-            mf->varlen |= (int)(c & 0x7F);
-            mf->varlen <<= 7;
-        }
-        else
+        *value = (*value << 7) | (*p & 0x7F);
+
+        if((*p++ & 0x80) == 0)
         {
-            mf->varlen += c;
             break;
         }
     }
 
+    *data = p;
     return FLUID_OK;
 }
 
 /*
- * fluid_midi_file_read_event
+ * fluid_midi_file_read_events
+ *
+ * Decodes the events of the current track chunk straight from the file
+ * contents at *data into the packed event array of track, and advances
+ * *data past the last decoded byte. Decoding stops at the EndOfTrack
+ * event or at the end of the chunk, whichever comes first.
+ *
+ * SYSEX payloads are not copied: the events point into the file
+ * contents, which must therefore outlive the track.
  */
 int
-fluid_midi_file_read_event(fluid_midi_file *mf, fluid_track_t *track)
-{
-    int status;
-    int type;
-    int tempo;
-    unsigned char *metadata = NULL;
-    unsigned char *dyn_buf = NULL;
-    unsigned char static_buf[256];
-    int nominator, denominator, clocks, notes;
+fluid_midi_file_read_events(fluid_midi_file *mf, fluid_track_t *track,
+                            const unsigned char **data, const unsigned char *end)
+{
+    const unsigned char *p = *data;
+    const unsigned char *track_end = p + mf->tracklen;
     fluid_midi_event_t *evt;
-    int channel = 0;
-    int param1 = 0;
-    int param2 = 0;
-    int size;
-
-    /* read the delta-time of the event */
-    if(fluid_midi_file_read_varlen(mf) != FLUID_OK)
-    {
-        return FLUID_FAILED;
-    }
-
-    mf->dtime += mf->varlen;
-
-    /* read the status byte */
-    status = fluid_midi_file_getc(mf);
+    int running_status = -1;
+    int dtime = 0;
+    int eot = FALSE;
+    int status, type, len, size;
+    int varlen;
 
-    if(status < 0)
+    if(track_end > end || track_end < p)
     {
-        FLUID_LOG(FLUID_ERR, "Unexpected end of file");
-        return FLUID_FAILED;
+        track_end = end;
     }
 
-    /* not a valid status byte: use the running status instead */
-    if((status & 0x80) == 0)
+    while(!eot && p < track_end)
     {
-        if((mf->running_status & 0x80) == 0)
+        /* read the delta-time of the event */
+        if(fluid_midi_file_read_varlen(&p, end, &varlen) != FLUID_OK)
         {
-            FLUID_LOG(FLUID_ERR, "Undefined status and invalid running status");
             return FLUID_FAILED;
         }
 
-        fluid_midi_file_push(mf, status);
-        status = mf->running_status;
-    }
-
-    /* check what message we have */
-
-    mf->running_status = status;
+        dtime += varlen;
 
-    if(status == MIDI_SYSEX)    /* system exclusif */
-    {
-        /* read the length of the message */
-        if(fluid_midi_file_read_varlen(mf) != FLUID_OK)
+        if(p >= end)
         {
+            FLUID_LOG(FLUID_ERR, "Unexpected end of file");
             return FLUID_FAILED;
         }
 
-        if(mf->varlen)
+        /* not a valid status byte: use the running status instead */
+        if((*p & 0x80) == 0)
         {
-            FLUID_LOG(FLUID_DBG, "%s: %d: alloc metadata, len = %d", __FILE__,
-                      __LINE__, mf->varlen);
-            metadata = FLUID_MALLOC(mf->varlen + 1);
-
-            if(metadata == NULL)
+            if((running_status & 0x80) == 0)
             {
-                FLUID_LOG(FLUID_PANIC, "Out of memory");
+                FLUID_LOG(FLUID_ERR, "Undefined status and invalid running status");
                 return FLUID_FAILED;
             }
 
-            /* read the data of the message */
-            if(fluid_midi_file_read(mf, metadata, mf->varlen) != FLUID_OK)
-            {
-                FLUID_FREE(metadata);
-                return FLUID_FAILED;
-            }
+            status = running_status;
+        }
+        else
+        {
+            status = *p++;
+        }
 
-            evt = new_fluid_midi_event();
+        /* check what message we have */
 
-            if(evt == NULL)
+        running_status = status;
+
+        if(status == MIDI_SYSEX)    /* system exclusif */
+        {
+            /* read the length of the message */
+            if(fluid_midi_file_read_varlen(&p, end, &varlen) != FLUID_OK)
             {
-                FLUID_LOG(FLUID_ERR, "Out of memory");
-                FLUID_FREE(metadata);
                 return FLUID_FAILED;
             }
 
-            evt->dtime = mf->dtime;
-            size = mf->varlen;
-
-            if(metadata[mf->varlen - 1] == MIDI_EOX)
+            if(varlen > end - p)
             {
-                size--;
+                FLUID_LOG(FLUID_ERR, "Unexpected end of file");
+                return FLUID_FAILED;
             }
 
-            /* Add SYSEX event and indicate that its dynamically allocated and should be freed with event */
-            fluid_midi_event_set_sysex(evt, metadata, size, TRUE);
-            fluid_track_add_event(track, evt);
-            mf->dtime = 0;
-        }
-
-        return FLUID_OK;
-
-    }
-    else if(status == MIDI_META_EVENT)      /* meta events */
-    {
+            if(varlen)
+            {
+                evt = fluid_track_new_event(track);
 
-        int result = FLUID_OK;
+                if(evt == NULL)
+                {
+                    return FLUID_FAILED;
+                }
 
-        /* get the type of the meta message */
-        type = fluid_midi_file_getc(mf);
+                evt->dtime = dtime;
+                size = varlen;
 
-        if(type < 0)
-        {
-            FLUID_LOG(FLUID_ERR, "Unexpected end of file");
-            return FLUID_FAILED;
-        }
+                if(p[varlen - 1] == MIDI_EOX)
+                {
+                    size--;
+                }
 
-        /* get the length of the data part */
-        if(fluid_midi_file_read_varlen(mf) != FLUID_OK)
-        {
-            return FLUID_FAILED;
-        }
+                /* Add SYSEX event, referencing the payload in place */
+                fluid_midi_event_set_sysex(evt, (void *) p, size, FALSE);
+                dtime = 0;
+            }
 
-        if(mf->varlen < 255)
-        {
-            metadata = &static_buf[0];
+            p += varlen;
         }
-        else
+        else if(status == MIDI_META_EVENT)      /* meta events */
         {
-            FLUID_LOG(FLUID_DBG, "%s: %d: alloc metadata, len = %d", __FILE__,
-                      __LINE__, mf->varlen);
-            dyn_buf = FLUID_MALLOC(mf->varlen + 1);
-
-            if(dyn_buf == NULL)
+            /* get the type of the meta message */
+            if(p >= end)
             {
-                FLUID_LOG(FLUID_PANIC, "Out of memory");
+                FLUID_LOG(FLUID_ERR, "Unexpected end of file");
                 return FLUID_FAILED;
             }
 
-            metadata = dyn_buf;
-        }
+            type = *p++;
 
-        /* read the data */
-        if(mf->varlen)
-        {
-            if(fluid_midi_file_read(mf, metadata, mf->varlen) != FLUID_OK)
+            /* get the length of the data part */
+            if(fluid_midi_file_read_varlen(&p, end, &varlen) != FLUID_OK)
             {
-                if(dyn_buf)
-                {
-                    FLUID_FREE(dyn_buf);
-                }
-
                 return FLUID_FAILED;
             }
-        }
-
-        /* handle meta data */
-        switch(type)
-        {
-
-        case MIDI_COPYRIGHT:
-            metadata[mf->varlen] = 0;
-            break;
 
-        case MIDI_TRACK_NAME:
-            metadata[mf->varlen] = 0;
-            fluid_track_set_name(track, (char *) metadata);
-            break;
-
-        case MIDI_INST_NAME:
-            metadata[mf->varlen] = 0;
-            break;
-
-        case MIDI_LYRIC:
-        case MIDI_TEXT:
-        {
-            void *tmp;
-            int size = mf->varlen + 1;
-
-            /* NULL terminate strings for safety */
-            metadata[size - 1] = '\0';
-
-            evt = new_fluid_midi_event();
-
-            if(evt == NULL)
+            if(varlen > end - p)
             {
-                FLUID_LOG(FLUID_ERR, "Out of memory");
-                result = FLUID_FAILED;
-                break;
+                FLUID_LOG(FLUID_ERR, "Unexpected end of file");
+                return FLUID_FAILED;
             }
 
-            evt->dtime = mf->dtime;
-
-            tmp = FLUID_MALLOC(size);
-
-            if(tmp == NULL)
+            /* handle meta data */
+            switch(type)
             {
-                FLUID_LOG(FLUID_PANIC, "Out of memory");
-                delete_fluid_midi_event(evt);
-                evt = NULL;
-                result = FLUID_FAILED;
-                break;
-            }
-
-            FLUID_MEMCPY(tmp, metadata, size);
 
-            fluid_midi_event_set_sysex_LOCAL(evt, type, tmp, size, TRUE);
-            fluid_track_add_event(track, evt);
-            mf->dtime = 0;
-        }
-        break;
-
-        case MIDI_MARKER:
-            break;
-
-        case MIDI_CUE_POINT:
-            break; /* don't care much for text events */
+            case MIDI_TRACK_NAME:
+                if(fluid_track_set_name(track, (const char *) p, varlen) != FLUID_OK)
+                {
+                    return FLUID_FAILED;
+                }
 
-        case MIDI_EOT:
-            if(mf->varlen != 0)
-            {
-                FLUID_LOG(FLUID_ERR, "Invalid length for EndOfTrack event");
-                result = FLUID_FAILED;
                 break;
-            }
 
-            mf->eot = 1;
-            evt = new_fluid_midi_event();
-
-            if(evt == NULL)
+            case MIDI_LYRIC:
+            case MIDI_TEXT:
             {
-                FLUID_LOG(FLUID_ERR, "Out of memory");
-                result = FLUID_FAILED;
-                break;
-            }
+                /* text is copied, as it gets NULL terminated for safety */
+                char *tmp = FLUID_MALLOC(varlen + 1);
 
-            evt->dtime = mf->dtime;
-            evt->type = MIDI_EOT;
-            fluid_track_add_event(track, evt);
-            mf->dtime = 0;
-            break;
+                evt = (tmp != NULL) ? fluid_track_new_event(track) : NULL;
 
-        case MIDI_SET_TEMPO:
-            if(mf->varlen != 3)
-            {
-                FLUID_LOG(FLUID_ERR,
-                          "Invalid length for SetTempo meta event");
-                result = FLUID_FAILED;
-                break;
-            }
+                if(evt == NULL)
+                {
+                    FLUID_LOG(FLUID_ERR, "Out of memory");
+                    FLUID_FREE(tmp);
+                    return FLUID_FAILED;
+                }
 
-            tempo = (metadata[0] << 16) + (metadata[1] << 8) + metadata[2];
-            evt = new_fluid_midi_event();
+                FLUID_MEMCPY(tmp, p, varlen);
+                tmp[varlen] = '\0';
 
-            if(evt == NULL)
-            {
-                FLUID_LOG(FLUID_ERR, "Out of memory");
-                result = FLUID_FAILED;
-                break;
+                evt->dtime = dtime;
+                fluid_midi_event_set_sysex_LOCAL(evt, type, tmp, varlen + 1, TRUE);
+                dtime = 0;
             }
-
-            evt->dtime = mf->dtime;
-            evt->type = MIDI_SET_TEMPO;
-            evt->channel = 0;
-            evt->param1 = tempo;
-            evt->param2 = 0;
-            fluid_track_add_event(track, evt);
-            mf->dtime = 0;
             break;
 
-        case MIDI_SMPTE_OFFSET:
-            if(mf->varlen != 5)
-            {
-                FLUID_LOG(FLUID_ERR,
-                          "Invalid length for SMPTE Offset meta event");
-                result = FLUID_FAILED;
-                break;
-            }
+            case MIDI_EOT:
+                if(varlen != 0)
+                {
+                    FLUID_LOG(FLUID_ERR, "Invalid length for EndOfTrack event");
+                    return FLUID_FAILED;
+                }
 
-            break; /* we don't use smtp */
+                eot = TRUE;
+                evt = fluid_track_new_event(track);
 
-        case MIDI_TIME_SIGNATURE:
-            if(mf->varlen != 4)
-            {
-                FLUID_LOG(FLUID_ERR,
-                          "Invalid length for TimeSignature meta event");
-                result = FLUID_FAILED;
+                if(evt == NULL)
+                {
+                    return FLUID_FAILED;
+                }
+
+                evt->dtime = dtime;
+                evt->type = MIDI_EOT;
+                dtime = 0;
                 break;
-            }
 
-            nominator = metadata[0];
-            denominator = pow(2.0, (double) metadata[1]);
-            clocks = metadata[2];
-            notes = metadata[3];
+            case MIDI_SET_TEMPO:
+                if(varlen != 3)
+                {
+                    FLUID_LOG(FLUID_ERR,
+                              "Invalid length for SetTempo meta event");
+                    return FLUID_FAILED;
+                }
 
-            FLUID_LOG(FLUID_DBG,
-                      "signature=%d/%d, metronome=%d, 32nd-notes=%d",
-                      nominator, denominator, clocks, notes);
+                evt = fluid_track_new_event(track);
 
-            break;
+                if(evt == NULL)
+                {
+                    return FLUID_FAILED;
+                }
 
-        case MIDI_KEY_SIGNATURE:
-            if(mf->varlen != 2)
-            {
-                FLUID_LOG(FLUID_ERR,
-                          "Invalid length for KeySignature meta event");
-                result = FLUID_FAILED;
+                evt->dtime = dtime;
+                evt->type = MIDI_SET_TEMPO;
+                evt->param1 = (p[0] << 16) + (p[1] << 8) + p[2];
+                dtime = 0;
                 break;
-            }
 
-            /* We don't care about key signatures anyway */
-            /* sf = metadata[0];
-            mi = metadata[1]; */
-            break;
+            case MIDI_SMPTE_OFFSET:
+                if(varlen != 5)
+                {
+                    FLUID_LOG(FLUID_ERR,
+                              "Invalid length for SMPTE Offset meta event");
+                    return FLUID_FAILED;
+                }
 
-        case MIDI_SEQUENCER_EVENT:
-            break;
+                break; /* we don't use smtp */
 
-        default:
-            break;
-        }
+            case MIDI_TIME_SIGNATURE:
+                if(varlen != 4)
+                {
+                    FLUID_LOG(FLUID_ERR,
+                              "Invalid length for TimeSignature meta event");
+                    return FLUID_FAILED;
+                }
 
-        if(dyn_buf)
-        {
-            FLUID_LOG(FLUID_DBG, "%s: %d: free metadata", __FILE__, __LINE__);
-            FLUID_FREE(dyn_buf);
-        }
+                FLUID_LOG(FLUID_DBG,
+                          "signature=%d/%d, metronome=%d, 32nd-notes=%d",
+                          p[0], 1 << p[1], p[2], p[3]);
+                break;
 
-        return result;
+            case MIDI_KEY_SIGNATURE:
+                if(varlen != 2)
+                {
+                    FLUID_LOG(FLUID_ERR,
+                              "Invalid length for KeySignature meta event");
+                    return FLUID_FAILED;
+                }
 
-    }
-    else     /* channel messages */
-    {
+                /* We don't care about key signatures anyway */
+                break;
 
-        type = status & 0xf0;
-        channel = status & 0x0f;
+            default:
+                /* copyright, instrument name, marker, cue point, ... */
+                break;
+            }
 
-        /* all channel message have at least 1 byte of associated data */
-        if((param1 = fluid_midi_file_getc(mf)) < 0)
-        {
-            FLUID_LOG(FLUID_ERR, "Unexpected end of file");
-            return FLUID_FAILED;
+            p += varlen;
         }
-
-        switch(type)
+        else     /* channel messages */
         {
+            type = status & 0xf0;
+            len = fluid_midi_event_length(status) - 1;
 
-        case NOTE_ON:
-            if((param2 = fluid_midi_file_getc(mf)) < 0)
+            if(type < NOTE_OFF || type > PITCH_BEND)
             {
-                FLUID_LOG(FLUID_ERR, "Unexpected end of file");
+                /* Can't possibly happen !? */
+                FLUID_LOG(FLUID_ERR, "Unrecognized MIDI event");
                 return FLUID_FAILED;
             }
 
-            break;
-
-        case NOTE_OFF:
-            if((param2 = fluid_midi_file_getc(mf)) < 0)
+            if(len > end - p)
             {
                 FLUID_LOG(FLUID_ERR, "Unexpected end of file");
                 return FLUID_FAILED;
             }
 
-            break;
+            evt = fluid_track_new_event(track);
 
-        case KEY_PRESSURE:
-            if((param2 = fluid_midi_file_getc(mf)) < 0)
+            if(evt == NULL)
             {
-                FLUID_LOG(FLUID_ERR, "Unexpected end of file");
                 return FLUID_FAILED;
             }
 
-            break;
+            evt->dtime = dtime;
+            evt->type = type;
+            evt->channel = status & 0x0f;
+            evt->param1 = p[0];
 
-        case CONTROL_CHANGE:
-            if((param2 = fluid_midi_file_getc(mf)) < 0)
+            if(type == PITCH_BEND)
             {
-                FLUID_LOG(FLUID_ERR, "Unexpected end of file");
-                return FLUID_FAILED;
+                evt->param1 = ((p[1] & 0x7f) << 7) | (p[0] & 0x7f);
             }
-
-            break;
-
-        case PROGRAM_CHANGE:
-            break;
-
-        case CHANNEL_PRESSURE:
-            break;
-
-        case PITCH_BEND:
-            if((param2 = fluid_midi_file_getc(mf)) < 0)
+            else if(len == 2)
             {
-                FLUID_LOG(FLUID_ERR, "Unexpected end of file");
-                return FLUID_FAILED;
+                evt->param2 = p[1];
             }
 
-            param1 = ((param2 & 0x7f) << 7) | (param1 & 0x7f);
-            param2 = 0;
-            break;
-
-        default:
-            /* Can't possibly happen !? */
-            FLUID_LOG(FLUID_ERR, "Unrecognized MIDI event");
-            return FLUID_FAILED;
+            p += len;
+            dtime = 0;
         }
-
-        evt = new_fluid_midi_event();
-
-        if(evt == NULL)
-        {
-            FLUID_LOG(FLUID_ERR, "Out of memory");
-            return FLUID_FAILED;
-        }
-
-        evt->dtime = mf->dtime;
-        evt->type = type;
-        evt->channel = channel;
-        evt->param1 = param1;
-        evt->param2 = param2;
-        fluid_track_add_event(track, evt);
-        mf->dtime = 0;
     }
 
-    return FLUID_OK;
+    *data = p;
+    return fluid_track_shrink(track);
 }
 
 /*
@@ -1415,7 +1300,7 @@ static void fluid_midi_event_get_sysex_LOCAL(fluid_midi_event_t *evt, void **dat
  *
  *     fluid_track_t
  */
-#if 0 // disable fluid file player in Ardour
+#ifdef WITH_MIDI_PLAYER // the file player is only used by the standalone renderer
 /*
  * new_fluid_track
  */
@@ -1432,10 +1317,9 @@ new_fluid_track(int num)
 
     track->name = NULL;
     track->num = num;
-    track->first = NULL;
-    track->cur = NULL;
-    track->last = NULL;
-    track->ticks = 0;
+    track->events = NULL;
+    track->nevents = 0;
+    track->size = 0;
     return track;
 }
 
@@ -1445,10 +1329,24 @@ new_fluid_track(int num)
 void
 delete_fluid_track(fluid_track_t *track)
 {
+    int i;
+
     fluid_return_if_fail(track != NULL);
 
+    for(i = 0; i < track->nevents; i++)
+    {
+        fluid_midi_event_t *evt = &track->events[i];
+
+        /* Dynamic text event? - free (param2 indicates if dynamic) */
+        if((evt->type == MIDI_SYSEX || evt->type == MIDI_TEXT || evt->type == MIDI_LYRIC) &&
+                evt->paramptr && evt->param2)
+        {
+            FLUID_FREE(evt->paramptr);
+        }
+    }
+
     FLUID_FREE(track->name);
-    delete_fluid_midi_event(track->first);
+    FLUID_FREE(track->events);
     FLUID_FREE(track);
 }
 
@@ -1456,10 +1354,8 @@ delete_fluid_track(fluid_track_t *track)
  * fluid_track_set_name
  */
 int
-fluid_track_set_name(fluid_track_t *track, char *name)
+fluid_track_set_name(fluid_track_t *track, const char *name, int len)
 {
-    int len;
-
     if(track->name != NULL)
     {
         FLUID_FREE(track->name);
@@ -1471,7 +1367,6 @@ fluid_track_set_name(fluid_track_t *track, char *name)
         return FLUID_OK;
     }
 
-    len = FLUID_STRLEN(name);
     track->name = FLUID_MALLOC(len + 1);
 
     if(track->name == NULL)
@@ -1480,147 +1375,68 @@ fluid_track_set_name(fluid_track_t *track, char *name)
         return FLUID_FAILED;
     }
 
-    FLUID_STRCPY(track->name, name);
+    FLUID_MEMCPY(track->name, name, len);
+    track->name[len] = '\0';
     return FLUID_OK;
 }
 
 /*
- * fluid_track_get_duration
+ * fluid_track_new_event
+ *
+ * Appends a cleared event to the packed event array of the track, growing
+ * the array geometrically as needed.
  */
-int
-fluid_track_get_duration(fluid_track_t *track)
+fluid_midi_event_t *
+fluid_track_new_event(fluid_track_t *track)
 {
-    int time = 0;
-    fluid_midi_event_t *evt = track->first;
+    fluid_midi_event_t *evt;
 
-    while(evt != NULL)
+    if(track->nevents == track->size)
     {
-        time += evt->dtime;
-        evt = evt->next;
+        int size = track->size ? 2 * track->size : 256;
+        fluid_midi_event_t *events = FLUID_REALLOC(track->events, size * sizeof(*events));
+
+        if(events == NULL)
+        {
+            FLUID_LOG(FLUID_ERR, "Out of memory");
+            return NULL;
+        }
+
+        track->events = events;
+        track->size = size;
     }
 
-    return time;
+    evt = &track->events[track->nevents++];
+    FLUID_MEMSET(evt, 0, sizeof(*evt));
+    return evt;
 }
 
 /*
- * fluid_track_add_event
+ * fluid_track_shrink
+ *
+ * Trims the event array of a completely loaded track to its actual size.
  */
 int
-fluid_track_add_event(fluid_track_t *track, fluid_midi_event_t *evt)
+fluid_track_shrink(fluid_track_t *track)
 {
-    evt->next = NULL;
+    fluid_midi_event_t *events;
 
-    if(track->first == NULL)
-    {
-        track->first = evt;
-        track->cur = evt;
-        track->last = evt;
-    }
-    else
+    if(track->nevents == 0 || track->nevents == track->size)
     {
-        track->last->next = evt;
-        track->last = evt;
+        return FLUID_OK;
     }
 
-    return FLUID_OK;
-}
+    events = FLUID_REALLOC(track->events, track->nevents * sizeof(*events));
 
-/*
- * fluid_track_next_event
- */
-fluid_midi_event_t *
-fluid_track_next_event(fluid_track_t *track)
-{
-    if(track->cur != NULL)
+    if(events != NULL)
     {
-        track->cur = track->cur->next;
+        track->events = events;
+        track->size = track->nevents;
     }
 
-    return track->cur;
-}
-
-/*
- * fluid_track_reset
- */
-int
-fluid_track_reset(fluid_track_t *track)
-{
-    track->ticks = 0;
-    track->cur = track->first;
     return FLUID_OK;
 }
 
-/*
- * fluid_track_send_events
- */
-void
-fluid_track_send_events(fluid_track_t *track,
-                        fluid_synth_t *synth,
-                        fluid_player_t *player,
-                        unsigned int ticks)
-{
-    fluid_midi_event_t *event;
-    int seeking = player->seek_ticks >= 0;
-
-    if(seeking)
-    {
-        ticks = player->seek_ticks; /* update target ticks */
-
-        if(track->ticks > ticks)
-        {
-            fluid_track_reset(track);    /* reset track if seeking backwards */
-        }
-    }
-
-    while(1)
-    {
-
-        event = track->cur;
-
-        if(event == NULL)
-        {
-            return;
-        }
-
-        /* 		printf("track=%02d\tticks=%05u\ttrack=%05u\tdtime=%05u\tnext=%05u\n", */
-        /* 		       track->num, */
-        /* 		       ticks, */
-        /* 		       track->ticks, */
-        /* 		       event->dtime, */
-        /* 		       track->ticks + event->dtime); */
-
-        if(track->ticks + event->dtime > ticks)
-        {
-            return;
-        }
-
-        track->ticks += event->dtime;
-
-        if(!player || event->type == MIDI_EOT)
-        {
-        }
-        else if(seeking && (event->type == NOTE_ON || event->type == NOTE_OFF))
-        {
-            /* skip on/off messages */
-        }
-        else
-        {
-            if(player->playback_callback)
-            {
-                player->playback_callback(player->playback_userdata, event);
-            }
-        }
-
-        if(event->type == MIDI_SET_TEMPO)
-        {
-            fluid_player_set_midi_tempo(player, event->param1);
-        }
-
-        fluid_track_next_event(track);
-
-    }
-}
-
 /******************************************************
  *
  *     fluid_player
@@ -1661,6 +1477,12 @@ new_fluid_player(fluid_synth_t *synth)
         player->track[i] = NULL;
     }
 
+    player->timeline = NULL;
+    player->timeline_len = 0;
+    player->timeline_pos = 0;
+    player->file_data = NULL;
+    player->file_data_len = 0;
+    player->file_data_owner = FLUID_FILE_DATA_BORROWED;
     player->synth = synth;
     player->system_timer = NULL;
     player->sample_timer = NULL;
@@ -1774,6 +1596,16 @@ fluid_player_reset(fluid_player_t *player)
         }
     }
 
+    FLUID_FREE(player->timeline);
+    player->timeline = NULL;
+    player->timeline_len = 0;
+    player->timeline_pos = 0;
+
+    /* released after the tracks, whose SYSEX events point into it */
+    fluid_file_unmap(player->file_data, player->file_data_len, player->file_data_owner);
+    player->file_data = NULL;
+    player->file_data_len = 0;
+
     /*	player->current_file = NULL; */
     /*	player->status = FLUID_PLAYER_READY; */
     /*	player->loop = 1; */
@@ -1802,6 +1634,230 @@ fluid_player_add_track(fluid_player_t *player, fluid_track_t *track)
     }
 }
 
+/*
+ * fluid_player_merge_events
+ *
+ * Merges two sorted runs of events into out. On equal ticks the events of
+ * the first run come first, which keeps the merge stable.
+ */
+static void
+fluid_player_merge_events(const fluid_player_event_t *a, int na,
+                          const fluid_player_event_t *b, int nb,
+                          fluid_player_event_t *out)
+{
+    while(na > 0 && nb > 0)
+    {
+        if(b->ticks < a->ticks)
+        {
+            *out++ = *b++;
+            nb--;
+        }
+        else
+        {
+            *out++ = *a++;
+            na--;
+        }
+    }
+
+    FLUID_MEMCPY(out, a, na * sizeof(*a));
+    FLUID_MEMCPY(out + na, b, nb * sizeof(*b));
+}
+
+/*
+ * fluid_player_build_timeline
+ *
+ * Merges the events of all loaded tracks into player->timeline, sorted by
+ * absolute ticks. Each track is already sorted, so the tracks are merged
+ * pairwise as runs. Events sharing a tick keep the track order.
+ */
+int
+fluid_player_build_timeline(fluid_player_t *player)
+{
+    int run_start[MAX_NUMBER_OF_TRACKS + 1];
+    fluid_player_event_t *timeline, *tmp, *swap;
+    fluid_midi_event_t *evt;
+    unsigned int ticks;
+    int count = 0;
+    int i, j, k, width;
+
+    for(i = 0; i < player->ntracks; i++)
+    {
+        count += player->track[i]->nevents;
+    }
+
+    FLUID_FREE(player->timeline);
+    player->timeline = NULL;
+    player->timeline_len = 0;
+    player->timeline_pos = 0;
+
+    if(count == 0)
+    {
+        return FLUID_OK;
+    }
+
+    timeline = FLUID_ARRAY(fluid_player_event_t, count);
+    tmp = FLUID_ARRAY(fluid_player_event_t, count);
+
+    if(timeline == NULL || tmp == NULL)
+    {
+        FLUID_LOG(FLUID_ERR, "Out of memory");
+        FLUID_FREE(timeline);
+        FLUID_FREE(tmp);
+        return FLUID_FAILED;
+    }
+
+    /* one run per track, holding absolute ticks */
+    for(i = 0, j = 0; i < player->ntracks; i++)
+    {
+        run_start[i] = j;
+        ticks = 0;
+
+        for(k = 0; k < player->track[i]->nevents; k++, j++)
+        {
+            evt = &player->track[i]->events[k];
+            ticks += evt->dtime;
+            timeline[j].ticks = ticks;
+            timeline[j].event = evt;
+        }
+    }
+
+    run_start[player->ntracks] = count;
+
+    for(width = 1; width < player->ntracks; width *= 2)
+    {
+        for(i = 0; i < player->ntracks; i += 2 * width)
+        {
+            int lo = run_start[i];
+            int mid = run_start[(i + width < player->ntracks) ? i + width : player->ntracks];
+            int hi = run_start[(i + 2 * width < player->ntracks) ? i + 2 * width : player->ntracks];
+
+            fluid_player_merge_events(timeline + lo, mid - lo,
+                                      timeline + mid, hi - mid, tmp + lo);
+        }
+
+        swap = timeline;
+        timeline = tmp;
+        tmp = swap;
+    }
+
+    FLUID_FREE(tmp);
+
+    player->timeline = timeline;
+    player->timeline_len = count;
+    return FLUID_OK;
+}
+
+/*
+ * fluid_player_find_event
+ *
+ * Returns the index of the first event of the timeline after ticks.
+ */
+static int
+fluid_player_find_event(fluid_player_t *player, unsigned int ticks)
+{
+    int lo = 0;
+    int hi = player->timeline_len;
+
+    while(lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+
+        if(player->timeline[mid].ticks <= ticks)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/*
+ * fluid_player_set_file_tempo
+ *
+ * Applies a SetTempo event of the file at its own tick position, rather
+ * than at the tick of the callback that happens to play it, so tempo
+ * changes do not accumulate timing errors.
+ */
+static void
+fluid_player_set_file_tempo(fluid_player_t *player, int tempo, unsigned int ticks)
+{
+    if((int) ticks > player->start_ticks)
+    {
+        player->start_msec += (int)((ticks - player->start_ticks) * player->deltatime + 0.5);
+        player->start_ticks = ticks;
+    }
+
+    player->miditempo = tempo;
+    player->deltatime = (double) tempo / player->division / 1000.0; /* in milliseconds */
+}
+
+/*
+ * fluid_player_send_events
+ *
+ * Plays the events of the timeline up to ticks. When seeking, plays
+ * everything but notes up to the seek position instead, restarting from
+ * the beginning of the file when seeking backwards.
+ */
+void
+fluid_player_send_events(fluid_player_t *player, unsigned int ticks)
+{
+    const fluid_player_event_t *timeline = player->timeline;
+    fluid_midi_event_t *event;
+    int seeking = player->seek_ticks >= 0;
+    int pos = player->timeline_pos;
+    int end;
+
+    if(seeking)
+    {
+        ticks = player->seek_ticks; /* update target ticks */
+
+        if(pos > 0 && timeline[pos - 1].ticks > ticks)
+        {
+            pos = 0;    /* rewind if seeking backwards */
+        }
+    }
+
+    end = fluid_player_find_event(player, ticks);
+
+    for(; pos < end; pos++)
+    {
+        event = timeline[pos].event;
+
+        if(event->type == MIDI_EOT)
+        {
+        }
+        else if(seeking && (event->type == NOTE_ON || event->type == NOTE_OFF))
+        {
+            /* skip on/off messages */
+        }
+        else
+        {
+            if(player->playback_callback)
+            {
+                player->playback_callback(player->playback_userdata, event);
+            }
+        }
+
+        if(event->type == MIDI_SET_TEMPO)
+        {
+            if(seeking)
+            {
+                fluid_player_set_midi_tempo(player, event->param1);
+            }
+            else
+            {
+                fluid_player_set_file_tempo(player, event->param1, timeline[pos].ticks);
+            }
+        }
+    }
+
+    player->timeline_pos = pos;
+}
+
 /**
  * Change the MIDI callback function. This is usually set to
  * fluid_synth_handle_midi_event, but can optionally be changed
@@ -1892,33 +1948,21 @@ fluid_player_load(fluid_player_t *player, fluid_playlist_item *item)
     fluid_midi_file *midifile;
     char *buffer;
     size_t buffer_length;
-    int buffer_owned;
+    char owner;
+    int result;
 
     if(item->filename != NULL)
     {
-        fluid_file fp;
         /* This file is specified by filename; load the file from disk */
         FLUID_LOG(FLUID_DBG, "%s: %d: Loading midifile %s", __FILE__, __LINE__,
                   item->filename);
-        /* Read the entire contents of the file into the buffer */
-        fp = FLUID_FOPEN(item->filename, "rb");
-
-        if(fp == NULL)
-        {
-            FLUID_LOG(FLUID_ERR, "Couldn't open the MIDI file");
-            return FLUID_FAILED;
-        }
-
-        buffer = fluid_file_read_full(fp, &buffer_length);
-
-        FLUID_FCLOSE(fp);
+        /* Map the entire contents of the file into memory */
+        buffer = fluid_file_map(item->filename, &buffer_length, &owner);
 
         if(buffer == NULL)
         {
             return FLUID_FAILED;
         }
-
-        buffer_owned = 1;
     }
     else
     {
@@ -1928,18 +1972,19 @@ fluid_player_load(fluid_player_t *player, fluid_playlist_item *item)
         buffer = (char *) item->buffer;
         buffer_length = item->buffer_len;
         /* Do not free the buffer (it is owned by the playlist) */
-        buffer_owned = 0;
+        owner = FLUID_FILE_DATA_BORROWED;
     }
 
+    /* The loaded events reference the file contents, which are therefore
+       kept until the next fluid_player_reset() */
+    player->file_data = buffer;
+    player->file_data_len = buffer_length;
+    player->file_data_owner = owner;
+
     midifile = new_fluid_midi_file(buffer, buffer_length);
 
     if(midifile == NULL)
     {
-        if(buffer_owned)
-        {
-            FLUID_FREE(buffer);
-        }
-
         return FLUID_FAILED;
     }
 
@@ -1947,25 +1992,9 @@ fluid_player_load(fluid_player_t *player, fluid_playlist_item *item)
     fluid_player_set_midi_tempo(player, player->miditempo); // Update deltatime
     /*FLUID_LOG(FLUID_DBG, "quarter note division=%d\n", player->division); */
 
-    if(fluid_midi_file_load_tracks(midifile, player) != FLUID_OK)
-    {
-        if(buffer_owned)
-        {
-            FLUID_FREE(buffer);
-        }
-
-        delete_fluid_midi_file(midifile);
-        return FLUID_FAILED;
-    }
-
+    result = fluid_midi_file_load_tracks(midifile, player);
     delete_fluid_midi_file(midifile);
-
-    if(buffer_owned)
-    {
-        FLUID_FREE(buffer);
-    }
-
-    return FLUID_OK;
+    return result;
 }
 
 void
@@ -2001,7 +2030,6 @@ void
 fluid_player_playlist_load(fluid_player_t *player, unsigned int msec)
 {
     fluid_playlist_item *current_playitem;
-    int i;
 
     do
     {
@@ -2026,18 +2054,12 @@ fluid_player_playlist_load(fluid_player_t *player, unsigned int msec)
     player->start_ticks = 0;
     player->cur_ticks = 0;
 
+    player->timeline_pos = 0;
+
     if(player->reset_synth_between_songs)
     {
         fluid_synth_system_reset(player->synth);
     }
-
-    for(i = 0; i < player->ntracks; i++)
-    {
-        if(player->track[i] != NULL)
-        {
-            fluid_track_reset(player->track[i]);
-        }
-    }
 }
 
 /*
@@ -2046,7 +2068,6 @@ fluid_player_playlist_load(fluid_player_t *player, unsigned int msec)
 int
 fluid_player_callback(void *data, unsigned int msec)
 {
-    int i;
     int loadnextfile;
     int status = FLUID_PLAYER_DONE;
     fluid_player_t *player;
@@ -2084,13 +2105,10 @@ fluid_player_callback(void *data, unsigned int msec)
             fluid_synth_all_sounds_off(synth, -1); /* avoid hanging notes */
         }
 
-        for(i = 0; i < player->ntracks; i++)
+        if(player->timeline_pos < player->timeline_len)
         {
-            if(!fluid_track_eot(player->track[i]))
-            {
-                status = FLUID_PLAYER_PLAYING;
-                fluid_track_send_events(player->track[i], synth, player, player->cur_ticks);
-            }
+            status = FLUID_PLAYER_PLAYING;
+            fluid_player_send_events(player, player->cur_ticks);
         }
 
         if(player->seek_ticks >= 0)
@@ -2262,30 +2280,19 @@ int fluid_player_get_current_tick(fluid_player_t *player)
 }
 
 /**
- * Looks through all available MIDI tracks and gets the absolute tick of the very last event to play.
+ * Gets the absolute tick of the very last event to play.
  * @param player MIDI player instance
  * @return Total tick count of the sequence
  * @since 1.1.7
  */
 int fluid_player_get_total_ticks(fluid_player_t *player)
 {
-    int i;
-    int maxTicks = 0;
-
-    for(i = 0; i < player->ntracks; i++)
+    if(player->timeline_len == 0)
     {
-        if(player->track[i] != NULL)
-        {
-            int ticks = fluid_track_get_duration(player->track[i]);
-
-            if(ticks > maxTicks)
-            {
-                maxTicks = ticks;
-            }
-        }
+        return 0;
     }
 
-    return maxTicks;
+    return player->timeline[player->timeline_len - 1].ticks;
 }
 
 /**
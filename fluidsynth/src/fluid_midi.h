@@ -243,15 +243,25 @@ struct _fluid_track_t
 {
     char *name;
     int num;
-    fluid_midi_event_t *first;
-    fluid_midi_event_t *cur;
-    fluid_midi_event_t *last;
-    unsigned int ticks;
+    fluid_midi_event_t *events; /* packed array of the events of the track */
+    int nevents;                /* number of events in events */
+    int size;                   /* allocated size of events */
 };
 
 typedef struct _fluid_track_t fluid_track_t;
 
-#define fluid_track_eot(track)  ((track)->cur == NULL)
+
+/*
+ * fluid_player_event_t
+ * One entry of the player's timeline: the events of all tracks of the
+ * current file merged into a single array sorted by absolute ticks.
+ * The events themselves remain owned by their track.
+ */
+typedef struct
+{
+    unsigned int ticks;         /* absolute position of the event, in ticks */
+    fluid_midi_event_t *event;  /* the event (borrowed from its track) */
+} fluid_player_event_t;
 
 
 /*
@@ -275,6 +285,12 @@ struct _fluid_player_t
     int status;
     int ntracks;
     fluid_track_t *track[MAX_NUMBER_OF_TRACKS];
+    fluid_player_event_t *timeline; /* events of all tracks, sorted by ticks */
+    int timeline_len;         /* number of events in timeline */
+    int timeline_pos;         /* index of the next event of timeline to play */
+    const char *file_data;    /* contents of the current file, referenced by SYSEX events */
+    size_t file_data_len;     /* size of file_data, in bytes */
+    char file_data_owner;     /* how file_data gets released */
     fluid_synth_t *synth;
     fluid_timer_t *system_timer;
     fluid_sample_timer_t *sample_timer;
@@ -312,8 +328,6 @@ typedef struct
     int buf_len;                  /* Length of buffer, in bytes */
     int buf_pos;                  /* Current read position in contents buffer */
     int eof;                      /* The "end of file" condition */
-    int running_status;
-    int c;
     int type;
     int ntracks;
     int uses_smpte;
@@ -322,11 +336,7 @@ typedef struct
     unsigned int division;       /* If uses_SMPTE == 0 then division is
 				  ticks per beat (quarter-note) */
     double tempo;                /* Beats per second (SI rules =) */
-    int tracklen;
-    int trackpos;
-    int eot;
-    int varlen;
-    int dtime;
+    int tracklen;                /* Length of the current track chunk */
 } fluid_midi_file;
 
 
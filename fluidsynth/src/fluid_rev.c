@@ -501,6 +501,8 @@ typedef struct
 } mod_delay_line;
 
 
+static void reset_mod_delay_line(mod_delay_line *mdl);
+
 /*-----------------------------------------------------------------------------
  Modulated delay line initialization.
 
@@ -554,26 +556,11 @@ static int set_mod_delay_line(mod_delay_line *mdl,
             return FLUID_FAILED;
         }
 
-        clear_delay_line(&mdl->dl); /* clears the buffer */
-
-        /* Initializes line_in to the start of the buffer */
-        mdl->dl.line_in = 0;
-        /*  Initializes line_out index INTERP_SAMPLES_NBR samples after line_in */
-        /*  so that the delay between line_out and line_in is:
-            mod_depth + delay_length */
-        mdl->dl.line_out = mdl->dl.line_in + INTERP_SAMPLES_NBR;
+        fluid_memory_account(FLUID_MEMORY_FX, mdl->dl.size * sizeof(fluid_real_t));
     }
 
-    /* Damping low pass filter -------------------*/
-    mdl->dl.damping.buffer = 0;
     /*------------------------------------------------------------------------
-     Initializes modulation members:
-     - modulated center position: center_pos_mod
-     - index rate to know when to update center_pos_mod:index_rate
-     - modulation rate (the speed at which center_pos_mod is modulated: mod_rate
-     - interpolator member: buffer, frac_pos_mod
-     -------------------------------------------------------------------------*/
-    /* Sets the modulation rate. This rate defines how often
+     Sets the modulation rate. This rate defines how often
      the  center position (center_pos_mod ) is modulated .
      The value is expressed in samples. The default value is 1 that means that
      center_pos_mod is updated at every sample.
@@ -592,11 +579,41 @@ static int set_mod_delay_line(mod_delay_line *mdl,
         mdl->mod_rate = mod_rate;
     }
 
+    reset_mod_delay_line(mdl);
+    return FLUID_OK;
+}
+
+/*-----------------------------------------------------------------------------
+ Puts a modulated delay line back in the state it had right after
+ set_mod_delay_line(): empty line, initial read/write positions and
+ cleared filter and interpolator memories.
+
+ @param mdl, pointer on modulated delay line.
+-----------------------------------------------------------------------------*/
+static void reset_mod_delay_line(mod_delay_line *mdl)
+{
+    clear_delay_line(&mdl->dl); /* clears the buffer */
+
+    /* Initializes line_in to the start of the buffer */
+    mdl->dl.line_in = 0;
+    /*  Initializes line_out index INTERP_SAMPLES_NBR samples after line_in */
+    /*  so that the delay between line_out and line_in is:
+        mod_depth + delay_length */
+    mdl->dl.line_out = mdl->dl.line_in + INTERP_SAMPLES_NBR;
+
+    /* Damping low pass filter -------------------*/
+    mdl->dl.damping.buffer = 0;
+    /*------------------------------------------------------------------------
+     Initializes modulation members:
+     - modulated center position: center_pos_mod
+     - index rate to know when to update center_pos_mod:index_rate
+     - interpolator member: buffer, frac_pos_mod
+     -------------------------------------------------------------------------*/
     /* Initializes the modulated center position (center_pos_mod) so that:
         - the delay between line_out and center_pos_mod is mod_depth.
         - the delay between center_pos_mod and line_in is delay_length.
      */
-    mdl->center_pos_mod = (fluid_real_t) INTERP_SAMPLES_NBR + mod_depth;
+    mdl->center_pos_mod = (fluid_real_t) INTERP_SAMPLES_NBR + mdl->mod_depth;
 
     /* index rate to control when to update center_pos_mod */
     /* Important: must be set to get center_pos_mod immediatly used for the
@@ -606,7 +623,6 @@ static int set_mod_delay_line(mod_delay_line *mdl,
     /* initializes 1st order All-Pass interpolator members */
     mdl->buffer = 0;       /* previous delay sample value */
     mdl->frac_pos_mod = 0; /* fractional position (between consecutives sample) */
-    return FLUID_OK;
 }
 
 /*-----------------------------------------------------------------------------
@@ -900,7 +916,14 @@ static void delete_fluid_rev_late(fluid_late *late)
     /* free the delay lines */
     for(i = 0; i < NBR_DELAYS; i++)
     {
-        FLUID_FREE(late->mod_delay_lines[i].dl.line);
+        delay_line *dl = &late->mod_delay_lines[i].dl;
+
+        if(dl->line != NULL)
+        {
+            fluid_memory_account(FLUID_MEMORY_FX, -(ptrdiff_t)(dl->size * sizeof(fluid_real_t)));
+            FLUID_FREE(dl->line);
+            dl->line = NULL;
+        }
     }
 }
 
@@ -1019,7 +1042,8 @@ static int create_fluid_rev_late(fluid_late *late, fluid_real_t sample_rate)
 }
 
 /*
- Clears the delay lines.
+ Clears the delay lines and restarts the modulators, so that a reset
+ reverb behaves exactly like a freshly created one.
 
  @param rev pointer on the reverb.
 */
@@ -1031,8 +1055,14 @@ fluid_revmodel_init(fluid_revmodel_t *rev)
     /* clears all the delay lines */
     for(i = 0; i < NBR_DELAYS; i ++)
     {
-        clear_delay_line(&rev->late.mod_delay_lines[i].dl);
+        reset_mod_delay_line(&rev->late.mod_delay_lines[i]);
+        set_mod_frequency(&rev->late.mod_delay_lines[i].mod,
+                          MOD_FREQ * MOD_RATE,
+                          rev->late.samplerate,
+                          (float)(MOD_PHASE * i));
     }
+
+    rev->late.tone_buffer = 0;
 }
 
 
@@ -1129,6 +1159,28 @@ delete_fluid_revmodel(fluid_revmodel_t *rev)
     FLUID_FREE(rev);
 }
 
+/*
+* Get the bytes allocated for the delay lines of the reverb.
+* @param rev pointer on reverb.
+* Reverb API.
+*/
+size_t
+fluid_revmodel_get_memory(fluid_revmodel_t *rev)
+{
+    size_t bytes = 0;
+    int i;
+
+    for(i = 0; i < NBR_DELAYS; i++)
+    {
+        if(rev->late.mod_delay_lines[i].dl.line != NULL)
+        {
+            bytes += rev->late.mod_delay_lines[i].dl.size * sizeof(fluid_real_t);
+        }
+    }
+
+    return bytes;
+}
+
 /*
 * Sets one or more reverb parameters. Note this must be called at least one
 * time after calling new_fluid_revmodel().
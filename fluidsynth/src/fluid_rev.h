@@ -60,6 +60,7 @@ typedef struct _fluid_revmodel_presets_t
  */
 fluid_revmodel_t *new_fluid_revmodel(fluid_real_t sample_rate);
 void delete_fluid_revmodel(fluid_revmodel_t *rev);
+size_t fluid_revmodel_get_memory(fluid_revmodel_t *rev);
 
 void fluid_revmodel_processmix(fluid_revmodel_t *rev, const fluid_real_t *in,
                                fluid_real_t *left_out, fluid_real_t *right_out);
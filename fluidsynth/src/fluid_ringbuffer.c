@@ -36,7 +36,8 @@
  * advantageous in certain situations, such as passing data between a lower
  * priority thread and a higher "real time" thread, without potential lock
  * contention which could stall the high priority thread.  Note that there may
- * only be one producer thread and one consumer thread.
+ * only be one producer thread and one consumer thread, which never share a
+ * cache line in the queue's bookkeeping.
  */
 fluid_ringbuffer_t *
 new_fluid_ringbuffer(int count, int elementsize)
@@ -53,7 +54,8 @@ new_fluid_ringbuffer(int count, int elementsize)
         return NULL;
     }
 
-    queue->array = FLUID_MALLOC(elementsize * count);
+    /* one spare slot tells a full queue from an empty one */
+    queue->array = FLUID_MALLOC(elementsize * (count + 1));
 
     if(!queue->array)
     {
@@ -63,13 +65,16 @@ new_fluid_ringbuffer(int count, int elementsize)
     }
 
     /* Clear array, in case dynamic pointer reclaiming is being done */
-    FLUID_MEMSET(queue->array, 0, elementsize * count);
+    FLUID_MEMSET(queue->array, 0, elementsize * (count + 1));
 
-    queue->totalcount = count;
+    queue->totalcount = count + 1;
     queue->elementsize = elementsize;
-    fluid_atomic_int_set(&queue->count, 0);
-    queue->in = 0;
-    queue->out = 0;
+    fluid_atomic_int_set(&queue->in, 0);
+    fluid_atomic_int_set(&queue->out, 0);
+    queue->cached_in = 0;
+    queue->cached_out = 0;
+
+    fluid_memory_account(FLUID_MEMORY_EVENTS, fluid_ringbuffer_get_memory(queue));
 
     return (queue);
 }
@@ -85,6 +90,22 @@ void
 delete_fluid_ringbuffer(fluid_ringbuffer_t *queue)
 {
     fluid_return_if_fail(queue != NULL);
+
+    if(queue->array != NULL)
+    {
+        fluid_memory_account(FLUID_MEMORY_EVENTS, -(ptrdiff_t)fluid_ringbuffer_get_memory(queue));
+    }
+
     FLUID_FREE(queue->array);
     FLUID_FREE(queue);
 }
+
+/**
+ * Get the bytes allocated for a queue.
+ * @param queue Lockless queue instance
+ */
+size_t
+fluid_ringbuffer_get_memory(const fluid_ringbuffer_t *queue)
+{
+    return sizeof(*queue) + (size_t)queue->totalcount * queue->elementsize;
+}
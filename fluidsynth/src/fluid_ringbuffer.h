@@ -24,17 +24,30 @@
 #include "fluid_sys.h"
 
 /*
- * Lockless event queue instance.
+ * Lockless single producer, single consumer event queue instance.
+ *
+ * The producer only writes 'in', the consumer only writes 'out'. Each of
+ * them lives on its own cache line together with a private copy of the
+ * other side's index, which is only refreshed from the shared one when
+ * the copy suggests the queue to be full (or empty). The array has one
+ * slot more than the queue can hold, so that 'in' == 'out' means empty.
  */
 struct _fluid_ringbuffer_t
 {
     char *array;  /**< Queue array of arbitrary size elements */
-    int totalcount;       /**< Total count of elements in array */
-    fluid_atomic_int_t count;            /**< Current count of elements */
-    int in;               /**< Index in queue to store next pushed element */
-    int out;              /**< Index in queue of next popped element */
+    int totalcount;       /**< Total count of slots in array (capacity + 1) */
     int elementsize;          /**< Size of each element */
     void *userdata;
+
+    char pad_in[FLUID_DEFAULT_ALIGNMENT];
+    fluid_atomic_int_t in;    /**< Index in queue to store next pushed element */
+    int cached_out;           /**< Producer's copy of 'out' */
+
+    char pad_out[FLUID_DEFAULT_ALIGNMENT];
+    fluid_atomic_int_t out;   /**< Index in queue of next popped element */
+    int cached_in;            /**< Consumer's copy of 'in' */
+
+    char pad_end[FLUID_DEFAULT_ALIGNMENT];
 };
 
 typedef struct _fluid_ringbuffer_t fluid_ringbuffer_t;
@@ -42,6 +55,53 @@ typedef struct _fluid_ringbuffer_t fluid_ringbuffer_t;
 
 fluid_ringbuffer_t *new_fluid_ringbuffer(int count, int elementsize);
 void delete_fluid_ringbuffer(fluid_ringbuffer_t *queue);
+size_t fluid_ringbuffer_get_memory(const fluid_ringbuffer_t *queue);
+
+/* Returns the array slot 'offset' elements after slot 'index' */
+static FLUID_INLINE void *
+fluid_ringbuffer_slot(fluid_ringbuffer_t *queue, int index, int offset)
+{
+    index += offset;
+
+    if(index >= queue->totalcount)
+    {
+        index -= queue->totalcount;
+    }
+
+    return queue->array + queue->elementsize * index;
+}
+
+/**
+ * Get count of free elements in queue, as seen by the producer.
+ * @param queue Lockless queue instance
+ * @param needed Count of elements the caller needs, the shared consumer
+ *   index is only read if fewer are known to be free
+ * @return Count of free elements, may be less than really are
+ */
+static FLUID_INLINE int
+fluid_ringbuffer_get_incount(fluid_ringbuffer_t *queue, int needed)
+{
+    int in = queue->in; /* only written by the producer itself */
+    int used = in - queue->cached_out;
+
+    if(used < 0)
+    {
+        used += queue->totalcount;
+    }
+
+    if(queue->totalcount - 1 - used < needed)
+    {
+        queue->cached_out = fluid_atomic_int_get(&queue->out);
+        used = in - queue->cached_out;
+
+        if(used < 0)
+        {
+            used += queue->totalcount;
+        }
+    }
+
+    return queue->totalcount - 1 - used;
+}
 
 /**
  * Get pointer to next input array element in queue.
@@ -58,8 +118,8 @@ void delete_fluid_ringbuffer(fluid_ringbuffer_t *queue);
 static FLUID_INLINE void *
 fluid_ringbuffer_get_inptr(fluid_ringbuffer_t *queue, int offset)
 {
-    return fluid_atomic_int_get(&queue->count) + offset >= queue->totalcount ? NULL
-           : queue->array + queue->elementsize * ((queue->in + offset) % queue->totalcount);
+    return fluid_ringbuffer_get_incount(queue, offset + 1) <= offset ? NULL
+           : fluid_ringbuffer_slot(queue, queue->in, offset);
 }
 
 /**
@@ -68,19 +128,20 @@ fluid_ringbuffer_get_inptr(fluid_ringbuffer_t *queue, int offset)
  * @param count Normally one, or more if you need to push several items at once
  *
  * This function along with fluid_ringbuffer_get_inptr() form a queue "push"
- * operation and is split into 2 functions to avoid element copy.
+ * operation and is split into 2 functions to avoid element copy. Pushing
+ * several elements at once publishes them to the consumer in one go.
  */
 static FLUID_INLINE void
 fluid_ringbuffer_next_inptr(fluid_ringbuffer_t *queue, int count)
 {
-    fluid_atomic_int_add(&queue->count, count);
-
-    queue->in += count;
+    int in = queue->in + count;
 
-    if(queue->in >= queue->totalcount)
+    if(in >= queue->totalcount)
     {
-        queue->in -= queue->totalcount;
+        in -= queue->totalcount;
     }
+
+    fluid_atomic_int_set(&queue->in, in);
 }
 
 /**
@@ -91,9 +152,66 @@ fluid_ringbuffer_next_inptr(fluid_ringbuffer_t *queue, int count)
 static FLUID_INLINE int
 fluid_ringbuffer_get_count(fluid_ringbuffer_t *queue)
 {
-    return fluid_atomic_int_get(&queue->count);
+    int count = fluid_atomic_int_get(&queue->in) - fluid_atomic_int_get(&queue->out);
+
+    return count < 0 ? count + queue->totalcount : count;
 }
 
+/**
+ * Get count of elements ready to be popped, as seen by the consumer.
+ * @param queue Lockless queue instance
+ * @return Count of elements that can be accessed with
+ *   fluid_ringbuffer_get_outptr_at() before fluid_ringbuffer_next_outptrs()
+ *
+ * Only reads the shared producer index if no element is known to be queued.
+ */
+static FLUID_INLINE int
+fluid_ringbuffer_get_outcount(fluid_ringbuffer_t *queue)
+{
+    int out = queue->out; /* only written by the consumer itself */
+
+    if(queue->cached_in == out)
+    {
+        queue->cached_in = fluid_atomic_int_get(&queue->in);
+    }
+
+    return queue->cached_in - out < 0 ? queue->cached_in - out + queue->totalcount
+           : queue->cached_in - out;
+}
+
+/**
+ * Get pointer to a queued output array element.
+ * @param queue Lockless queue instance
+ * @param offset Index of the element, must be less than the count returned
+ *   by fluid_ringbuffer_get_outcount()
+ * @return Pointer to array element data in the queue, can only be used up
+ *   until fluid_ringbuffer_next_outptrs() is called.
+ */
+static FLUID_INLINE void *
+fluid_ringbuffer_get_outptr_at(fluid_ringbuffer_t *queue, int offset)
+{
+    return fluid_ringbuffer_slot(queue, queue->out, offset);
+}
+
+/**
+ * Advance the output queue index to complete a batch "pop" operation.
+ * @param queue Lockless queue instance
+ * @param count Count of elements popped
+ *
+ * Hands all popped slots back to the producer in one go.
+ */
+static FLUID_INLINE void
+fluid_ringbuffer_next_outptrs(fluid_ringbuffer_t *queue, int count)
+{
+    int out = queue->out + count;
+
+    if(out >= queue->totalcount)
+    {
+        out -= queue->totalcount;
+    }
+
+    fluid_atomic_int_set(&queue->out, out);
+}
 
 /**
  * Get pointer to next output array element in queue.
@@ -107,8 +225,8 @@ fluid_ringbuffer_get_count(fluid_ringbuffer_t *queue)
 static FLUID_INLINE void *
 fluid_ringbuffer_get_outptr(fluid_ringbuffer_t *queue)
 {
-    return fluid_ringbuffer_get_count(queue) == 0 ? NULL
-           : queue->array + queue->elementsize * queue->out;
+    return fluid_ringbuffer_get_outcount(queue) == 0 ? NULL
+           : fluid_ringbuffer_get_outptr_at(queue, 0);
 }
 
 
@@ -122,12 +240,7 @@ fluid_ringbuffer_get_outptr(fluid_ringbuffer_t *queue)
 static FLUID_INLINE void
 fluid_ringbuffer_next_outptr(fluid_ringbuffer_t *queue)
 {
-    fluid_atomic_int_add(&queue->count, -1);
-
-    if(++queue->out == queue->totalcount)
-    {
-        queue->out = 0;
-    }
+    fluid_ringbuffer_next_outptrs(queue, 1);
 }
 
 #endif /* _FLUID_ringbuffer_H */
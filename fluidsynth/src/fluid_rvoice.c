@@ -290,28 +290,19 @@ fluid_rvoice_check_sample_sanity(fluid_rvoice_t *voice)
 
 
 /**
- * Synthesize a voice to a buffer.
- *
- * @param voice rvoice to synthesize
- * @param dsp_buf Audio buffer to synthesize to (#FLUID_BUFSIZE in length)
- * @return Count of samples written to dsp_buf. (-1 means voice is currently
- * quiet, 0 .. #FLUID_BUFSIZE-1 means voice finished.)
+ * Prepare a voice for synthesizing the next block: check the sample and
+ * process a pending noteoff.
  *
- * Panning, reverb and chorus are processed separately. The dsp interpolation
- * routine is in (fluid_rvoice_dsp.c).
+ * @return FALSE if the voice has no sample to play
  */
-int
-fluid_rvoice_write(fluid_rvoice_t *voice, fluid_real_t *dsp_buf)
+static FLUID_INLINE int
+fluid_rvoice_begin_block(fluid_rvoice_t *voice)
 {
-    int ticks = voice->envlfo.ticks;
-    int count, is_looping;
-    fluid_real_t modenv_val;
-
     /******************* sample sanity check **********/
 
     if(!voice->dsp.sample)
     {
-        return 0;
+        return FALSE;
     }
 
     if(voice->dsp.check_sample_sanity_flag)
@@ -329,55 +320,34 @@ fluid_rvoice_write(fluid_rvoice_t *voice, fluid_real_t *dsp_buf)
 
     voice->envlfo.ticks += FLUID_BUFSIZE;
 
-    /******************* vol env **********************/
-
-    fluid_adsr_env_calc(&voice->envlfo.volenv, 1);
-    fluid_check_fpe("voice_write vol env");
-
-    if(fluid_adsr_env_get_section(&voice->envlfo.volenv) == FLUID_VOICE_ENVFINISHED)
-    {
-        return 0;
-    }
-
-    /******************* mod env **********************/
-
-    fluid_adsr_env_calc(&voice->envlfo.modenv, 0);
-    fluid_check_fpe("voice_write mod env");
-
-    /******************* lfo **********************/
-
-    fluid_lfo_calc(&voice->envlfo.modlfo, ticks);
-    fluid_check_fpe("voice_write mod LFO");
-    fluid_lfo_calc(&voice->envlfo.viblfo, ticks);
-    fluid_check_fpe("voice_write vib LFO");
-
-    /******************* amplitude **********************/
-
-    count = fluid_rvoice_calc_amp(voice);
-
-    if(count <= 0)
-    {
-        return count; /* return -1 if voice is quiet, 0 if voice has finished */
-    }
+    return TRUE;
+}
 
-    /******************* phase **********************/
+/* SF2.04 section 8.1.2 #26:
+ * attack of modEnv is convex ?!?
+ */
+static FLUID_INLINE fluid_real_t
+fluid_rvoice_get_modenv_val(fluid_rvoice_t *voice)
+{
+    return (fluid_adsr_env_get_section(&voice->envlfo.modenv) == FLUID_VOICE_ENVATTACK)
+           ? fluid_convex(127 * fluid_adsr_env_get_val(&voice->envlfo.modenv))
+           : fluid_adsr_env_get_val(&voice->envlfo.modenv);
+}
 
-    /* SF2.04 section 8.1.2 #26:
-     * attack of modEnv is convex ?!?
-     */
-    modenv_val = (fluid_adsr_env_get_section(&voice->envlfo.modenv) == FLUID_VOICE_ENVATTACK)
-                 ? fluid_convex(127 * fluid_adsr_env_get_val(&voice->envlfo.modenv))
-                 : fluid_adsr_env_get_val(&voice->envlfo.modenv);
+/**
+ * Calculate the phase increment of a voice and advance portamento.
+ *
+ * @param voice rvoice to update
+ * @param pitch current pitch of the voice in cents, including all modulation
+ */
+static FLUID_INLINE void
+fluid_rvoice_calc_phase_incr(fluid_rvoice_t *voice, fluid_real_t pitch)
+{
     /* Calculate the number of samples, that the DSP loop advances
      * through the original waveform with each step in the output
      * buffer. It is the ratio between the frequencies of original
      * waveform and output waveform.*/
-    voice->dsp.phase_incr = fluid_ct2hz_real(voice->dsp.pitch +
-                            voice->dsp.pitchoffset +
-                            fluid_lfo_get_val(&voice->envlfo.modlfo) * voice->envlfo.modlfo_to_pitch
-                            + fluid_lfo_get_val(&voice->envlfo.viblfo) * voice->envlfo.viblfo_to_pitch
-                            + modenv_val * voice->envlfo.modenv_to_pitch)
-                            / voice->dsp.root_pitch_hz;
+    voice->dsp.phase_incr = fluid_ct2hz_real(pitch) / voice->dsp.root_pitch_hz;
 
     /******************* portamento ****************/
     /* pitchoffset is updated if enabled.
@@ -419,6 +389,105 @@ fluid_rvoice_write(fluid_rvoice_t *voice, fluid_real_t *dsp_buf)
     {
         voice->dsp.phase_incr = 1;
     }
+}
+
+static int
+fluid_rvoice_dsp_interpolate(fluid_rvoice_dsp_t *dsp, fluid_real_t *dsp_buf, int is_looping)
+{
+    /* Sample played at its own rate (e.g. drums at their root key), the
+     * interpolation would be an identity operation */
+    if(dsp->phase_incr == 1 && fluid_phase_fract(dsp->phase) == 0)
+    {
+        return fluid_rvoice_dsp_copy_unity(dsp, dsp_buf, is_looping);
+    }
+
+    switch(dsp->interp_method)
+    {
+    case FLUID_INTERP_NONE:
+        return fluid_rvoice_dsp_interpolate_none(dsp, dsp_buf, is_looping);
+
+    case FLUID_INTERP_LINEAR:
+        return fluid_rvoice_dsp_interpolate_linear(dsp, dsp_buf, is_looping);
+
+    case FLUID_INTERP_4THORDER:
+    default:
+        return fluid_rvoice_dsp_interpolate_4th_order(dsp, dsp_buf, is_looping);
+
+    case FLUID_INTERP_7THORDER:
+        return fluid_rvoice_dsp_interpolate_7th_order(dsp, dsp_buf, is_looping);
+
+    case FLUID_INTERP_SINC:
+        return fluid_rvoice_dsp_interpolate_sinc(dsp, dsp_buf, is_looping);
+    }
+}
+
+/*
+ * Interpolate from the mipmap level of the sample whose phase increment is
+ * at most 1, so that high notes don't alias. The level is played through a
+ * copy of the dsp parameters with all sample positions scaled down; phase,
+ * amplitude and loop state are mapped back afterwards. A level is only used
+ * if the loop of the voice maps onto it without being detuned.
+ */
+static int
+fluid_rvoice_dsp_interpolate_mipmap(fluid_rvoice_dsp_t *dsp, fluid_real_t *dsp_buf, int is_looping)
+{
+    fluid_rvoice_dsp_t level;
+    fluid_sample_t *sample = dsp->sample;
+    fluid_phase_t base;
+    int count, shift = 0;
+    unsigned int loop_frames = dsp->loopend - dsp->loopstart;
+
+    while(sample->mipmap != NULL && dsp->phase_incr > (fluid_real_t)(1 << shift)
+            && (loop_frames & ((2U << shift) - 1)) == 0)
+    {
+        sample = sample->mipmap;
+        shift++;
+    }
+
+    if(shift == 0)
+    {
+        return fluid_rvoice_dsp_interpolate(dsp, dsp_buf, is_looping);
+    }
+
+    base = ((fluid_phase_t)dsp->sample->start) << 32;
+
+    level = *dsp;
+    level.sample = sample;
+    level.start = (dsp->start - dsp->sample->start) >> shift;
+    level.end = (dsp->end - dsp->sample->start) >> shift;
+    level.loopstart = (dsp->loopstart - dsp->sample->start) >> shift;
+    level.loopend = (dsp->loopend - dsp->sample->start) >> shift;
+    level.phase = (dsp->phase - base) >> shift;
+    level.phase_incr = dsp->phase_incr / (1 << shift);
+
+    count = fluid_rvoice_dsp_interpolate(&level, dsp_buf, is_looping);
+
+    dsp->phase = (level.phase << shift) + base;
+    dsp->amp = level.amp;
+    dsp->has_looped = level.has_looped;
+
+    return count;
+}
+
+/**
+ * Run the sample interpolation of a voice, whose control-rate parameters
+ * have already been updated for this block.
+ *
+ * The coefficients of the resonant filter are updated as well, but it is up
+ * to the caller to apply the resonant filter and then
+ * fluid_rvoice_filter_custom() to the samples written.
+ *
+ * @param voice rvoice to synthesize
+ * @param dsp_buf Audio buffer to synthesize to (#FLUID_BUFSIZE in length)
+ * @param modenv_val Value of the modulation envelope for this block
+ * @return Count of samples written to dsp_buf. (0 .. #FLUID_BUFSIZE-1 means
+ * voice finished.)
+ */
+int
+fluid_rvoice_write_dsp(fluid_rvoice_t *voice, fluid_real_t *dsp_buf,
+                       fluid_real_t modenv_val)
+{
+    int count, is_looping;
 
     /* voice is currently looping? */
     is_looping = voice->dsp.samplemode == FLUID_LOOP_DURING_RELEASE
@@ -431,24 +500,13 @@ fluid_rvoice_write(fluid_rvoice_t *voice, fluid_real_t *dsp_buf)
      * Depending on the position in the loop and the loop size, this
      * may require several runs. */
 
-    switch(voice->dsp.interp_method)
+    if(voice->dsp.sample->mipmap != NULL && voice->dsp.phase_incr > 1)
     {
-    case FLUID_INTERP_NONE:
-        count = fluid_rvoice_dsp_interpolate_none(&voice->dsp, dsp_buf, is_looping);
-        break;
-
-    case FLUID_INTERP_LINEAR:
-        count = fluid_rvoice_dsp_interpolate_linear(&voice->dsp, dsp_buf, is_looping);
-        break;
-
-    case FLUID_INTERP_4THORDER:
-    default:
-        count = fluid_rvoice_dsp_interpolate_4th_order(&voice->dsp, dsp_buf, is_looping);
-        break;
-
-    case FLUID_INTERP_7THORDER:
-        count = fluid_rvoice_dsp_interpolate_7th_order(&voice->dsp, dsp_buf, is_looping);
-        break;
+        count = fluid_rvoice_dsp_interpolate_mipmap(&voice->dsp, dsp_buf, is_looping);
+    }
+    else
+    {
+        count = fluid_rvoice_dsp_interpolate(&voice->dsp, dsp_buf, is_looping);
     }
 
     fluid_check_fpe("voice_write interpolation");
@@ -464,15 +522,390 @@ fluid_rvoice_write(fluid_rvoice_t *voice, fluid_real_t *dsp_buf)
                           fluid_lfo_get_val(&voice->envlfo.modlfo) * voice->envlfo.modlfo_to_fc +
                           modenv_val * voice->envlfo.modenv_to_fc);
 
-    fluid_iir_filter_apply(&voice->resonant_filter, dsp_buf, count);
+    return count;
+}
 
+/**
+ * Apply the additional custom filter of a voice.
+ *
+ * @param voice rvoice the samples belong to
+ * @param dsp_buf Audio buffer, already passed through the resonant filter
+ * @param count Count of samples in dsp_buf
+ */
+void
+fluid_rvoice_filter_custom(fluid_rvoice_t *voice, fluid_real_t *dsp_buf, int count)
+{
     /* additional custom filter - only uses the fixed modulator, no lfos... */
-    fluid_iir_filter_calc(&voice->resonant_custom_filter, voice->dsp.output_rate, 0);
-    fluid_iir_filter_apply(&voice->resonant_custom_filter, dsp_buf, count);
+    fluid_iir_filter_calc(&voice->cold->resonant_custom_filter, voice->dsp.output_rate, 0);
+    fluid_iir_filter_apply(&voice->cold->resonant_custom_filter, dsp_buf, count);
+}
+
+/**
+ * Synthesize a voice to a buffer.
+ *
+ * @param voice rvoice to synthesize
+ * @param dsp_buf Audio buffer to synthesize to (#FLUID_BUFSIZE in length)
+ * @return Count of samples written to dsp_buf. (-1 means voice is currently
+ * quiet, 0 .. #FLUID_BUFSIZE-1 means voice finished.)
+ *
+ * Panning, reverb and chorus are processed separately. The dsp interpolation
+ * routine is in (fluid_rvoice_dsp.c).
+ */
+int
+fluid_rvoice_write(fluid_rvoice_t *voice, fluid_real_t *dsp_buf)
+{
+    int ticks = voice->envlfo.ticks;
+    int count;
+    fluid_real_t modenv_val;
+
+    if(!fluid_rvoice_begin_block(voice))
+    {
+        return 0;
+    }
+
+    /******************* vol env **********************/
+
+    fluid_adsr_env_calc(&voice->envlfo.volenv, 1);
+    fluid_check_fpe("voice_write vol env");
+
+    if(fluid_adsr_env_get_section(&voice->envlfo.volenv) == FLUID_VOICE_ENVFINISHED)
+    {
+        return 0;
+    }
+
+    /******************* mod env **********************/
+
+    fluid_adsr_env_calc(&voice->envlfo.modenv, 0);
+    fluid_check_fpe("voice_write mod env");
+
+    /******************* lfo **********************/
+
+    fluid_lfo_calc(&voice->envlfo.modlfo, ticks);
+    fluid_check_fpe("voice_write mod LFO");
+    fluid_lfo_calc(&voice->envlfo.viblfo, ticks);
+    fluid_check_fpe("voice_write vib LFO");
+
+    /******************* amplitude **********************/
+
+    count = fluid_rvoice_calc_amp(voice);
+
+    if(count <= 0)
+    {
+        return count; /* return -1 if voice is quiet, 0 if voice has finished */
+    }
+
+    /******************* phase **********************/
+
+    modenv_val = fluid_rvoice_get_modenv_val(voice);
+
+    fluid_rvoice_calc_phase_incr(voice, voice->dsp.pitch +
+                                 voice->dsp.pitchoffset +
+                                 fluid_lfo_get_val(&voice->envlfo.modlfo) * voice->envlfo.modlfo_to_pitch
+                                 + fluid_lfo_get_val(&voice->envlfo.viblfo) * voice->envlfo.viblfo_to_pitch
+                                 + modenv_val * voice->envlfo.modenv_to_pitch);
+
+    /******************* dsp ****************************/
+
+    count = fluid_rvoice_write_dsp(voice, dsp_buf, modenv_val);
+
+    if(count > 0)
+    {
+        fluid_iir_filter_apply(&voice->resonant_filter, dsp_buf, count);
+        fluid_rvoice_filter_custom(voice, dsp_buf, count);
+    }
 
     return count;
 }
 
+/**
+ * Resize the arrays of a control-rate scratch space.
+ * NOTE: Not hard real-time capable.
+ *
+ * @param ctrl scratch space to resize, may be zero-initialized
+ * @param size number of voices the arrays must have room for
+ * @return FLUID_OK or FLUID_FAILED, in which case ctrl is left untouched
+ */
+int
+fluid_rvoice_control_resize(fluid_rvoice_control_t *ctrl, int size)
+{
+    fluid_rvoice_control_t resized;
+
+    if(size < 1)
+    {
+        size = 1;
+    }
+
+    resized.size = size;
+    resized.status = FLUID_ARRAY(int, size);
+    resized.modenv_val = FLUID_ARRAY(fluid_real_t, size);
+    resized.pitch = FLUID_ARRAY(fluid_real_t, size);
+    resized.modlfo_to_pitch = FLUID_ARRAY(fluid_real_t, size);
+    resized.viblfo_to_pitch = FLUID_ARRAY(fluid_real_t, size);
+    resized.modenv_to_pitch = FLUID_ARRAY(fluid_real_t, size);
+    resized.env_val = FLUID_ARRAY(fluid_real_t, 2 * size);
+    resized.env_coeff = FLUID_ARRAY(fluid_real_t, 2 * size);
+    resized.env_incr = FLUID_ARRAY(fluid_real_t, 2 * size);
+    resized.env_min = FLUID_ARRAY(fluid_real_t, 2 * size);
+    resized.env_max = FLUID_ARRAY(fluid_real_t, 2 * size);
+    resized.env_clamped = FLUID_ARRAY(int, 2 * size);
+    resized.lfo_val = FLUID_ARRAY(fluid_real_t, 2 * size);
+    resized.lfo_incr = FLUID_ARRAY(fluid_real_t, 2 * size);
+    resized.lfo_on = FLUID_ARRAY(int, 2 * size);
+
+    if(resized.status == NULL || resized.modenv_val == NULL || resized.pitch == NULL
+            || resized.modlfo_to_pitch == NULL || resized.viblfo_to_pitch == NULL
+            || resized.modenv_to_pitch == NULL || resized.env_val == NULL
+            || resized.env_coeff == NULL || resized.env_incr == NULL
+            || resized.env_min == NULL || resized.env_max == NULL
+            || resized.env_clamped == NULL || resized.lfo_val == NULL
+            || resized.lfo_incr == NULL || resized.lfo_on == NULL)
+    {
+        fluid_rvoice_control_free(&resized);
+        return FLUID_FAILED;
+    }
+
+    fluid_rvoice_control_free(ctrl);
+    *ctrl = resized;
+    return FLUID_OK;
+}
+
+/**
+ * Free the arrays of a control-rate scratch space.
+ */
+void
+fluid_rvoice_control_free(fluid_rvoice_control_t *ctrl)
+{
+    FLUID_FREE(ctrl->status);
+    FLUID_FREE(ctrl->modenv_val);
+    FLUID_FREE(ctrl->pitch);
+    FLUID_FREE(ctrl->modlfo_to_pitch);
+    FLUID_FREE(ctrl->viblfo_to_pitch);
+    FLUID_FREE(ctrl->modenv_to_pitch);
+    FLUID_FREE(ctrl->env_val);
+    FLUID_FREE(ctrl->env_coeff);
+    FLUID_FREE(ctrl->env_incr);
+    FLUID_FREE(ctrl->env_min);
+    FLUID_FREE(ctrl->env_max);
+    FLUID_FREE(ctrl->env_clamped);
+    FLUID_FREE(ctrl->lfo_val);
+    FLUID_FREE(ctrl->lfo_incr);
+    FLUID_FREE(ctrl->lfo_on);
+    FLUID_MEMSET(ctrl, 0, sizeof(*ctrl));
+}
+
+/**
+ * Get the bytes allocated for the arrays of a control-rate scratch space.
+ */
+size_t
+fluid_rvoice_control_get_memory(const fluid_rvoice_control_t *ctrl)
+{
+    if(ctrl->status == NULL)
+    {
+        return 0;
+    }
+
+    /* see fluid_rvoice_control_resize() */
+    return ctrl->size * (sizeof(int) + 5 * sizeof(fluid_real_t))
+           + 2 * ctrl->size * (2 * sizeof(int) + 7 * sizeof(fluid_real_t));
+}
+
+/* Gather the state of an envelope into slot i of the scratch space */
+static FLUID_INLINE void
+fluid_rvoice_control_gather_env(fluid_rvoice_control_t *ctrl, int i,
+                                fluid_adsr_env_t *env, int is_volenv)
+{
+    fluid_env_data_t *env_data = fluid_adsr_env_advance(env, is_volenv);
+
+    ctrl->env_val[i] = fluid_adsr_env_get_val(env);
+    ctrl->env_coeff[i] = env_data->coeff;
+    ctrl->env_incr[i] = env_data->increment;
+    ctrl->env_min[i] = env_data->min;
+    ctrl->env_max[i] = env_data->max;
+}
+
+/* Gather the state of an LFO into slot i of the scratch space */
+static FLUID_INLINE void
+fluid_rvoice_control_gather_lfo(fluid_rvoice_control_t *ctrl, int i,
+                                fluid_lfo_t *lfo, unsigned int cur_delay)
+{
+    /* an LFO that is still delayed keeps its value */
+    ctrl->lfo_on[i] = cur_delay >= lfo->delay;
+    ctrl->lfo_val[i] = lfo->val;
+    ctrl->lfo_incr[i] = ctrl->lfo_on[i] ? lfo->increment : 0.0f;
+}
+
+/**
+ * Update the control-rate parameters of a batch of voices for the next block.
+ *
+ * This does the same as the first half of fluid_rvoice_write() for every
+ * voice, but the envelopes, LFOs and pitches of all voices are gathered into
+ * the structure-of-arrays scratch space first. The math on them then runs
+ * in tight loops across voices, which the compiler can vectorize, instead of
+ * branching through one voice struct after another.
+ *
+ * Afterwards ctrl->status[i] tells, whether voices[i] is quiet (-1), has
+ * finished (0) or is to be passed to fluid_rvoice_write_dsp() with
+ * ctrl->modenv_val[i] (1).
+ *
+ * @param voices rvoices to update
+ * @param voice_count number of voices, at most ctrl->size
+ * @param ctrl scratch space
+ */
+void
+fluid_rvoice_control_multi(fluid_rvoice_t **voices, int voice_count,
+                           fluid_rvoice_control_t *ctrl)
+{
+    /* envelopes and LFOs: the first half belongs to volenv/modlfo,
+     * the second half to modenv/viblfo */
+    int env_count = 2 * voice_count;
+
+    int *FLUID_RESTRICT status = ctrl->status;
+    int *FLUID_RESTRICT env_clamped = ctrl->env_clamped;
+    fluid_real_t *FLUID_RESTRICT env_val = ctrl->env_val;
+    fluid_real_t *FLUID_RESTRICT env_coeff = ctrl->env_coeff;
+    fluid_real_t *FLUID_RESTRICT env_incr = ctrl->env_incr;
+    fluid_real_t *FLUID_RESTRICT env_min = ctrl->env_min;
+    fluid_real_t *FLUID_RESTRICT env_max = ctrl->env_max;
+    fluid_real_t *FLUID_RESTRICT lfo_val = ctrl->lfo_val;
+    fluid_real_t *FLUID_RESTRICT lfo_incr = ctrl->lfo_incr;
+    fluid_real_t *FLUID_RESTRICT pitch = ctrl->pitch;
+    fluid_real_t *FLUID_RESTRICT modenv_val = ctrl->modenv_val;
+    fluid_real_t *FLUID_RESTRICT modlfo_to_pitch = ctrl->modlfo_to_pitch;
+    fluid_real_t *FLUID_RESTRICT viblfo_to_pitch = ctrl->viblfo_to_pitch;
+    fluid_real_t *FLUID_RESTRICT modenv_to_pitch = ctrl->modenv_to_pitch;
+    int i;
+
+    FLUID_ASSERT(voice_count <= ctrl->size);
+
+    /* gather */
+    for(i = 0; i < voice_count; i++)
+    {
+        fluid_rvoice_t *voice = voices[i];
+        int ticks = voice->envlfo.ticks;
+
+        status[i] = fluid_rvoice_begin_block(voice);
+
+        if(!status[i])
+        {
+            /* no sample, let the slots run idle */
+            env_val[i] = env_coeff[i] = env_incr[i] = env_min[i] = env_max[i] = 0.0f;
+            env_val[voice_count + i] = env_coeff[voice_count + i] = env_incr[voice_count + i] = 0.0f;
+            env_min[voice_count + i] = env_max[voice_count + i] = 0.0f;
+            lfo_val[i] = lfo_incr[i] = lfo_val[voice_count + i] = lfo_incr[voice_count + i] = 0.0f;
+            continue;
+        }
+
+        fluid_rvoice_control_gather_env(ctrl, i, &voice->envlfo.volenv, 1);
+        fluid_rvoice_control_gather_env(ctrl, voice_count + i, &voice->envlfo.modenv, 0);
+        fluid_rvoice_control_gather_lfo(ctrl, i, &voice->envlfo.modlfo, ticks);
+        fluid_rvoice_control_gather_lfo(ctrl, voice_count + i, &voice->envlfo.viblfo, ticks);
+    }
+
+    /******************* envelopes **********************/
+
+#ifdef _OPENMP
+    #pragma omp simd
+#endif
+    for(i = 0; i < env_count; i++)
+    {
+        /* calculate the envelope value and check for valid range */
+        fluid_real_t x = env_coeff[i] * env_val[i] + env_incr[i];
+
+        env_clamped[i] = (x < env_min[i]) | (x > env_max[i]);
+        env_val[i] = (x < env_min[i]) ? env_min[i] : ((x > env_max[i]) ? env_max[i] : x);
+    }
+
+    /******************* lfos **********************/
+
+#ifdef _OPENMP
+    #pragma omp simd
+#endif
+    for(i = 0; i < env_count; i++)
+    {
+        fluid_real_t x = lfo_val[i] + lfo_incr[i];
+        int above = x > (fluid_real_t) 1.0;
+        int below = x < (fluid_real_t) -1.0;
+
+        lfo_incr[i] = (above | below) ? -lfo_incr[i] : lfo_incr[i];
+        lfo_val[i] = above ? (fluid_real_t) 2.0 - x : (below ? (fluid_real_t) -2.0 - x : x);
+    }
+
+    /* scatter, and everything that depends on it */
+    for(i = 0; i < voice_count; i++)
+    {
+        fluid_rvoice_t *voice = voices[i];
+
+        /* idle slot, gets no pitch */
+        pitch[i] = modlfo_to_pitch[i] = viblfo_to_pitch[i] = modenv_to_pitch[i] = 0.0f;
+        modenv_val[i] = 0.0f;
+
+        if(!status[i])
+        {
+            continue;
+        }
+
+        fluid_adsr_env_step(&voice->envlfo.volenv, env_val[i], env_clamped[i]);
+
+        if(fluid_adsr_env_get_section(&voice->envlfo.volenv) == FLUID_VOICE_ENVFINISHED)
+        {
+            status[i] = 0;
+            continue;
+        }
+
+        fluid_adsr_env_step(&voice->envlfo.modenv, env_val[voice_count + i], env_clamped[voice_count + i]);
+
+        if(ctrl->lfo_on[i])
+        {
+            voice->envlfo.modlfo.val = lfo_val[i];
+            voice->envlfo.modlfo.increment = lfo_incr[i];
+        }
+
+        if(ctrl->lfo_on[voice_count + i])
+        {
+            voice->envlfo.viblfo.val = lfo_val[voice_count + i];
+            voice->envlfo.viblfo.increment = lfo_incr[voice_count + i];
+        }
+
+        fluid_check_fpe("voice_write envelopes and LFOs");
+
+        /******************* amplitude **********************/
+
+        status[i] = fluid_rvoice_calc_amp(voice);
+
+        if(status[i] <= 0)
+        {
+            continue;
+        }
+
+        modenv_val[i] = fluid_rvoice_get_modenv_val(voice);
+        pitch[i] = voice->dsp.pitch + voice->dsp.pitchoffset;
+        modlfo_to_pitch[i] = voice->envlfo.modlfo_to_pitch;
+        viblfo_to_pitch[i] = voice->envlfo.viblfo_to_pitch;
+        modenv_to_pitch[i] = voice->envlfo.modenv_to_pitch;
+    }
+
+    /******************* phase **********************/
+
+#ifdef _OPENMP
+    #pragma omp simd
+#endif
+    for(i = 0; i < voice_count; i++)
+    {
+        pitch[i] = pitch[i]
+                   + lfo_val[i] * modlfo_to_pitch[i]
+                   + lfo_val[voice_count + i] * viblfo_to_pitch[i]
+                   + modenv_val[i] * modenv_to_pitch[i];
+    }
+
+    for(i = 0; i < voice_count; i++)
+    {
+        if(status[i] > 0)
+        {
+            fluid_rvoice_calc_phase_incr(voices[i], pitch[i]);
+        }
+    }
+}
+
 /**
  * Initialize buffers up to (and including) bufnum
  */
@@ -559,7 +992,7 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_reset)
 
     /* Clear sample history in filter */
     fluid_iir_filter_reset(&voice->resonant_filter);
-    fluid_iir_filter_reset(&voice->resonant_custom_filter);
+    fluid_iir_filter_reset(&voice->cold->resonant_custom_filter);
 
     /* Force setting of the phase at the first DSP loop run
      * This cannot be done earlier, because it depends on modulators.
@@ -766,6 +1199,7 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_set_interp_method)
     int value = param[0].i;
 
     voice->dsp.interp_method = value;
+    voice->dsp.sinc_table = param[1].ptr;
 }
 
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_set_root_pitch_hz)
@@ -866,6 +1300,21 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_set_synth_gain)
     voice->dsp.check_sample_sanity_flag |= FLUID_SAMPLESANITY_CHECK;
 }
 
+/*
+ * Sets the MIDI channel and preset the rendering cost of the voice is
+ * accounted to, and restarts its accounting.
+ */
+DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_set_owner)
+{
+    fluid_rvoice_t *voice = obj;
+
+    voice->cold->chan = param[0].i;
+    voice->cold->preset = param[1].i;
+    voice->cold->started = TRUE;
+    voice->cold->cycles = 0;
+    voice->cold->samples = 0;
+}
+
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_set_start)
 {
     fluid_rvoice_t *voice = obj;
@@ -934,3 +1383,122 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_voiceoff)
 }
 
 
+
+/* Bytes allocated by new_fluid_rvoice_arena() */
+#define FLUID_RVOICE_ARENA_BYTES(_size) (sizeof(fluid_rvoice_arena_t) \
+        + (_size) * (sizeof(fluid_rvoice_t) + sizeof(fluid_rvoice_cold_t)) + FLUID_DEFAULT_ALIGNMENT - 1)
+
+/**
+ * Create an arena for rvoices.
+ * @param size number of rvoices to reserve room for
+ * @return the arena, or NULL on out of memory
+ */
+fluid_rvoice_arena_t *
+new_fluid_rvoice_arena(int size)
+{
+    fluid_rvoice_arena_t *arena;
+
+    fluid_return_val_if_fail(size > 0, NULL);
+
+    arena = FLUID_NEW(fluid_rvoice_arena_t);
+
+    if(arena == NULL)
+    {
+        FLUID_LOG(FLUID_ERR, "Out of memory");
+        return NULL;
+    }
+
+    FLUID_MEMSET(arena, 0, sizeof(*arena));
+    arena->size = size;
+    arena->hot_mem = FLUID_ARRAY_ALIGNED(fluid_rvoice_t, size, FLUID_DEFAULT_ALIGNMENT);
+    arena->cold = FLUID_ARRAY(fluid_rvoice_cold_t, size);
+
+    if(arena->hot_mem == NULL || arena->cold == NULL)
+    {
+        FLUID_LOG(FLUID_ERR, "Out of memory");
+        delete_fluid_rvoice_arena(arena);
+        return NULL;
+    }
+
+    arena->hot = fluid_align_ptr(arena->hot_mem, FLUID_DEFAULT_ALIGNMENT);
+    FLUID_MEMSET(arena->hot, 0, size * sizeof(fluid_rvoice_t));
+    FLUID_MEMSET(arena->cold, 0, size * sizeof(fluid_rvoice_cold_t));
+
+    fluid_memory_account(FLUID_MEMORY_VOICES, FLUID_RVOICE_ARENA_BYTES(size));
+
+    return arena;
+}
+
+/**
+ * Free an arena, together with all arenas chained to it and all rvoices
+ * handed out by them.
+ */
+void
+delete_fluid_rvoice_arena(fluid_rvoice_arena_t *arena)
+{
+    while(arena != NULL)
+    {
+        fluid_rvoice_arena_t *next = arena->next;
+
+        if(arena->hot_mem != NULL && arena->cold != NULL)
+        {
+            fluid_memory_account(FLUID_MEMORY_VOICES, -(ptrdiff_t)FLUID_RVOICE_ARENA_BYTES(arena->size));
+        }
+
+        FLUID_FREE(arena->hot_mem);
+        FLUID_FREE(arena->cold);
+        FLUID_FREE(arena);
+
+        arena = next;
+    }
+}
+
+/**
+ * Get the bytes allocated for an arena and all arenas chained to it.
+ */
+size_t
+fluid_rvoice_arena_get_memory(const fluid_rvoice_arena_t *arena)
+{
+    size_t bytes = 0;
+
+    for(; arena != NULL; arena = arena->next)
+    {
+        bytes += FLUID_RVOICE_ARENA_BYTES(arena->size);
+    }
+
+    return bytes;
+}
+
+/**
+ * Hand out the next free rvoice of an arena, with its cold part attached.
+ * NOTE: Not hard real-time capable, if the arena has to grow.
+ * @return the rvoice, or NULL on out of memory
+ */
+fluid_rvoice_t *
+fluid_rvoice_arena_alloc(fluid_rvoice_arena_t *arena)
+{
+    fluid_rvoice_t *voice;
+
+    fluid_return_val_if_fail(arena != NULL, NULL);
+
+    while(arena->count >= arena->size)
+    {
+        if(arena->next == NULL)
+        {
+            arena->next = new_fluid_rvoice_arena(arena->size);
+
+            if(arena->next == NULL)
+            {
+                return NULL;
+            }
+        }
+
+        arena = arena->next;
+    }
+
+    voice = &arena->hot[arena->count];
+    voice->cold = &arena->cold[arena->count];
+    arena->count++;
+
+    return voice;
+}
@@ -33,6 +33,10 @@ typedef struct _fluid_rvoice_envlfo_t fluid_rvoice_envlfo_t;
 typedef struct _fluid_rvoice_dsp_t fluid_rvoice_dsp_t;
 typedef struct _fluid_rvoice_buffers_t fluid_rvoice_buffers_t;
 typedef struct _fluid_rvoice_t fluid_rvoice_t;
+typedef struct _fluid_rvoice_cold_t fluid_rvoice_cold_t;
+typedef struct _fluid_rvoice_arena_t fluid_rvoice_arena_t;
+typedef struct _fluid_rvoice_control_t fluid_rvoice_control_t;
+typedef struct _fluid_sinc_table_t fluid_sinc_table_t;
 
 /* Smallest amplitude that can be perceived (full scale is +/- 0.5)
  * 16 bits => 96+4=100 dB dynamic range => 0.00001
@@ -85,6 +89,7 @@ struct _fluid_rvoice_dsp_t
 {
     /* interpolation method, as in fluid_interp in fluidsynth.h */
     enum fluid_interp interp_method;
+    const fluid_sinc_table_t *sinc_table; /* coefficients for FLUID_INTERP_SINC */
     enum fluid_loop samplemode;
 
     /* Flag that is set as soon as the first loop is completed. */
@@ -149,6 +154,24 @@ struct _fluid_rvoice_buffers_t
 };
 
 
+/*
+ * Hard real-time parameters of a voice that are only needed after its
+ * samples have been synthesized. They are kept apart from the state that
+ * the render loop streams through for every block (see fluid_rvoice_arena_t).
+ */
+struct _fluid_rvoice_cold_t
+{
+    fluid_iir_filter_t resonant_custom_filter; /* optional custom/general-purpose IIR resonant filter */
+    fluid_rvoice_buffers_t buffers;
+
+    /* cost accounting, collected per MIDI channel by the mixer */
+    int chan;                       /* MIDI channel the voice was started on */
+    int preset;                     /* bank << 7 | program of its preset, or -1 */
+    int started;                    /* TRUE until the first collection after the start */
+    uint64_t cycles;                /* render cycles since the last collection */
+    unsigned int samples;           /* samples rendered since the last collection */
+};
+
 /*
  * Hard real-time parameters needed to synthesize a voice
  */
@@ -157,12 +180,72 @@ struct _fluid_rvoice_t
     fluid_rvoice_envlfo_t envlfo;
     fluid_rvoice_dsp_t dsp;
     fluid_iir_filter_t resonant_filter; /* IIR resonant dsp filter */
-    fluid_iir_filter_t resonant_custom_filter; /* optional custom/general-purpose IIR resonant filter */
-    fluid_rvoice_buffers_t buffers;
+    fluid_rvoice_cold_t *cold;          /* the rest, stored in the arena next to this rvoice */
+};
+
+/*
+ * Storage for all rvoices of a synth. The hot parts (fluid_rvoice_t) live in
+ * one contiguous, cache line aligned array, the cold parts in another one,
+ * both indexed by the same slot. Voices are never returned individually, the
+ * whole arena is freed with the synth. If more rvoices are needed than were
+ * reserved, another arena of the same size is chained to it.
+ */
+struct _fluid_rvoice_arena_t
+{
+    int size;                       /* number of slots */
+    int count;                      /* number of slots handed out */
+    void *hot_mem;                  /* unaligned allocation of hot */
+    fluid_rvoice_t *hot;
+    fluid_rvoice_cold_t *cold;
+    fluid_rvoice_arena_t *next;     /* overflow arena, or NULL */
+};
+
+fluid_rvoice_arena_t *new_fluid_rvoice_arena(int size);
+void delete_fluid_rvoice_arena(fluid_rvoice_arena_t *arena);
+fluid_rvoice_t *fluid_rvoice_arena_alloc(fluid_rvoice_arena_t *arena);
+size_t fluid_rvoice_arena_get_memory(const fluid_rvoice_arena_t *arena);
+
+
+/*
+ * Scratch space for updating the control-rate parameters of a batch of
+ * voices in structure-of-arrays layout, see fluid_rvoice_control_multi().
+ * Envelope and LFO arrays hold 2 * size entries: volenv and modlfo of all
+ * voices first, then modenv and viblfo.
+ */
+struct _fluid_rvoice_control_t
+{
+    int size;                       /* number of voices there is room for */
+    int *status;                    /* -1: voice is quiet, 0: finished, 1: render it */
+    fluid_real_t *modenv_val;       /* modulation envelope value to render with */
+
+    fluid_real_t *pitch;            /* pitch in cents, including modulation */
+    fluid_real_t *modlfo_to_pitch;
+    fluid_real_t *viblfo_to_pitch;
+    fluid_real_t *modenv_to_pitch;
+
+    fluid_real_t *env_val;
+    fluid_real_t *env_coeff;
+    fluid_real_t *env_incr;
+    fluid_real_t *env_min;
+    fluid_real_t *env_max;
+    int *env_clamped;
+
+    fluid_real_t *lfo_val;
+    fluid_real_t *lfo_incr;
+    int *lfo_on;                    /* Flag: the LFO is past its delay */
 };
 
 
 int fluid_rvoice_write(fluid_rvoice_t *voice, fluid_real_t *dsp_buf);
+int fluid_rvoice_write_dsp(fluid_rvoice_t *voice, fluid_real_t *dsp_buf,
+                           fluid_real_t modenv_val);
+void fluid_rvoice_filter_custom(fluid_rvoice_t *voice, fluid_real_t *dsp_buf, int count);
+
+int fluid_rvoice_control_resize(fluid_rvoice_control_t *ctrl, int size);
+void fluid_rvoice_control_free(fluid_rvoice_control_t *ctrl);
+size_t fluid_rvoice_control_get_memory(const fluid_rvoice_control_t *ctrl);
+void fluid_rvoice_control_multi(fluid_rvoice_t **voices, int voice_count,
+                                fluid_rvoice_control_t *ctrl);
 
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_buffers_set_amp);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_buffers_set_mapping);
@@ -191,13 +274,18 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_set_loopstart);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_set_loopend);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_set_samplemode);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_set_sample);
+DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_set_owner);
 
 /* defined in fluid_rvoice_dsp.c */
 void fluid_rvoice_dsp_config(void);
+int fluid_rvoice_dsp_copy_unity(fluid_rvoice_dsp_t *voice, fluid_real_t *FLUID_RESTRICT dsp_buf, int is_looping);
 int fluid_rvoice_dsp_interpolate_none(fluid_rvoice_dsp_t *voice, fluid_real_t *FLUID_RESTRICT dsp_buf, int is_looping);
 int fluid_rvoice_dsp_interpolate_linear(fluid_rvoice_dsp_t *voice, fluid_real_t *FLUID_RESTRICT dsp_buf, int is_looping);
 int fluid_rvoice_dsp_interpolate_4th_order(fluid_rvoice_dsp_t *voice, fluid_real_t *FLUID_RESTRICT dsp_buf, int is_looping);
 int fluid_rvoice_dsp_interpolate_7th_order(fluid_rvoice_dsp_t *voice, fluid_real_t *FLUID_RESTRICT dsp_buf, int is_looping);
+int fluid_rvoice_dsp_interpolate_sinc(fluid_rvoice_dsp_t *voice, fluid_real_t *FLUID_RESTRICT dsp_buf, int is_looping);
+fluid_sinc_table_t *new_fluid_sinc_table(int taps);
+void delete_fluid_sinc_table(fluid_sinc_table_t *table);
 
 
 /*
@@ -116,6 +116,89 @@ fluid_rvoice_dsp_interpolate_none(fluid_rvoice_dsp_t *voice, fluid_real_t *FLUID
     return (dsp_i);
 }
 
+/* Unity rate playback. The sample is played at its own rate, starting on
+ * a sample point (phase increment of exactly 1 and no fractional phase),
+ * so every interpolator would return the sample points unchanged. Just
+ * convert and scale them, in runs that don't cross a loop boundary.
+ * Returns number of samples processed (usually FLUID_BUFSIZE but could be
+ * smaller if end of sample occurs).
+ */
+int
+fluid_rvoice_dsp_copy_unity(fluid_rvoice_dsp_t *voice, fluid_real_t *FLUID_RESTRICT dsp_buf, int looping)
+{
+    const short int *dsp_data = voice->sample->data;
+    const char *dsp_data24 = voice->sample->data24;
+    fluid_real_t dsp_amp = voice->amp;
+    fluid_real_t dsp_amp_incr = voice->amp_incr;
+    unsigned int dsp_i = 0;
+    unsigned int dsp_phase_index = fluid_phase_index(voice->phase);
+    unsigned int end_index;
+
+    end_index = looping ? voice->loopend - 1 : voice->end;
+
+    while(1)
+    {
+        unsigned int i, run = 0;
+
+        if(dsp_phase_index <= end_index)
+        {
+            run = end_index - dsp_phase_index + 1;
+
+            if(run > FLUID_BUFSIZE - dsp_i)
+            {
+                run = FLUID_BUFSIZE - dsp_i;
+            }
+        }
+
+        if(FLUID_LIKELY(dsp_data24 == NULL))
+        {
+            const short int *FLUID_RESTRICT src = &dsp_data[dsp_phase_index];
+
+            for(i = 0; i < run; i++)
+            {
+                /* same scale as fluid_rvoice_get_sample(), 16 bit => 24 bit */
+                dsp_buf[dsp_i + i] = (dsp_amp + i * dsp_amp_incr) * (fluid_real_t)(src[i] * 256);
+            }
+        }
+        else
+        {
+            for(i = 0; i < run; i++)
+            {
+                dsp_buf[dsp_i + i] = (dsp_amp + i * dsp_amp_incr)
+                                     * fluid_rvoice_get_float_sample(dsp_data, dsp_data24, dsp_phase_index + i);
+            }
+        }
+
+        dsp_i += run;
+        dsp_phase_index += run;
+        dsp_amp += run * dsp_amp_incr;
+
+        /* break out if not looping (buffer may not be full) */
+        if(!looping)
+        {
+            break;
+        }
+
+        /* go back to loop start */
+        if(dsp_phase_index > end_index)
+        {
+            dsp_phase_index -= voice->loopend - voice->loopstart;
+            voice->has_looped = 1;
+        }
+
+        /* break out if filled buffer */
+        if(dsp_i >= FLUID_BUFSIZE)
+        {
+            break;
+        }
+    }
+
+    fluid_phase_set_int(voice->phase, dsp_phase_index);
+    voice->amp = dsp_amp;
+
+    return (dsp_i);
+}
+
 /* Straight line interpolation.
  * Returns number of samples processed (usually FLUID_BUFSIZE but could be
  * smaller if end of sample occurs).
@@ -634,3 +717,333 @@ fluid_rvoice_dsp_interpolate_7th_order(fluid_rvoice_dsp_t *voice, fluid_real_t *
 
     return (dsp_i);
 }
+
+/* Polyphase windowed sinc interpolation.
+ *
+ * The table holds one set of taps coefficients for each of
+ * FLUID_SINC_PHASES + 1 fractional positions between two sample points (the
+ * last one equals the first, shifted by one point). The fractional phase is
+ * rounded to the nearest row. Each set is a sinc function windowed with a
+ * Blackman-Harris window spanning all taps, normalized to a DC gain of 1.
+ *
+ * Those rows cut off at the Nyquist frequency of the sample, which only holds
+ * as long as the sample is not played faster than its own rate. For upward
+ * shifts the cutoff is lowered by 1/phase_incr, stretching the kernel over
+ * taps * phase_incr sample points: those are weighted from the kernel itself,
+ * which the table also holds at FLUID_SINC_PHASES points per sample.
+ * The stretch is limited to FLUID_SINC_MAX_STRETCH to bound the cost of very
+ * high notes, above that the cutoff stays at 1/FLUID_SINC_MAX_STRETCH.
+ */
+#define FLUID_SINC_PHASE_BITS 10
+#define FLUID_SINC_PHASES (1 << FLUID_SINC_PHASE_BITS)
+#define FLUID_SINC_MAX_STRETCH 8
+
+struct _fluid_sinc_table_t
+{
+    int taps;
+    fluid_real_t *coeffs;   /* (FLUID_SINC_PHASES + 1) rows of taps coefficients */
+    fluid_real_t *kernel;   /* windowed sinc from 0 to taps / 2 points, not normalized */
+};
+
+/**
+ * Create the coefficient table for windowed sinc interpolation.
+ * NOTE: Not hard real-time capable.
+ *
+ * @param taps number of sample points used per output sample, rounded up to
+ * an even number
+ * @return the table or NULL if out of memory
+ */
+fluid_sinc_table_t *
+new_fluid_sinc_table(int taps)
+{
+    fluid_sinc_table_t *table;
+    int row, k, half;
+
+    fluid_return_val_if_fail(taps > 0, NULL);
+
+    taps += taps & 1;
+    half = taps / 2;
+
+    table = FLUID_NEW(fluid_sinc_table_t);
+
+    if(table == NULL)
+    {
+        FLUID_LOG(FLUID_ERR, "Out of memory");
+        return NULL;
+    }
+
+    table->taps = taps;
+    table->coeffs = FLUID_ARRAY(fluid_real_t, (FLUID_SINC_PHASES + 1) * taps);
+    table->kernel = FLUID_ARRAY(fluid_real_t, half * FLUID_SINC_PHASES + 1);
+
+    if(table->coeffs == NULL || table->kernel == NULL)
+    {
+        FLUID_LOG(FLUID_ERR, "Out of memory");
+        FLUID_FREE(table->coeffs);
+        FLUID_FREE(table->kernel);
+        FLUID_FREE(table);
+        return NULL;
+    }
+
+    for(row = 0; row <= FLUID_SINC_PHASES; row++)
+    {
+        fluid_real_t *coeffs = &table->coeffs[row * taps];
+        double fract = (double)row / FLUID_SINC_PHASES;
+        double sum = 0;
+
+        /* tap k weights sample point (index - half + 1 + k) */
+        for(k = 0; k < taps; k++)
+        {
+            double t = k - (half - 1) - fract;
+            double x = M_PI * t / half;
+
+            if(t == 0)
+            {
+                coeffs[k] = 1;
+            }
+            else if(row == 0 || row == FLUID_SINC_PHASES)
+            {
+                /* keep integer positions exact, sin() won't return 0 here */
+                coeffs[k] = 0;
+            }
+            else
+            {
+                coeffs[k] = (fluid_real_t)(sin(M_PI * t) / (M_PI * t)
+                                           * (0.35875 + 0.48829 * cos(x) + 0.14128 * cos(2 * x) + 0.01168 * cos(3 * x)));
+            }
+
+            sum += coeffs[k];
+        }
+
+        for(k = 0; k < taps; k++)
+        {
+            coeffs[k] = (fluid_real_t)(coeffs[k] / sum);
+        }
+    }
+
+    /* the same kernel (it is symmetric) for the stretched interpolation */
+    table->kernel[0] = 1;
+
+    for(k = 1; k <= half * FLUID_SINC_PHASES; k++)
+    {
+        double t = (double)k / FLUID_SINC_PHASES;
+        double x = M_PI * t / half;
+
+        table->kernel[k] = (fluid_real_t)(sin(M_PI * t) / (M_PI * t)
+                                          * (0.35875 + 0.48829 * cos(x) + 0.14128 * cos(2 * x) + 0.01168 * cos(3 * x)));
+    }
+
+    return table;
+}
+
+void
+delete_fluid_sinc_table(fluid_sinc_table_t *table)
+{
+    fluid_return_if_fail(table != NULL);
+
+    FLUID_FREE(table->coeffs);
+    FLUID_FREE(table->kernel);
+    FLUID_FREE(table);
+}
+
+/* Get a sample point for the sinc interpolation by its virtual index, which
+ * may lie outside of the sample or loop. Like in the other interpolators,
+ * points before the start are duplicated from the start, points after the
+ * end from the end, and loops wrap around. */
+static FLUID_INLINE fluid_real_t
+fluid_rvoice_dsp_sinc_point(const fluid_rvoice_dsp_t *voice, int idx, int looping)
+{
+    int loop_frames = voice->loopend - voice->loopstart;
+
+    if(looping && idx >= voice->loopend)
+    {
+        idx = voice->loopstart + (idx - voice->loopstart) % loop_frames;
+    }
+    else if(!looping && idx > voice->end)
+    {
+        idx = voice->end;
+    }
+
+    if(voice->has_looped && idx < voice->loopstart)
+    {
+        idx = voice->loopend - 1 - (voice->loopstart - 1 - idx) % loop_frames;
+    }
+    else if(idx < voice->start)
+    {
+        idx = voice->start;
+    }
+
+    return fluid_rvoice_get_float_sample(voice->sample->data, voice->sample->data24, idx);
+}
+
+/* Interpolate one output sample at fract past sample point index with the
+ * kernel stretched by stretch > 1, i.e. with the cutoff lowered to 1/stretch
+ * of the Nyquist frequency of the sample. The weights are renormalized to a
+ * DC gain of 1, like the rows of the table. */
+static FLUID_INLINE fluid_real_t
+fluid_rvoice_dsp_sinc_stretched(const fluid_rvoice_dsp_t *voice, const fluid_sinc_table_t *table,
+                                unsigned int index, double fract, double stretch,
+                                unsigned int start_index, unsigned int end_index, int looping)
+{
+    const double span = (table->taps / 2) * stretch;
+    const double step = FLUID_SINC_PHASES / stretch;
+    const int first = (int)ceil(fract - span);
+    const int last = (int)floor(fract + span);
+    double pos = (first - fract) * step;
+    fluid_real_t sum = 0, weights = 0;
+    int m;
+
+    if(voice->sample->data24 == NULL && (int)index + first >= (int)start_index
+            && index + last <= end_index)
+    {
+        /* all points within the sample or loop, no wrap around needed */
+        const short int *FLUID_RESTRICT src = &voice->sample->data[index];
+
+        for(m = first; m <= last; m++, pos += step)
+        {
+            fluid_real_t w = table->kernel[(int)(fabs(pos) + 0.5)];
+
+            sum += w * src[m];
+            weights += w;
+        }
+
+        /* same scale as fluid_rvoice_get_sample(), 16 bit => 24 bit */
+        return sum * 256 / weights;
+    }
+
+    for(m = first; m <= last; m++, pos += step)
+    {
+        fluid_real_t w = table->kernel[(int)(fabs(pos) + 0.5)];
+
+        sum += w * fluid_rvoice_dsp_sinc_point(voice, (int)index + m, looping);
+        weights += w;
+    }
+
+    return sum / weights;
+}
+
+/* Windowed sinc interpolation, using the table set up for the voice by
+ * fluid_rvoice_set_interp_method(), or 7th order interpolation if there is none.
+ * The kernel is stretched for upward shifts, see fluid_sinc_table_t.
+ * Returns number of samples processed (usually FLUID_BUFSIZE but could be
+ * smaller if end of sample occurs).
+ */
+int
+fluid_rvoice_dsp_interpolate_sinc(fluid_rvoice_dsp_t *voice, fluid_real_t *FLUID_RESTRICT dsp_buf, int looping)
+{
+    const fluid_sinc_table_t *table = voice->sinc_table;
+    fluid_phase_t dsp_phase = voice->phase;
+    fluid_phase_t dsp_phase_incr;
+    const short int *dsp_data = voice->sample->data;
+    const char *dsp_data24 = voice->sample->data24;
+    fluid_real_t dsp_amp = voice->amp;
+    fluid_real_t dsp_amp_incr = voice->amp_incr;
+    unsigned int dsp_i = 0;
+    unsigned int dsp_phase_index;
+    unsigned int end_index;
+    double stretch;
+    int taps, half, k;
+
+    if(table == NULL)
+    {
+        return fluid_rvoice_dsp_interpolate_7th_order(voice, dsp_buf, looping);
+    }
+
+    taps = table->taps;
+    half = taps / 2;
+
+    /* Convert playback "speed" floating point value to phase index/fract */
+    fluid_phase_set_float(dsp_phase_incr, voice->phase_incr);
+
+    end_index = looping ? voice->loopend - 1 : voice->end;
+
+    stretch = voice->phase_incr < FLUID_SINC_MAX_STRETCH ? voice->phase_incr : FLUID_SINC_MAX_STRETCH;
+
+    while(dsp_i < FLUID_BUFSIZE)
+    {
+        const fluid_real_t *FLUID_RESTRICT coeffs;
+        unsigned int row, start_index;
+        int first_index;
+        fluid_real_t sum = 0;
+
+        dsp_phase_index = fluid_phase_index(dsp_phase);
+
+        if(dsp_phase_index > end_index)
+        {
+            /* break out if not looping (end of sample) */
+            if(!looping)
+            {
+                break;
+            }
+
+            /* go back to loop start */
+            fluid_phase_sub_int(dsp_phase, voice->loopend - voice->loopstart);
+            voice->has_looped = 1;
+            continue;
+        }
+
+        start_index = voice->has_looped ? voice->loopstart : voice->start;
+
+        if(stretch > 1)
+        {
+            sum = fluid_rvoice_dsp_sinc_stretched(voice, table, dsp_phase_index,
+                                                  fluid_phase_fract(dsp_phase) / FLUID_FRACT_MAX, stretch,
+                                                  start_index, end_index, looping);
+            dsp_buf[dsp_i++] = dsp_amp * sum;
+
+            fluid_phase_incr(dsp_phase, dsp_phase_incr);
+            dsp_amp += dsp_amp_incr;
+            continue;
+        }
+
+        /* round to the nearest row, the last row is the next sample point */
+        row = (unsigned int)(((uint64_t)fluid_phase_fract(dsp_phase) + (1U << (31 - FLUID_SINC_PHASE_BITS)))
+                             >> (32 - FLUID_SINC_PHASE_BITS));
+        coeffs = &table->coeffs[row * taps];
+
+        first_index = (int)dsp_phase_index - (half - 1);
+
+        if(FLUID_LIKELY(dsp_data24 == NULL && dsp_phase_index >= start_index + (half - 1)
+                        && dsp_phase_index + half <= end_index))
+        {
+            /* all points within the sample or loop, no wrap around needed */
+            const short int *FLUID_RESTRICT src = &dsp_data[first_index];
+
+#ifdef _OPENMP
+            #pragma omp simd reduction(+:sum)
+#endif
+            for(k = 0; k < taps; k++)
+            {
+                sum += coeffs[k] * src[k];
+            }
+
+            /* same scale as fluid_rvoice_get_sample(), 16 bit => 24 bit */
+            sum *= 256;
+        }
+        else
+        {
+            for(k = 0; k < taps; k++)
+            {
+                sum += coeffs[k] * fluid_rvoice_dsp_sinc_point(voice, first_index + k, looping);
+            }
+        }
+
+        dsp_buf[dsp_i++] = dsp_amp * sum;
+
+        /* increment phase and amplitude */
+        fluid_phase_incr(dsp_phase, dsp_phase_incr);
+        dsp_amp += dsp_amp_incr;
+    }
+
+    /* go back to loop start if the loop end was hit by the last sample */
+    if(looping && fluid_phase_index(dsp_phase) > end_index)
+    {
+        fluid_phase_sub_int(dsp_phase, voice->loopend - voice->loopstart);
+        voice->has_looped = 1;
+    }
+
+    voice->phase = dsp_phase;
+    voice->amp = dsp_amp;
+
+    return (dsp_i);
+}
@@ -169,24 +169,46 @@ fluid_rvoice_eventhandler_dispatch_count(fluid_rvoice_eventhandler_t *handler)
 /**
  * Call fluid_rvoice_event_dispatch for all events in queue
  * @return number of events dispatched
+ *
+ * Events are popped in batches of all those queued so far, so that the
+ * producer's index is read and the consumer's one written once per batch.
  */
 int
 fluid_rvoice_eventhandler_dispatch_all(fluid_rvoice_eventhandler_t *handler)
 {
-    fluid_rvoice_event_t *event;
     int result = 0;
+    int count;
 
-    while(NULL != (event = fluid_ringbuffer_get_outptr(handler->queue)))
+    while(0 != (count = fluid_ringbuffer_get_outcount(handler->queue)))
     {
-        fluid_rvoice_event_dispatch(event);
-        result++;
-        fluid_ringbuffer_next_outptr(handler->queue);
+        int i;
+
+        for(i = 0; i < count; i++)
+        {
+            fluid_rvoice_event_dispatch(fluid_ringbuffer_get_outptr_at(handler->queue, i));
+        }
+
+        result += count;
+        fluid_ringbuffer_next_outptrs(handler->queue, count);
     }
 
     return result;
 }
 
 
+/**
+ * Add the memory used by the event queues and the mixer to stats.
+ */
+void
+fluid_rvoice_eventhandler_get_memory(fluid_rvoice_eventhandler_t *handler,
+                                     fluid_memory_stats_t *stats)
+{
+    stats->bytes[FLUID_MEMORY_EVENTS] += fluid_ringbuffer_get_memory(handler->queue)
+                                         + fluid_ringbuffer_get_memory(handler->finished_voices);
+    fluid_rvoice_mixer_get_memory(handler->mixer, stats);
+}
+
+
 void
 delete_fluid_rvoice_eventhandler(fluid_rvoice_eventhandler_t *handler)
 {
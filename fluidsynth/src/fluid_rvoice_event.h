@@ -58,6 +58,8 @@ int fluid_rvoice_eventhandler_dispatch_all(fluid_rvoice_eventhandler_t *);
 int fluid_rvoice_eventhandler_dispatch_count(fluid_rvoice_eventhandler_t *);
 void fluid_rvoice_eventhandler_finished_voice_callback(fluid_rvoice_eventhandler_t *eventhandler,
         fluid_rvoice_t *rvoice);
+void fluid_rvoice_eventhandler_get_memory(fluid_rvoice_eventhandler_t *handler,
+        fluid_memory_stats_t *stats);
 
 static FLUID_INLINE void
 fluid_rvoice_eventhandler_flush(fluid_rvoice_eventhandler_t *handler)
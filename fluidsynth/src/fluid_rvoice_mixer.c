@@ -43,6 +43,9 @@ struct _fluid_mixer_buffers_t
     fluid_rvoice_t **finished_voices; /* List of voices who have finished */
     int finished_voice_count;
 
+    fluid_rvoice_t **live_voices; /* Voices still playing in the current render call */
+    fluid_rvoice_control_t control; /* Control-rate scratch space for all voices */
+
     fluid_real_t *local_buf;
 
     int buf_count;
@@ -69,6 +72,9 @@ struct _fluid_mixer_buffers_t
      */
     fluid_real_t *fx_left_buf;
     fluid_real_t *fx_right_buf;
+
+    size_t bytes;        /**< Bytes allocated for the buffers above, see fluid_mixer_buffers_account() */
+    size_t voice_bytes;  /**< Part of bytes sized by the polyphony */
 };
 
 typedef struct _fluid_mixer_fx_t fluid_mixer_fx_t;
@@ -95,6 +101,14 @@ struct _fluid_rvoice_mixer_t
     int with_chorus;        /**< Should the synth use the built-in chorus unit? */
     int mix_fx_to_out;      /**< Should the effects be mixed in with the primary output? */
 
+    fluid_stage_stats_t stage_stats[FLUID_SYNTH_STAGE_LAST]; /**< Used by the rendering thread only */
+
+    int cost_accounting;    /**< Should the voices account their rendering cost? */
+    fluid_channel_cost_t *channel_costs; /**< Used by the rendering thread only: cost per MIDI channel */
+    int channel_count;      /**< Length of channel_costs */
+
+    fluid_trace_t *trace;   /**< Trace of the rendering thread or NULL, only changed while not rendering */
+
 #ifdef LADSPA
     fluid_ladspa_fx_t *ladspa_fx; /**< Used by mixer only: Effects unit for LADSPA support. Never created or freed */
 #endif
@@ -134,6 +148,8 @@ fluid_rvoice_mixer_process_fx(fluid_rvoice_mixer_t *mixer, int current_blockcoun
     fluid_real_t *in_rev = fluid_align_ptr(mixer->buffers.fx_left_buf, FLUID_DEFAULT_ALIGNMENT);
     fluid_real_t *in_ch = in_rev;
 
+    uint64_t start;
+
     fluid_profile_ref_var(prof_ref);
 
 
@@ -160,6 +176,8 @@ fluid_rvoice_mixer_process_fx(fluid_rvoice_mixer_t *mixer, int current_blockcoun
 
     if(mixer->with_reverb)
     {
+        start = fluid_cycles();
+
         for(f = 0; f < mixer->fx_units; f++)
         {
             int buf_idx = f * fx_channels_per_unit + SYNTH_REVERB_CHANNEL;
@@ -175,12 +193,15 @@ fluid_rvoice_mixer_process_fx(fluid_rvoice_mixer_t *mixer, int current_blockcoun
             }
         }
 
+        fluid_rvoice_mixer_stage_done(mixer, FLUID_SYNTH_STAGE_REVERB, start);
         fluid_profile(FLUID_PROF_ONE_BLOCK_REVERB, prof_ref, 0,
                       current_blockcount * FLUID_BUFSIZE);
     }
 
     if(mixer->with_chorus)
     {
+        start = fluid_cycles();
+
         for(f = 0; f < mixer->fx_units; f++)
         {
             int buf_idx = f * fx_channels_per_unit + SYNTH_CHORUS_CHANNEL;
@@ -196,6 +217,7 @@ fluid_rvoice_mixer_process_fx(fluid_rvoice_mixer_t *mixer, int current_blockcoun
             }
         }
 
+        fluid_rvoice_mixer_stage_done(mixer, FLUID_SYNTH_STAGE_CHORUS, start);
         fluid_profile(FLUID_PROF_ONE_BLOCK_CHORUS, prof_ref, 0,
                       current_blockcount * FLUID_BUFSIZE);
     }
@@ -323,6 +345,8 @@ fluid_mixer_buffer_process_finished_voices(fluid_mixer_buffers_t *buffers)
 
         buffers->mixer->active_voices = av;
 
+        fluid_trace_mark(buffers->mixer->trace, FLUID_TRACE_VOICE_STOP, v->cold->chan, 0);
+
         fluid_rvoice_eventhandler_finished_voice_callback(buffers->mixer->eventhandler, v);
     }
 
@@ -368,7 +392,7 @@ get_dest_buf(fluid_rvoice_buffers_t *buffers, int index,
  * @param dest_bufs Array of buffers to mixdown to
  * @param dest_bufcount Length of dest_bufs (i.e count of buffers)
  */
-static void
+void
 fluid_rvoice_buffers_mix(fluid_rvoice_buffers_t *buffers,
                          const fluid_real_t *FLUID_RESTRICT dsp_buf,
                          int start_block, int sample_count,
@@ -426,6 +450,7 @@ fluid_mixer_buffers_render_one(fluid_mixer_buffers_t *buffers,
                                unsigned int dest_bufcount, fluid_real_t *src_buf, int blockcount)
 {
     int i, total_samples = 0, last_block_mixed = 0;
+    uint64_t start = buffers->mixer->cost_accounting ? fluid_cycles() : 0;
 
     for(i = 0; i < blockcount; i++)
     {
@@ -434,7 +459,7 @@ fluid_mixer_buffers_render_one(fluid_mixer_buffers_t *buffers,
         if(s == -1)
         {
             /* the voice is silent, mix back all the previously rendered sound */
-            fluid_rvoice_buffers_mix(&rvoice->buffers, src_buf, last_block_mixed,
+            fluid_rvoice_buffers_mix(&rvoice->cold->buffers, src_buf, last_block_mixed,
                                      total_samples - (last_block_mixed*FLUID_BUFSIZE),
                                      dest_bufs, dest_bufcount);
 
@@ -454,10 +479,16 @@ fluid_mixer_buffers_render_one(fluid_mixer_buffers_t *buffers,
     }
 
     /* Now mix the remaining blocks from last_block_mixed to total_sample */
-    fluid_rvoice_buffers_mix(&rvoice->buffers, src_buf, last_block_mixed,
+    fluid_rvoice_buffers_mix(&rvoice->cold->buffers, src_buf, last_block_mixed,
                              total_samples - (last_block_mixed*FLUID_BUFSIZE),
                              dest_bufs, dest_bufcount);
 
+    if(buffers->mixer->cost_accounting)
+    {
+        rvoice->cold->cycles += fluid_cycles() - start;
+        rvoice->cold->samples += total_samples;
+    }
+
     if(total_samples < blockcount * FLUID_BUFSIZE)
     {
         /* voice has finished */
@@ -465,6 +496,121 @@ fluid_mixer_buffers_render_one(fluid_mixer_buffers_t *buffers,
     }
 }
 
+/**
+ * Synthesize one block of up to FLUID_IIR_FILTER_LANES voices and add them
+ * to buffer. The control-rate parameters of the voices must have been
+ * updated by fluid_rvoice_control_multi() before, status and modenv_val are
+ * the results of that. The full blocks of all voices go through the resonant
+ * filters together in one pass of fluid_iir_filter_apply_multi().
+ * src_buf must provide FLUID_IIR_FILTER_LANES local buffers.
+ * With cost accounting, the cycles of the joint filter pass are split
+ * evenly among the voices that took part in it.
+ * NOTE: Voices that have finished are removed and get a status of 0.
+ */
+static FLUID_INLINE void
+fluid_mixer_buffers_render_block(fluid_mixer_buffers_t *buffers,
+                                 fluid_rvoice_t **rvoices, int *status,
+                                 const fluid_real_t *modenv_val, int voice_count,
+                                 fluid_real_t **dest_bufs, unsigned int dest_bufcount,
+                                 fluid_real_t *src_buf, int block)
+{
+    static const int samplecount = FLUID_BUFSIZE * FLUID_MIXER_MAX_BUFFERS_DEFAULT;
+
+    fluid_iir_filter_t *filters[FLUID_IIR_FILTER_LANES];
+    fluid_real_t *filter_bufs[FLUID_IIR_FILTER_LANES];
+    int filter_count = 0;
+    const int accounting = buffers->mixer->cost_accounting;
+    uint64_t start, voice_start = 0;
+    int v;
+
+    for(v = 0; v < voice_count; v++)
+    {
+        fluid_real_t *buf = &src_buf[v * samplecount + FLUID_BUFSIZE * block];
+
+        if(status[v] <= 0)
+        {
+            continue;
+        }
+
+        if(accounting)
+        {
+            voice_start = fluid_cycles();
+        }
+
+        status[v] = fluid_rvoice_write_dsp(rvoices[v], buf, modenv_val[v]);
+
+        if(status[v] == FLUID_BUFSIZE)
+        {
+            filters[filter_count] = &rvoices[v]->resonant_filter;
+            filter_bufs[filter_count] = buf;
+            filter_count++;
+        }
+        else if(status[v] > 0)
+        {
+            /* the last, partial block of a finishing voice */
+            fluid_iir_filter_apply(&rvoices[v]->resonant_filter, buf, status[v]);
+        }
+
+        if(accounting)
+        {
+            rvoices[v]->cold->cycles += fluid_cycles() - voice_start;
+        }
+    }
+
+    start = fluid_cycles();
+    fluid_iir_filter_apply_multi(filters, filter_bufs, filter_count);
+    fluid_stage_stats_add(&buffers->mixer->stage_stats[FLUID_SYNTH_STAGE_FILTER], start);
+
+    if(accounting && filter_count > 0)
+    {
+        uint64_t share = (fluid_cycles() - start) / filter_count;
+
+        for(v = 0; v < voice_count; v++)
+        {
+            if(status[v] == FLUID_BUFSIZE)
+            {
+                rvoices[v]->cold->cycles += share;
+            }
+        }
+    }
+
+    for(v = 0; v < voice_count; v++)
+    {
+        fluid_real_t *voice_buf = &src_buf[v * samplecount];
+
+        if(status[v] == -1)
+        {
+            /* the voice is silent */
+            continue;
+        }
+
+        if(status[v] > 0)
+        {
+            if(accounting)
+            {
+                voice_start = fluid_cycles();
+            }
+
+            fluid_rvoice_filter_custom(rvoices[v], &voice_buf[FLUID_BUFSIZE * block], status[v]);
+            fluid_rvoice_buffers_mix(&rvoices[v]->cold->buffers, voice_buf, block, status[v],
+                                     dest_bufs, dest_bufcount);
+
+            if(accounting)
+            {
+                rvoices[v]->cold->cycles += fluid_cycles() - voice_start;
+                rvoices[v]->cold->samples += status[v];
+            }
+        }
+
+        if(status[v] < FLUID_BUFSIZE)
+        {
+            /* voice has finished */
+            fluid_finish_rvoice(buffers, rvoices[v]);
+            status[v] = 0;
+        }
+    }
+}
+
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_add_voice)
 {
     int i;
@@ -500,10 +646,19 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_add_voice)
     return;
 }
 
+/* Accounts bytes allocated (or freed if negative) for mixer buffers */
+static void
+fluid_mixer_buffers_account(fluid_mixer_buffers_t *buffers, ptrdiff_t bytes)
+{
+    buffers->bytes += bytes;
+    fluid_memory_account(FLUID_MEMORY_MIXER, bytes);
+}
+
 static int
 fluid_mixer_buffers_update_polyphony(fluid_mixer_buffers_t *buffers, int value)
 {
     void *newptr;
+    size_t voice_bytes;
 
     if(buffers->finished_voice_count > value)
     {
@@ -518,6 +673,25 @@ fluid_mixer_buffers_update_polyphony(fluid_mixer_buffers_t *buffers, int value)
     }
 
     buffers->finished_voices = newptr;
+
+    newptr = FLUID_REALLOC(buffers->live_voices, value * sizeof(fluid_rvoice_t *));
+
+    if(newptr == NULL && value > 0)
+    {
+        return FLUID_FAILED;
+    }
+
+    buffers->live_voices = newptr;
+
+    if(fluid_rvoice_control_resize(&buffers->control, value) == FLUID_FAILED)
+    {
+        return FLUID_FAILED;
+    }
+
+    voice_bytes = 2 * value * sizeof(fluid_rvoice_t *) + fluid_rvoice_control_get_memory(&buffers->control);
+    fluid_mixer_buffers_account(buffers, (ptrdiff_t)voice_bytes - (ptrdiff_t)buffers->voice_bytes);
+    buffers->voice_bytes = voice_bytes;
+
     return FLUID_OK;
 }
 
@@ -566,6 +740,7 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_polyphony)
     }
 #endif
 
+    fluid_memory_account(FLUID_MEMORY_MIXER, (value - handler->polyphony) * (ptrdiff_t)sizeof(fluid_rvoice_t *));
     handler->polyphony = value;
     return /*FLUID_OK*/;
 }
@@ -574,7 +749,12 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_polyphony)
 static void
 fluid_render_loop_singlethread(fluid_rvoice_mixer_t *mixer, int blockcount)
 {
-    int i;
+    int i, v;
+    fluid_mixer_buffers_t *buffers = &mixer->buffers;
+    fluid_rvoice_t **rvoices = buffers->live_voices;
+    int *status = buffers->control.status;
+    int voice_count = mixer->active_voices;
+
     FLUID_DECLARE_VLA(fluid_real_t *, bufs,
                       mixer->buffers.buf_count * 2 + mixer->buffers.fx_buf_count * 2);
     int bufcount = fluid_mixer_buffers_prepare(&mixer->buffers, bufs);
@@ -583,12 +763,42 @@ fluid_render_loop_singlethread(fluid_rvoice_mixer_t *mixer, int blockcount)
 
     fluid_profile_ref_var(prof_ref);
 
-    for(i = 0; i < mixer->active_voices; i++)
+    FLUID_MEMCPY(rvoices, mixer->rvoices, voice_count * sizeof(fluid_rvoice_t *));
+
+    /* All voices advance block by block: first the control-rate parameters
+     * of all of them are updated at once, then their audio is rendered. */
+    for(i = 0; i < blockcount && voice_count > 0; i++)
     {
-        fluid_mixer_buffers_render_one(&mixer->buffers, mixer->rvoices[i], bufs,
-                                       bufcount, local_buf, blockcount);
-        fluid_profile(FLUID_PROF_ONE_BLOCK_VOICE, prof_ref, 1,
-                      blockcount * FLUID_BUFSIZE);
+        int remaining = 0;
+
+        fluid_rvoice_control_multi(rvoices, voice_count, &buffers->control);
+
+        for(v = 0; v < voice_count; v += FLUID_IIR_FILTER_LANES)
+        {
+            int lanes = voice_count - v;
+
+            if(lanes > FLUID_IIR_FILTER_LANES)
+            {
+                lanes = FLUID_IIR_FILTER_LANES;
+            }
+
+            fluid_mixer_buffers_render_block(buffers, &rvoices[v], &status[v],
+                                             &buffers->control.modenv_val[v], lanes,
+                                             bufs, bufcount, local_buf, i);
+        }
+
+        fluid_profile(FLUID_PROF_ONE_BLOCK_VOICE, prof_ref, voice_count, FLUID_BUFSIZE);
+
+        /* drop the voices that have finished, keeping the order of the others */
+        for(v = 0; v < voice_count; v++)
+        {
+            if(status[v] != 0)
+            {
+                rvoices[remaining++] = rvoices[v];
+            }
+        }
+
+        voice_count = remaining;
     }
 }
 
@@ -628,8 +838,8 @@ fluid_mixer_buffers_init(fluid_mixer_buffers_t *buffers, fluid_rvoice_mixer_t *m
     buffers->buf_count = mixer->buffers.buf_count;
     buffers->fx_buf_count = mixer->buffers.fx_buf_count;
 
-    /* Local mono voice buf */
-    buffers->local_buf = FLUID_ARRAY_ALIGNED(fluid_real_t, samplecount, FLUID_DEFAULT_ALIGNMENT);
+    /* Local mono voice bufs, one per filter lane (see fluid_mixer_buffers_render_block()) */
+    buffers->local_buf = FLUID_ARRAY_ALIGNED(fluid_real_t, samplecount * FLUID_IIR_FILTER_LANES, FLUID_DEFAULT_ALIGNMENT);
 
     /* Left and right audio buffers */
 
@@ -653,7 +863,13 @@ fluid_mixer_buffers_init(fluid_mixer_buffers_t *buffers, fluid_rvoice_mixer_t *m
         return 0;
     }
 
+    fluid_mixer_buffers_account(buffers,
+                                (samplecount * (FLUID_IIR_FILTER_LANES + 2 * buffers->buf_count + 2 * buffers->fx_buf_count))
+                                * sizeof(fluid_real_t) + 5 * (FLUID_DEFAULT_ALIGNMENT - 1));
+
     buffers->finished_voices = NULL;
+    buffers->live_voices = NULL;
+    FLUID_MEMSET(&buffers->control, 0, sizeof(buffers->control));
 
     if(fluid_mixer_buffers_update_polyphony(buffers, mixer->polyphony)
             == FLUID_FAILED)
@@ -779,6 +995,8 @@ static void
 fluid_mixer_buffers_free(fluid_mixer_buffers_t *buffers)
 {
     FLUID_FREE(buffers->finished_voices);
+    FLUID_FREE(buffers->live_voices);
+    fluid_rvoice_control_free(&buffers->control);
 
     /* free all the sample buffers */
     FLUID_FREE(buffers->local_buf);
@@ -786,6 +1004,9 @@ fluid_mixer_buffers_free(fluid_mixer_buffers_t *buffers)
     FLUID_FREE(buffers->right_buf);
     FLUID_FREE(buffers->fx_left_buf);
     FLUID_FREE(buffers->fx_right_buf);
+
+    fluid_mixer_buffers_account(buffers, -(ptrdiff_t)buffers->bytes);
+    buffers->voice_bytes = 0;
 }
 
 void delete_fluid_rvoice_mixer(fluid_rvoice_mixer_t *mixer)
@@ -836,9 +1057,46 @@ void delete_fluid_rvoice_mixer(fluid_rvoice_mixer_t *mixer)
 
     FLUID_FREE(mixer->fx);
     FLUID_FREE(mixer->rvoices);
+    FLUID_FREE(mixer->channel_costs);
+    fluid_memory_account(FLUID_MEMORY_MIXER, -mixer->polyphony * (ptrdiff_t)sizeof(fluid_rvoice_t *));
     FLUID_FREE(mixer);
 }
 
+/**
+ * Add the memory used by the mixer to stats: its buffers, and the delay
+ * lines of its reverb and chorus units.
+ */
+void
+fluid_rvoice_mixer_get_memory(fluid_rvoice_mixer_t *mixer, fluid_memory_stats_t *stats)
+{
+    int i;
+
+    stats->bytes[FLUID_MEMORY_MIXER] += mixer->buffers.bytes
+                                        + mixer->polyphony * sizeof(fluid_rvoice_t *);
+
+#if ENABLE_MIXER_THREADS
+
+    for(i = 0; i < mixer->thread_count; i++)
+    {
+        stats->bytes[FLUID_MEMORY_MIXER] += mixer->threads[i].bytes;
+    }
+
+#endif
+
+    for(i = 0; i < mixer->fx_units; i++)
+    {
+        if(mixer->fx[i].reverb)
+        {
+            stats->bytes[FLUID_MEMORY_FX] += fluid_revmodel_get_memory(mixer->fx[i].reverb);
+        }
+
+        if(mixer->fx[i].chorus)
+        {
+            stats->bytes[FLUID_MEMORY_FX] += fluid_chorus_get_memory(mixer->fx[i].chorus);
+        }
+    }
+}
+
 
 #ifdef LADSPA
 /**
@@ -891,6 +1149,14 @@ DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_reverb_enabled)
     mixer->with_reverb = on;
 }
 
+DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_cost_accounting)
+{
+    fluid_rvoice_mixer_t *mixer = obj;
+    int on = param[0].i;
+
+    mixer->cost_accounting = on && mixer->channel_costs != NULL;
+}
+
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_chorus_enabled)
 {
     fluid_rvoice_mixer_t *mixer = obj;
@@ -977,6 +1243,84 @@ int fluid_rvoice_mixer_get_bufcount(fluid_rvoice_mixer_t *mixer)
     return FLUID_MIXER_MAX_BUFFERS_DEFAULT;
 }
 
+/**
+ * Allocate the per MIDI channel cost accounting.
+ * NOTE: Not real-time capable, must be called before rendering starts.
+ */
+int fluid_rvoice_mixer_alloc_channel_costs(fluid_rvoice_mixer_t *mixer, int channel_count)
+{
+    int i;
+
+    mixer->channel_costs = FLUID_ARRAY(fluid_channel_cost_t, channel_count);
+
+    if(mixer->channel_costs == NULL)
+    {
+        FLUID_LOG(FLUID_ERR, "Out of memory");
+        return FLUID_FAILED;
+    }
+
+    mixer->channel_count = channel_count;
+
+    for(i = 0; i < channel_count; i++)
+    {
+        fluid_rvoice_mixer_reset_channel_cost(&mixer->channel_costs[i]);
+    }
+
+    return FLUID_OK;
+}
+
+/**
+ * Clear the accounting of a MIDI channel, keeping its current voice count.
+ */
+void fluid_rvoice_mixer_reset_channel_cost(fluid_channel_cost_t *cost)
+{
+    cost->cycles = 0;
+    cost->samples = 0;
+    cost->share = 0;
+    cost->peak_voices = cost->voices;
+
+    if(cost->peak_voices == 0)
+    {
+        cost->bank = -1;
+        cost->program = -1;
+    }
+}
+
+/**
+ * Cost accounting per MIDI channel, see fluid_rvoice_mixer_set_cost_accounting().
+ * Must only be accessed by the rendering thread.
+ * @param channel_count set to the length of the returned array
+ */
+fluid_channel_cost_t *fluid_rvoice_mixer_get_channel_costs(fluid_rvoice_mixer_t *mixer, int *channel_count)
+{
+    *channel_count = mixer->channel_count;
+    return mixer->channel_costs;
+}
+
+/**
+ * Counters of the rendering stages, indexed by #fluid_synth_stage.
+ * Must only be accessed by the rendering thread.
+ */
+fluid_stage_stats_t *fluid_rvoice_mixer_get_stage_stats(fluid_rvoice_mixer_t *mixer)
+{
+    return mixer->stage_stats;
+}
+
+/* Accounts and traces a pass of a rendering stage that started at cycles 'start'.
+ * The per-voice filter passes are only accounted, they are too frequent to trace. */
+void fluid_rvoice_mixer_stage_done(fluid_rvoice_mixer_t *mixer, int stage, uint64_t start)
+{
+    uint64_t end = fluid_stage_stats_add(&mixer->stage_stats[stage], start);
+
+    fluid_trace_add(mixer->trace, FLUID_TRACE_STAGE, -1, stage, start, end);
+}
+
+/* Must not be called while rendering */
+void fluid_rvoice_mixer_set_trace(fluid_rvoice_mixer_t *mixer, fluid_trace_t *trace)
+{
+    mixer->trace = trace;
+}
+
 #if WITH_PROFILING
 int fluid_rvoice_mixer_get_active_voices(fluid_rvoice_mixer_t *mixer)
 {
@@ -1352,6 +1696,56 @@ static int fluid_rvoice_mixer_set_threads(fluid_rvoice_mixer_t *mixer, int threa
 }
 #endif
 
+/*
+ * Moves the rendering cost accumulated by the voices to the MIDI channels
+ * they were started on, and counts the voices of each channel. Must be
+ * called before finished voices are removed from the voices array.
+ */
+static void
+fluid_rvoice_mixer_collect_costs(fluid_rvoice_mixer_t *mixer)
+{
+    fluid_channel_cost_t *costs = mixer->channel_costs;
+    int i;
+
+    for(i = 0; i < mixer->channel_count; i++)
+    {
+        costs[i].voices = 0;
+    }
+
+    for(i = 0; i < mixer->active_voices; i++)
+    {
+        fluid_rvoice_cold_t *cold = mixer->rvoices[i]->cold;
+        fluid_channel_cost_t *cost;
+
+        if(cold->chan < 0 || cold->chan >= mixer->channel_count)
+        {
+            continue;
+        }
+
+        cost = &costs[cold->chan];
+        cost->cycles += cold->cycles;
+        cost->samples += cold->samples;
+        cost->voices++;
+        cold->cycles = 0;
+        cold->samples = 0;
+
+        if(cold->started)
+        {
+            cost->bank = cold->preset < 0 ? -1 : cold->preset >> 7;
+            cost->program = cold->preset < 0 ? -1 : cold->preset & 0x7f;
+            cold->started = FALSE;
+        }
+    }
+
+    for(i = 0; i < mixer->channel_count; i++)
+    {
+        if(costs[i].voices > costs[i].peak_voices)
+        {
+            costs[i].peak_voices = costs[i].voices;
+        }
+    }
+}
+
 /**
  * Synthesize audio into buffers
  * @param blockcount number of blocks to render, each having FLUID_BUFSIZE samples
@@ -1360,15 +1754,19 @@ static int fluid_rvoice_mixer_set_threads(fluid_rvoice_mixer_t *mixer, int threa
 int
 fluid_rvoice_mixer_render(fluid_rvoice_mixer_t *mixer, int blockcount)
 {
+    uint64_t start = fluid_cycles();
     fluid_profile_ref_var(prof_ref);
 
     mixer->current_blockcount = blockcount;
 
     // Zero buffers
     fluid_mixer_buffers_zero(&mixer->buffers, blockcount);
+    fluid_rvoice_mixer_stage_done(mixer, FLUID_SYNTH_STAGE_CLEAR, start);
     fluid_profile(FLUID_PROF_ONE_BLOCK_CLEAR, prof_ref, mixer->active_voices,
                   blockcount * FLUID_BUFSIZE);
 
+    start = fluid_cycles();
+
 #if ENABLE_MIXER_THREADS
 
     if(mixer->thread_count > 0)
@@ -1381,6 +1779,12 @@ fluid_rvoice_mixer_render(fluid_rvoice_mixer_t *mixer, int blockcount)
         fluid_render_loop_singlethread(mixer, blockcount);
     }
 
+    fluid_rvoice_mixer_stage_done(mixer, FLUID_SYNTH_STAGE_VOICES, start);
+
+    if(mixer->cost_accounting)
+    {
+        fluid_rvoice_mixer_collect_costs(mixer);
+    }
     fluid_profile(FLUID_PROF_ONE_BLOCK_VOICES, prof_ref, mixer->active_voices,
                   blockcount * FLUID_BUFSIZE);
 
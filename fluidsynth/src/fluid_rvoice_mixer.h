@@ -24,6 +24,7 @@
 
 #include "fluidsynth_priv.h"
 #include "fluid_rvoice.h"
+#include "fluid_trace.h"
 
 typedef struct _fluid_rvoice_mixer_t fluid_rvoice_mixer_t;
 
@@ -33,6 +34,13 @@ int fluid_rvoice_mixer_get_bufs(fluid_rvoice_mixer_t *mixer,
 int fluid_rvoice_mixer_get_fx_bufs(fluid_rvoice_mixer_t *mixer,
                                    fluid_real_t **fx_left, fluid_real_t **fx_right);
 int fluid_rvoice_mixer_get_bufcount(fluid_rvoice_mixer_t *mixer);
+fluid_stage_stats_t *fluid_rvoice_mixer_get_stage_stats(fluid_rvoice_mixer_t *mixer);
+int fluid_rvoice_mixer_alloc_channel_costs(fluid_rvoice_mixer_t *mixer, int channel_count);
+fluid_channel_cost_t *fluid_rvoice_mixer_get_channel_costs(fluid_rvoice_mixer_t *mixer, int *channel_count);
+void fluid_rvoice_mixer_reset_channel_cost(fluid_channel_cost_t *cost);
+void fluid_rvoice_mixer_stage_done(fluid_rvoice_mixer_t *mixer, int stage, uint64_t start);
+void fluid_rvoice_mixer_set_trace(fluid_rvoice_mixer_t *mixer, fluid_trace_t *trace);
+void fluid_rvoice_mixer_get_memory(fluid_rvoice_mixer_t *mixer, fluid_memory_stats_t *stats);
 #if WITH_PROFILING
 int fluid_rvoice_mixer_get_active_voices(fluid_rvoice_mixer_t *mixer);
 #endif
@@ -41,12 +49,18 @@ fluid_rvoice_mixer_t *new_fluid_rvoice_mixer(int buf_count, int fx_buf_count, in
 
 void delete_fluid_rvoice_mixer(fluid_rvoice_mixer_t *);
 
+void fluid_rvoice_buffers_mix(fluid_rvoice_buffers_t *buffers,
+                              const fluid_real_t *FLUID_RESTRICT dsp_buf,
+                              int start_block, int sample_count,
+                              fluid_real_t **dest_bufs, int dest_bufcount);
+
 
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_add_voice);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_samplerate);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_polyphony);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_chorus_enabled);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_reverb_enabled);
+DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_cost_accounting);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_chorus_params);
 DECLARE_FLUID_RVOICE_FUNCTION(fluid_rvoice_mixer_set_reverb_params);
 
@@ -64,6 +64,7 @@ static fluid_samplecache_entry_t *new_samplecache_entry(SFData *sf, unsigned int
 static fluid_samplecache_entry_t *get_samplecache_entry(SFData *sf, unsigned int sample_start,
         unsigned int sample_end, int sample_type, time_t mtime);
 static void delete_samplecache_entry(fluid_samplecache_entry_t *entry);
+static size_t samplecache_entry_bytes(const fluid_samplecache_entry_t *entry);
 
 static int fluid_get_file_modification_time(char *filename, time_t *modification_time);
 
@@ -98,6 +99,7 @@ int fluid_samplecache_load(SFData *sf,
         }
 
         samplecache_list = fluid_list_prepend(samplecache_list, entry);
+        fluid_memory_account(FLUID_MEMORY_SAMPLES_SHARED, samplecache_entry_bytes(entry));
     }
 
     if(try_mlock && !entry->mlocked)
@@ -120,6 +122,10 @@ int fluid_samplecache_load(SFData *sf,
                 fluid_munlock(entry->sample_data, entry->sample_count * sizeof(short));
                 FLUID_LOG(FLUID_WARN, "Failed to pin the sample data to RAM; swapping is possible.");
             }
+            else
+            {
+                fluid_memory_account_locked(samplecache_entry_bytes(entry));
+            }
         }
     }
 
@@ -161,8 +167,11 @@ int fluid_samplecache_unload(const short *sample_data)
                     {
                         fluid_munlock(entry->sample_data24, entry->sample_count);
                     }
+
+                    fluid_memory_account_locked(-(ptrdiff_t)samplecache_entry_bytes(entry));
                 }
 
+                fluid_memory_account(FLUID_MEMORY_SAMPLES_SHARED, -(ptrdiff_t)samplecache_entry_bytes(entry));
                 samplecache_list = fluid_list_remove(samplecache_list, entry);
                 delete_samplecache_entry(entry);
             }
@@ -182,8 +191,53 @@ unlock_exit:
     return ret;
 }
 
+/* Adds the size of the cached sample data starting at sample_data to
+ * bytes, and to locked if it is pinned to RAM. Returns FLUID_FAILED if
+ * sample_data is not in the cache. */
+int fluid_samplecache_get_memory(const short *sample_data, size_t *bytes, size_t *locked)
+{
+    fluid_list_t *entry_list;
+    fluid_samplecache_entry_t *entry;
+    int ret = FLUID_FAILED;
+
+    fluid_mutex_lock(samplecache_mutex);
+
+    for(entry_list = samplecache_list; entry_list; entry_list = fluid_list_next(entry_list))
+    {
+        entry = (fluid_samplecache_entry_t *)fluid_list_get(entry_list);
+
+        if(sample_data == entry->sample_data)
+        {
+            *bytes += samplecache_entry_bytes(entry);
+
+            if(entry->mlocked)
+            {
+                *locked += samplecache_entry_bytes(entry);
+            }
+
+            ret = FLUID_OK;
+            break;
+        }
+    }
+
+    fluid_mutex_unlock(samplecache_mutex);
+    return ret;
+}
+
 
 /* Private functions */
+static size_t samplecache_entry_bytes(const fluid_samplecache_entry_t *entry)
+{
+    size_t bytes = entry->sample_count * sizeof(short);
+
+    if(entry->sample_data24 != NULL)
+    {
+        bytes += entry->sample_count;
+    }
+
+    return bytes;
+}
+
 static fluid_samplecache_entry_t *new_samplecache_entry(SFData *sf,
         unsigned int sample_start,
         unsigned int sample_end,
@@ -31,4 +31,6 @@ int fluid_samplecache_load(SFData *sf,
 
 int fluid_samplecache_unload(const short *sample_data);
 
+int fluid_samplecache_get_memory(const short *sample_data, size_t *bytes, size_t *locked);
+
 #endif /* _FLUID_SAMPLECACHE_H */
@@ -509,6 +509,8 @@ delete_fluid_sample(fluid_sample_t *sample)
 {
     fluid_return_if_fail(sample != NULL);
 
+    fluid_sample_free_mipmap(sample);
+
     if(sample->auto_free)
     {
         FLUID_FREE(sample->data);
@@ -798,3 +800,178 @@ int fluid_sample_sanitize_loop(fluid_sample_t *sample, unsigned int buffer_size)
 
     return modified;
 }
+
+/* half the number of taps of the decimation filter */
+#define MIPMAP_FILTER_HALF_TAPS 15
+
+/* smallest sample and loop length (in frames) a level is built for */
+#define MIPMAP_MIN_FRAMES 64U
+#define MIPMAP_MIN_LOOP_FRAMES 16U
+
+/* number of zero frames after the end of a level */
+#define MIPMAP_PADDING 8U
+
+/* Bytes allocated for a mipmap level by fluid_sample_decimate() */
+#define MIPMAP_LEVEL_BYTES(_level) \
+    (sizeof(fluid_sample_t) + ((_level)->end + 1 + MIPMAP_PADDING) * sizeof(short))
+
+/*
+ * Create a copy of a sample at half its sample rate. The sample is low pass
+ * filtered with a windowed-sinc half band filter and decimated by two, its
+ * sample and loop points are halved. Returns NULL if the sample cannot be
+ * decimated without detuning its loop, or if it is too short.
+ */
+static fluid_sample_t *
+fluid_sample_decimate(const fluid_sample_t *sample)
+{
+    fluid_real_t coeffs[MIPMAP_FILTER_HALF_TAPS + 1];
+    fluid_real_t sum = 0;
+    fluid_sample_t *level;
+    const short *src;
+    unsigned int frames, level_frames, loop_frames, i;
+    int k;
+
+    frames = sample->end - sample->start + 1;
+    loop_frames = sample->loopend > sample->loopstart ? sample->loopend - sample->loopstart : 0;
+    level_frames = (frames + 1) / 2;
+
+    /* an odd loop length would detune the loop, it cannot be halved */
+    if(sample->data == NULL || sample->data24 != NULL || level_frames < MIPMAP_MIN_FRAMES
+            || (loop_frames != 0 && (loop_frames % 2 != 0 || loop_frames / 2 < MIPMAP_MIN_LOOP_FRAMES)))
+    {
+        return NULL;
+    }
+
+    /* Blackman windowed sinc at half the nyquist frequency. Every second
+     * coefficient is zero, except for the center tap. */
+    for(k = 0; k <= MIPMAP_FILTER_HALF_TAPS; k++)
+    {
+        fluid_real_t x = (fluid_real_t)(M_PI * k / 2);
+        fluid_real_t w = (fluid_real_t)(M_PI * (k + MIPMAP_FILTER_HALF_TAPS + 1) / (MIPMAP_FILTER_HALF_TAPS + 1));
+
+        coeffs[k] = (k == 0 ? 1.0f : FLUID_SIN(x) / x)
+                    * (0.42f - 0.5f * FLUID_COS(w) + 0.08f * FLUID_COS(2 * w));
+        sum += (k == 0 ? 1.0f : 2.0f) * coeffs[k];
+    }
+
+    for(k = 0; k <= MIPMAP_FILTER_HALF_TAPS; k++)
+    {
+        coeffs[k] /= sum;
+    }
+
+    level = new_fluid_sample();
+
+    if(level == NULL)
+    {
+        return NULL;
+    }
+
+    /* some zero padding after the end, like in a SoundFont file */
+    level->data = FLUID_ARRAY(short, level_frames + MIPMAP_PADDING);
+
+    if(level->data == NULL)
+    {
+        FLUID_LOG(FLUID_ERR, "Out of memory");
+        delete_fluid_sample(level);
+        return NULL;
+    }
+
+    src = &sample->data[sample->start];
+
+    for(i = 0; i < level_frames; i++)
+    {
+        unsigned int center = 2 * i;
+        fluid_real_t y = coeffs[0] * src[center];
+
+        for(k = 1; k <= MIPMAP_FILTER_HALF_TAPS; k += 2)
+        {
+            fluid_real_t prev = center >= (unsigned int)k ? src[center - k] : 0;
+            fluid_real_t next = center + k < frames ? src[center + k] : 0;
+
+            y += coeffs[k] * (prev + next);
+        }
+
+        /* round to nearest and clip */
+        y += (y < 0) ? -0.5f : 0.5f;
+        fluid_clip(y, -32768.0f, 32767.0f);
+        level->data[i] = (short)y;
+    }
+
+    FLUID_MEMSET(&level->data[level_frames], 0, MIPMAP_PADDING * sizeof(short));
+
+    FLUID_STRCPY(level->name, sample->name);
+    level->start = 0;
+    level->end = level_frames - 1;
+    level->loopstart = (sample->loopstart - sample->start) / 2;
+    level->loopend = (sample->loopend - sample->start) / 2;
+    level->samplerate = sample->samplerate / 2;
+    level->origpitch = sample->origpitch;
+    level->pitchadj = sample->pitchadj;
+    level->sampletype = sample->sampletype;
+    level->auto_free = TRUE;
+    level->amplitude_that_reaches_noise_floor_is_valid = sample->amplitude_that_reaches_noise_floor_is_valid;
+    level->amplitude_that_reaches_noise_floor = sample->amplitude_that_reaches_noise_floor;
+
+    fluid_memory_account(FLUID_MEMORY_SAMPLES_PRIVATE, MIPMAP_LEVEL_BYTES(level));
+
+    return level;
+}
+
+/*
+ * Build the mipmap of a sample: a chain of up to levels copies, each at half
+ * the sample rate of the previous one. A voice playing the sample at a high
+ * pitch reads from the level whose phase increment is at most 1 (see
+ * fluid_rvoice_write_dsp()). Levels that cannot be built are left out,
+ * which only costs performance, so this never fails.
+ */
+void
+fluid_sample_build_mipmap(fluid_sample_t *sample, int levels)
+{
+    fluid_sample_t *level = sample;
+
+    fluid_sample_free_mipmap(sample);
+
+    while(levels-- > 0 && level != NULL)
+    {
+        level->mipmap = fluid_sample_decimate(level);
+        level = level->mipmap;
+    }
+}
+
+/*
+ * Free the mipmap of a sample.
+ */
+void
+fluid_sample_free_mipmap(fluid_sample_t *sample)
+{
+    fluid_sample_t *level = sample->mipmap;
+
+    while(level != NULL)
+    {
+        fluid_sample_t *next = level->mipmap;
+
+        fluid_memory_account(FLUID_MEMORY_SAMPLES_PRIVATE, -(ptrdiff_t)MIPMAP_LEVEL_BYTES(level));
+        level->mipmap = NULL;
+        delete_fluid_sample(level);
+        level = next;
+    }
+
+    sample->mipmap = NULL;
+}
+
+/*
+ * Get the bytes allocated for the mipmap of a sample.
+ */
+size_t
+fluid_sample_get_mipmap_memory(const fluid_sample_t *sample)
+{
+    const fluid_sample_t *level;
+    size_t bytes = 0;
+
+    for(level = sample->mipmap; level != NULL; level = level->mipmap)
+    {
+        bytes += MIPMAP_LEVEL_BYTES(level);
+    }
+
+    return bytes;
+}
@@ -26,6 +26,9 @@
 
 int fluid_sample_validate(fluid_sample_t *sample, unsigned int max_end);
 int fluid_sample_sanitize_loop(fluid_sample_t *sample, unsigned int max_end);
+void fluid_sample_build_mipmap(fluid_sample_t *sample, int levels);
+void fluid_sample_free_mipmap(fluid_sample_t *sample);
+size_t fluid_sample_get_mipmap_memory(const fluid_sample_t *sample);
 
 /*
  * Utility macros to access soundfonts, presets, and samples
@@ -103,6 +106,12 @@ struct _fluid_sfont_t
     fluid_sfont_iteration_start_t iteration_start;
 
     fluid_sfont_iteration_next_t iteration_next;
+
+    /**
+     * Optional method adding the memory used by the SoundFont to stats,
+     * see fluid_synth_get_memory_stats().
+     */
+    void (*get_memory)(fluid_sfont_t *sfont, fluid_memory_stats_t *stats);
 };
 
 /**
@@ -173,6 +182,8 @@ struct _fluid_sample_t
     int amplitude_that_reaches_noise_floor_is_valid;      /**< Indicates if \a amplitude_that_reaches_noise_floor is valid (TRUE), set to FALSE initially to calculate. */
     double amplitude_that_reaches_noise_floor;            /**< The amplitude at which the sample's loop will be below the noise floor.  For voice off optimization, calculated automatically. */
 
+    fluid_sample_t *mipmap;       /**< Copy of this sample at half the sample rate, or NULL, see fluid_sample_build_mipmap() */
+
     unsigned int refcount;        /**< Count of voices using this sample */
     int preset_count;             /**< Count of selected presets using this sample (used for dynamic sample loading) */
 
@@ -56,11 +56,19 @@ extern int feenableexcept(int excepts);
 static void fluid_synth_init(void);
 static void fluid_synth_api_enter(fluid_synth_t *synth);
 static void fluid_synth_api_exit(fluid_synth_t *synth);
+static int fluid_synth_handle_midi_raw_LOCAL(fluid_synth_t *synth, const unsigned char *data);
+static void fluid_synth_stage_done(fluid_synth_t *synth, int stage, uint64_t start);
+static int fluid_synth_midi_raw_is_continuous(fluid_synth_t *synth, const unsigned char *data);
+static int fluid_synth_midi_raw_coalesce(fluid_synth_t *synth, fluid_midi_raw_event_t *pending,
+                                         int npending, const unsigned char *data);
+static int fluid_synth_midi_raw_flush(fluid_synth_t *synth, fluid_midi_raw_event_t *pending,
+                                      int npending, int chan);
 
 static int fluid_synth_noteon_LOCAL(fluid_synth_t *synth, int chan, int key,
                                     int vel);
 static int fluid_synth_noteoff_LOCAL(fluid_synth_t *synth, int chan, int key);
 static int fluid_synth_cc_LOCAL(fluid_synth_t *synth, int channum, int num);
+static int fluid_synth_program_change_LOCAL(fluid_synth_t *synth, int chan, int prognum);
 static int fluid_synth_sysex_midi_tuning(fluid_synth_t *synth, const char *data,
         int len, char *response,
         int *response_len, int avail_response,
@@ -241,6 +249,8 @@ void fluid_synth_settings(fluid_settings_t *settings)
     fluid_settings_add_option(settings, "synth.midi-bank-select", "mma");
 
     fluid_settings_register_int(settings, "synth.dynamic-sample-loading", 0, 0, 1, FLUID_HINT_TOGGLED);
+    fluid_settings_register_int(settings, "synth.sample-mipmap-levels", 0, 0, 8, 0);
+    fluid_settings_register_int(settings, "synth.sinc-taps", 16, 8, 64, 0);
 }
 
 /**
@@ -784,6 +794,11 @@ new_fluid_synth(fluid_settings_t *settings)
         goto error_recovery;
     }
 
+    if(fluid_rvoice_mixer_alloc_channel_costs(synth->eventhandler->mixer, synth->midi_channels) != FLUID_OK)
+    {
+        goto error_recovery;
+    }
+
     /* Setup the list of default modulators.
      * Needs to happen after eventhandler has been set up, as fluid_synth_enter_api is called in the process */
     synth->default_mod = NULL;
@@ -869,6 +884,7 @@ new_fluid_synth(fluid_settings_t *settings)
 
     /* allocate all synthesis processes */
     synth->nvoice = synth->polyphony;
+    synth->voice_cap = synth->polyphony;
     synth->voice = FLUID_ARRAY(fluid_voice_t *, synth->nvoice);
 
     if(synth->voice == NULL)
@@ -876,10 +892,26 @@ new_fluid_synth(fluid_settings_t *settings)
         goto error_recovery;
     }
 
+    fluid_settings_getint(settings, "synth.sinc-taps", &i);
+    synth->sinc_table = new_fluid_sinc_table(i);
+
+    if(synth->sinc_table == NULL)
+    {
+        goto error_recovery;
+    }
+
+    /* every voice has an rvoice and an overflow rvoice */
+    synth->rvoice_arena = new_fluid_rvoice_arena(2 * synth->nvoice);
+
+    if(synth->rvoice_arena == NULL)
+    {
+        goto error_recovery;
+    }
+
     FLUID_MEMSET(synth->voice, 0, synth->nvoice * sizeof(*synth->voice));
     for(i = 0; i < synth->nvoice; i++)
     {
-        synth->voice[i] = new_fluid_voice(synth->eventhandler, synth->sample_rate);
+        synth->voice[i] = new_fluid_voice(synth->eventhandler, synth->rvoice_arena, synth->sample_rate);
 
         if(synth->voice[i] == NULL)
         {
@@ -1036,6 +1068,11 @@ delete_fluid_synth(fluid_synth_t *synth)
 
     delete_fluid_rvoice_eventhandler(synth->eventhandler);
 
+    if(synth->trace != NULL)
+    {
+        delete_fluid_trace(synth->trace);
+    }
+
     /* delete all the SoundFonts */
     for(list = synth->sfont; list; list = fluid_list_next(list))
     {
@@ -1076,6 +1113,9 @@ delete_fluid_synth(fluid_synth_t *synth)
         FLUID_FREE(synth->voice);
     }
 
+    delete_fluid_rvoice_arena(synth->rvoice_arena);
+    delete_fluid_sinc_table(synth->sinc_table);
+
 
     /* free the tunings, if any */
     if(synth->tuning != NULL)
@@ -2749,16 +2789,25 @@ fluid_synth_find_preset(fluid_synth_t *synth, int banknum,
 int
 fluid_synth_program_change(fluid_synth_t *synth, int chan, int prognum)
 {
-    fluid_preset_t *preset = NULL;
-    fluid_channel_t *channel;
-    int subst_bank, subst_prog, banknum = 0, result = FLUID_FAILED;
-
+    int result;
     fluid_return_val_if_fail(prognum >= 0 && prognum <= 128, FLUID_FAILED);
     FLUID_API_ENTRY_CHAN(FLUID_FAILED);
 
     /* Allowed only on MIDI channel enabled */
     FLUID_API_RETURN_IF_CHAN_DISABLED(FLUID_FAILED);
 
+    result = fluid_synth_program_change_LOCAL(synth, chan, prognum);
+    FLUID_API_RETURN(result);
+}
+
+/* Local synthesis thread variant of fluid_synth_program_change */
+static int
+fluid_synth_program_change_LOCAL(fluid_synth_t *synth, int chan, int prognum)
+{
+    fluid_preset_t *preset = NULL;
+    fluid_channel_t *channel;
+    int subst_bank, subst_prog, banknum = 0;
+
     channel = synth->channel[chan];
 
     if(channel->channel_type == CHANNEL_TYPE_DRUM)
@@ -2828,9 +2877,7 @@ fluid_synth_program_change(fluid_synth_t *synth, int chan, int prognum)
     /* Assign the SoundFont ID and program number to the channel */
     fluid_channel_set_sfont_bank_prog(channel, preset ? fluid_sfont_get_id(preset->sfont) : 0,
                                       -1, prognum);
-    result = fluid_synth_set_preset(synth, chan, preset);
-
-    FLUID_API_RETURN(result);
+    return fluid_synth_set_preset(synth, chan, preset);
 }
 
 /**
@@ -3218,7 +3265,7 @@ fluid_synth_update_polyphony_LOCAL(fluid_synth_t *synth, int new_polyphony)
 
         for(i = synth->nvoice; i < new_polyphony; i++)
         {
-            synth->voice[i] = new_fluid_voice(synth->eventhandler, synth->sample_rate);
+            synth->voice[i] = new_fluid_voice(synth->eventhandler, synth->rvoice_arena, synth->sample_rate);
 
             if(synth->voice[i] == NULL)
             {
@@ -3231,6 +3278,12 @@ fluid_synth_update_polyphony_LOCAL(fluid_synth_t *synth, int new_polyphony)
         synth->nvoice = new_polyphony;
     }
 
+    /* an unlimited voice cap follows the polyphony */
+    if(synth->voice_cap == synth->polyphony || synth->voice_cap > new_polyphony)
+    {
+        synth->voice_cap = new_polyphony;
+    }
+
     synth->polyphony = new_polyphony;
 
     /* turn off any voices above the new limit */
@@ -3267,6 +3320,50 @@ fluid_synth_get_polyphony(fluid_synth_t *synth)
     FLUID_API_RETURN(result);
 }
 
+/**
+ * Limit the number of voices sounding at once, without changing the polyphony.
+ * @param synth FluidSynth instance
+ * @param cap Maximum number of voices, 1 to the current polyphony
+ * @return #FLUID_OK on success, #FLUID_FAILED otherwise
+ *
+ * Contrary to fluid_synth_set_polyphony() the voices are neither allocated nor
+ * freed, which makes this safe to call from the synthesis thread. The cap only
+ * applies to new voices: voices already sounding above it are not cut off, but
+ * every note-on steals a voice as if the polyphony was exceeded, until the
+ * voices sounding have dropped below the cap. A cap equal to the polyphony
+ * removes the limit.
+ */
+int
+fluid_synth_set_voice_cap(fluid_synth_t *synth, int cap)
+{
+    fluid_return_val_if_fail(synth != NULL, FLUID_FAILED);
+    fluid_synth_api_enter(synth);
+
+    if(cap < 1 || cap > synth->polyphony)
+    {
+        FLUID_API_RETURN(FLUID_FAILED);
+    }
+
+    synth->voice_cap = cap;
+    FLUID_API_RETURN(FLUID_OK);
+}
+
+/**
+ * Get the current voice cap, see fluid_synth_set_voice_cap().
+ * @param synth FluidSynth instance
+ * @return Maximum number of voices sounding at once
+ */
+int
+fluid_synth_get_voice_cap(fluid_synth_t *synth)
+{
+    int result;
+    fluid_return_val_if_fail(synth != NULL, FLUID_FAILED);
+    fluid_synth_api_enter(synth);
+
+    result = synth->voice_cap;
+    FLUID_API_RETURN(result);
+}
+
 /**
  * @brief Get current number of active voices.
  *
@@ -3296,6 +3393,42 @@ fluid_synth_get_active_voice_count(fluid_synth_t *synth)
     FLUID_API_RETURN(result);
 }
 
+/**
+ * Stop voices which have been released and have decayed to a given level.
+ * @param synth FluidSynth instance
+ * @param level Linear amplitude (1.0 is a voice at full level) below which
+ *   a released voice is stopped
+ * @param max_count Maximum number of voices to stop, -1 for no limit
+ * @return Number of voices stopped or #FLUID_FAILED
+ *
+ * The voices are turned off without any further release, which is inaudible
+ * if level is low enough. This frees rendering time while voices still
+ * linger in long release phases, e.g. when the synthesizer is overloaded.
+ */
+int
+fluid_synth_stop_quiet_voices(fluid_synth_t *synth, float level, int max_count)
+{
+    fluid_voice_t *voice;
+    int i, count = 0;
+
+    fluid_return_val_if_fail(synth != NULL, FLUID_FAILED);
+    fluid_synth_api_enter(synth);
+
+    for(i = 0; i < synth->polyphony && count != max_count; i++)
+    {
+        voice = synth->voice[i];
+
+        if(voice->status == FLUID_VOICE_ON && voice->has_noteoff
+                && fluid_voice_get_amplitude(voice) < level)
+        {
+            fluid_voice_off(voice);
+            count++;
+        }
+    }
+
+    FLUID_API_RETURN(count);
+}
+
 /**
  * Get the internal synthesis buffer size value.
  * @param synth FluidSynth instance
@@ -3392,6 +3525,7 @@ fluid_synth_nwrite_float(fluid_synth_t *synth, int len,
     fluid_real_t *left_in, *fx_left_in;
     fluid_real_t *right_in, *fx_right_in;
     double time = fluid_utime();
+    uint64_t start = fluid_cycles();
     int i, num, available, count;
 #ifdef WITH_FLOAT
     int bytes;
@@ -3550,6 +3684,7 @@ fluid_synth_nwrite_float(fluid_synth_t *synth, int len,
     time = fluid_utime() - time;
     cpu_load = 0.5 * (fluid_atomic_float_get(&synth->cpu_load) + time * synth->sample_rate / len / 10000.0);
     fluid_atomic_float_set(&synth->cpu_load, cpu_load);
+    fluid_synth_stage_done(synth, FLUID_SYNTH_STAGE_WRITE, start);
 
     return FLUID_OK;
 }
@@ -3680,6 +3815,7 @@ fluid_synth_process_LOCAL(fluid_synth_t *synth, int len, int nfx, float *fx[],
     int nfxchan, nfxunits, naudchan;
 
     double time = fluid_utime();
+    uint64_t start = fluid_cycles();
     int i, f, num, count, buffered_blocks;
 
     float cpu_load;
@@ -3794,6 +3930,7 @@ fluid_synth_process_LOCAL(fluid_synth_t *synth, int len, int nfx, float *fx[],
     time = fluid_utime() - time;
     cpu_load = 0.5 * (fluid_atomic_float_get(&synth->cpu_load) + time * synth->sample_rate / len / 10000.0);
     fluid_atomic_float_set(&synth->cpu_load, cpu_load);
+    fluid_synth_stage_done(synth, FLUID_SYNTH_STAGE_WRITE, start);
 
     return FLUID_OK;
 }
@@ -3824,6 +3961,125 @@ fluid_synth_write_float(fluid_synth_t *synth, int len,
     return fluid_synth_write_float_LOCAL(synth, len, lout, loff, lincr, rout, roff, rincr, fluid_synth_render_blocks);
 }
 
+/* Capacity for coalesced messages in fluid_synth_write_float_midi() */
+#define FLUID_MIDI_RAW_PENDING_MAX 32
+
+/**
+ * Synthesize a block of floating point audio samples, applying a batch of
+ * raw MIDI channel messages at their frame offsets within the block.
+ * @param synth FluidSynth instance
+ * @param len Count of audio frames to synthesize
+ * @param events Raw MIDI messages, ordered by frame
+ * @param nevents Count of messages in 'events'
+ * @param lout Array of floats to store left channel of audio
+ * @param loff Offset index in 'lout' for first sample
+ * @param lincr Increment between samples stored to 'lout'
+ * @param rout Array of floats to store right channel of audio
+ * @param roff Offset index in 'rout' for first sample
+ * @param rincr Increment between samples stored to 'rout'
+ * @return #FLUID_OK on success, #FLUID_FAILED otherwise
+ *
+ * Equivalent to calling fluid_synth_write_float() up to the frame of each
+ * message and fluid_synth_handle_midi_event() for the message, but all
+ * messages sharing a frame are applied within a single API call, and the
+ * raw bytes are decoded directly instead of through a #fluid_midi_event_t.
+ * Messages whose frame lies before the one of the preceding message are
+ * applied together with it, messages at or beyond 'len' after the block.
+ * System messages are ignored.
+ *
+ * Continuous controller, pressure and pitch bend messages are coalesced
+ * until the next internal block of #FLUID_BUFSIZE frames gets rendered:
+ * only the last value per channel and controller (or key) is applied, as
+ * the voices pick up modulation changes at block boundaries anyway. Any
+ * other message on a channel first applies the messages pending for it,
+ * so their order relative to notes and program changes is preserved.
+ *
+ * @note Should only be called from synthesis thread.
+ */
+int
+fluid_synth_write_float_midi(fluid_synth_t *synth, int len,
+                             const fluid_midi_raw_event_t *events, int nevents,
+                             void *lout, int loff, int lincr,
+                             void *rout, int roff, int rincr)
+{
+    fluid_midi_raw_event_t pending[FLUID_MIDI_RAW_PENDING_MAX];
+    int npending = 0;
+    int pos = 0;
+    int i = 0;
+
+    fluid_return_val_if_fail(synth != NULL, FLUID_FAILED);
+    fluid_return_val_if_fail(events != NULL || nevents == 0, FLUID_FAILED);
+
+    while(1)
+    {
+        int frame = len;
+
+        if(i < nevents && events[i].frame < (unsigned int) len)
+        {
+            frame = ((int) events[i].frame > pos) ? (int) events[i].frame : pos;
+        }
+
+        /* pending messages must take effect before a new block is rendered,
+         * which happens once the frames buffered by the last one run out */
+        if(npending > 0 && (i == nevents || frame - pos > synth->curmax - synth->cur))
+        {
+            fluid_synth_api_enter(synth);
+            npending = fluid_synth_midi_raw_flush(synth, pending, npending, -1);
+            fluid_synth_api_exit(synth);
+        }
+
+        if(frame > pos)
+        {
+            fluid_synth_write_float_LOCAL(synth, frame - pos,
+                                          lout, loff + pos * lincr, lincr,
+                                          rout, roff + pos * rincr, rincr,
+                                          fluid_synth_render_blocks);
+            pos = frame;
+        }
+
+        if(i == nevents)
+        {
+            return FLUID_OK;
+        }
+
+        /* apply all messages due at this frame within a single API call */
+        fluid_synth_api_enter(synth);
+
+        do
+        {
+            const unsigned char *data = events[i].data;
+
+            fluid_trace_mark(synth->trace, FLUID_TRACE_EVENT,
+                             data[0] < 0xf0 ? data[0] & 0x0f : -1,
+                             data[0] | (data[1] << 8) | (data[2] << 16));
+
+            if(fluid_synth_midi_raw_is_continuous(synth, data))
+            {
+                npending = fluid_synth_midi_raw_coalesce(synth, pending, npending, data);
+            }
+            else
+            {
+                int chan = data[0] & 0x0f;
+
+                /* messages to a disabled channel may reach a whole channel group */
+                if(chan >= synth->midi_channels
+                        || !(synth->channel[chan]->mode & FLUID_CHANNEL_ENABLED))
+                {
+                    chan = -1;
+                }
+
+                npending = fluid_synth_midi_raw_flush(synth, pending, npending, chan);
+                fluid_synth_handle_midi_raw_LOCAL(synth, data);
+            }
+
+            i++;
+        }
+        while(i < nevents && (events[i].frame <= (unsigned int) pos || pos == len));
+
+        fluid_synth_api_exit(synth);
+    }
+}
+
 int
 fluid_synth_write_float_LOCAL(fluid_synth_t *synth, int len,
                               void *lout, int loff, int lincr,
@@ -3837,6 +4093,7 @@ fluid_synth_write_float_LOCAL(fluid_synth_t *synth, int len,
     fluid_real_t *left_in;
     fluid_real_t *right_in;
     double time = fluid_utime();
+    uint64_t start = fluid_cycles();
     float cpu_load;
 
     fluid_profile_ref_var(prof_ref);
@@ -3902,6 +4159,7 @@ fluid_synth_write_float_LOCAL(fluid_synth_t *synth, int len,
     time = fluid_utime() - time;
     cpu_load = 0.5 * (fluid_atomic_float_get(&synth->cpu_load) + time * synth->sample_rate / len / 10000.0);
     fluid_atomic_float_set(&synth->cpu_load, cpu_load);
+    fluid_synth_stage_done(synth, FLUID_SYNTH_STAGE_WRITE, start);
 
     fluid_profile_write(FLUID_PROF_WRITE, prof_ref,
                         fluid_rvoice_mixer_get_active_voices(synth->eventhandler->mixer),
@@ -3995,6 +4253,7 @@ fluid_synth_write_s16(fluid_synth_t *synth, int len,
     fluid_real_t *left_in;
     fluid_real_t *right_in;
     double time = fluid_utime();
+    uint64_t start = fluid_cycles();
     float cpu_load;
 
     fluid_profile_ref_var(prof_ref);
@@ -4067,6 +4326,7 @@ fluid_synth_write_s16(fluid_synth_t *synth, int len,
     time = fluid_utime() - time;
     cpu_load = 0.5 * (fluid_atomic_float_get(&synth->cpu_load) + time * synth->sample_rate / len / 10000.0);
     fluid_atomic_float_set(&synth->cpu_load, cpu_load);
+    fluid_synth_stage_done(synth, FLUID_SYNTH_STAGE_WRITE, start);
 
     fluid_profile_write(FLUID_PROF_WRITE, prof_ref,
                         fluid_rvoice_mixer_get_active_voices(synth->eventhandler->mixer),
@@ -4163,6 +4423,7 @@ static int
 fluid_synth_render_blocks(fluid_synth_t *synth, int blockcount)
 {
     int i, maxblocks;
+    uint64_t start = fluid_cycles();
     fluid_profile_ref_var(prof_ref);
 
     /* Assign ID of synthesis thread */
@@ -4212,6 +4473,7 @@ fluid_synth_render_blocks(fluid_synth_t *synth, int blockcount)
     };
 #endif
     fluid_check_fpe("??? Remainder of synth_one_block ???");
+    fluid_synth_stage_done(synth, FLUID_SYNTH_STAGE_BLOCKS, start);
     fluid_profile(FLUID_PROF_ONE_BLOCK, prof_ref,
                   fluid_rvoice_mixer_get_active_voices(synth->eventhandler->mixer),
                   blockcount * FLUID_BUFSIZE);
@@ -4332,10 +4594,10 @@ fluid_synth_free_voice_by_kill_LOCAL(fluid_synth_t *synth)
 
         voice = synth->voice[i];
 
-        /* safeguard against an available voice. */
+        /* available voices are only left over when the voice cap is reached */
         if(_AVAILABLE(voice))
         {
-            return voice;
+            continue;
         }
 
         this_voice_prio = fluid_voice_get_overflow_prio(voice, &synth->overflow,
@@ -4354,9 +4616,9 @@ fluid_synth_free_voice_by_kill_LOCAL(fluid_synth_t *synth)
         return NULL;
     }
 
+    /* no logging here, voices are stolen on the synthesis thread: the trace records it */
     voice = synth->voice[best_voice_index];
-    FLUID_LOG(FLUID_DBG, "Killing voice %d, index %d, chan %d, key %d ",
-              fluid_voice_get_id(voice), best_voice_index, fluid_voice_get_channel(voice), fluid_voice_get_key(voice));
+    fluid_trace_mark(synth->trace, FLUID_TRACE_VOICE_STEAL, fluid_voice_get_channel(voice), fluid_voice_get_key(voice));
     fluid_voice_off(voice);
 
     return voice;
@@ -4398,19 +4660,21 @@ fluid_synth_alloc_voice_LOCAL(fluid_synth_t *synth, fluid_sample_t *sample, int
     unsigned int ticks;
 
     /* check if there's an available synthesis process */
-    for(i = 0; i < synth->polyphony; i++)
+    for(i = 0, k = 0; i < synth->polyphony; i++)
     {
-        if(_AVAILABLE(synth->voice[i]))
+        if(!_AVAILABLE(synth->voice[i]))
+        {
+            k++;
+        }
+        else if(voice == NULL)
         {
             voice = synth->voice[i];
-            break;
         }
     }
 
-    /* No success yet? Then stop a running voice. */
-    if(voice == NULL)
+    /* No success yet, or the voice cap is reached? Then stop a running voice. */
+    if(voice == NULL || k >= synth->voice_cap)
     {
-        FLUID_LOG(FLUID_DBG, "Polyphony exceeded, trying to kill a voice");
         voice = fluid_synth_free_voice_by_kill_LOCAL(synth);
     }
 
@@ -4547,6 +4811,7 @@ fluid_synth_start_voice(fluid_synth_t *synth, fluid_voice_t *voice)
     fluid_synth_kill_by_exclusive_class_LOCAL(synth, voice);
 
     fluid_voice_start(voice);     /* Start the new voice */
+    fluid_trace_mark(synth->trace, FLUID_TRACE_VOICE_START, voice->chan, voice->key);
     fluid_voice_lock_rvoice(voice);
     fluid_rvoice_eventhandler_add_rvoice(synth->eventhandler, voice->rvoice);
     fluid_synth_api_exit(synth);
@@ -5653,6 +5918,260 @@ fluid_synth_get_cpu_load(fluid_synth_t *synth)
     return fluid_atomic_float_get(&synth->cpu_load);
 }
 
+/**
+ * Get the time spent in the rendering stages since the last reset.
+ * @param synth FluidSynth instance
+ * @param stats Array to store the counters of each #fluid_synth_stage to
+ * @param count Length of 'stats', at most #FLUID_SYNTH_STAGE_LAST entries are filled
+ * @param reset TRUE to clear the counters after reading them
+ * @return Count of entries filled, or #FLUID_FAILED
+ *
+ * The counters are always updated and cost two time stamp reads per stage
+ * and pass. Neither reading them nor resetting them blocks.
+ *
+ * @note Should only be called from synthesis thread.
+ */
+int
+fluid_synth_get_stage_stats(fluid_synth_t *synth, fluid_stage_stats_t *stats, int count, int reset)
+{
+    fluid_stage_stats_t *stage_stats;
+
+    fluid_return_val_if_fail(synth != NULL, FLUID_FAILED);
+    fluid_return_val_if_fail(stats != NULL, FLUID_FAILED);
+    fluid_return_val_if_fail(count >= 0, FLUID_FAILED);
+
+    stage_stats = fluid_rvoice_mixer_get_stage_stats(synth->eventhandler->mixer);
+
+    if(count > FLUID_SYNTH_STAGE_LAST)
+    {
+        count = FLUID_SYNTH_STAGE_LAST;
+    }
+
+    FLUID_MEMCPY(stats, stage_stats, count * sizeof(*stats));
+
+    if(reset)
+    {
+        FLUID_MEMSET(stage_stats, 0, FLUID_SYNTH_STAGE_LAST * sizeof(*stage_stats));
+    }
+
+    return count;
+}
+
+/**
+ * Enable or disable the accounting of rendering cost per MIDI channel.
+ * @param synth FluidSynth instance
+ * @param on TRUE to enable, FALSE to disable
+ *
+ * When enabled, every voice counts the cycles spent rendering it and those
+ * are added to the MIDI channel the voice was started on after each
+ * rendering pass. This costs a few time stamp reads per voice and block,
+ * it is off by default.
+ */
+void
+fluid_synth_set_cost_accounting(fluid_synth_t *synth, int on)
+{
+    fluid_return_if_fail(synth != NULL);
+
+    fluid_synth_api_enter(synth);
+    fluid_synth_update_mixer(synth, fluid_rvoice_mixer_set_cost_accounting,
+                             on != 0, 0.0f);
+    fluid_synth_api_exit(synth);
+}
+
+/**
+ * Get the rendering cost of each MIDI channel since the last reset.
+ * @param synth FluidSynth instance
+ * @param costs Array to store the cost of each MIDI channel to
+ * @param count Length of 'costs', at most as many entries as MIDI channels are filled
+ * @param reset TRUE to clear the cycle, sample and peak voice counters after reading them
+ * @return Count of entries filled, or #FLUID_FAILED
+ *
+ * The costs are only accounted while enabled by fluid_synth_set_cost_accounting().
+ * The share of each channel is computed from the cycles of all channels,
+ * not only from the entries filled.
+ *
+ * @note Should only be called from synthesis thread.
+ */
+int
+fluid_synth_get_channel_costs(fluid_synth_t *synth, fluid_channel_cost_t *costs, int count, int reset)
+{
+    fluid_channel_cost_t *channel_costs;
+    unsigned long long total = 0;
+    int channel_count, i;
+
+    fluid_return_val_if_fail(synth != NULL, FLUID_FAILED);
+    fluid_return_val_if_fail(costs != NULL, FLUID_FAILED);
+    fluid_return_val_if_fail(count >= 0, FLUID_FAILED);
+
+    channel_costs = fluid_rvoice_mixer_get_channel_costs(synth->eventhandler->mixer, &channel_count);
+
+    if(count > channel_count)
+    {
+        count = channel_count;
+    }
+
+    for(i = 0; i < channel_count; i++)
+    {
+        total += channel_costs[i].cycles;
+    }
+
+    for(i = 0; i < count; i++)
+    {
+        costs[i] = channel_costs[i];
+        costs[i].share = total > 0 ? (double)channel_costs[i].cycles / total : 0.0;
+    }
+
+    if(reset)
+    {
+        for(i = 0; i < channel_count; i++)
+        {
+            fluid_rvoice_mixer_reset_channel_cost(&channel_costs[i]);
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Enable or disable the trace of the synthesis thread.
+ * @param synth FluidSynth instance
+ * @param size Count of records buffered until fluid_synth_read_trace() is
+ *   called, 0 to disable the trace
+ * @return #FLUID_OK on success, #FLUID_FAILED otherwise
+ *
+ * When enabled, the synthesis thread records the passes of the rendering
+ * stages, dispatched MIDI messages and voices being started, stolen and
+ * finished into a lockless buffer. Records that don't fit into it are
+ * dropped. It is off by default.
+ *
+ * @note Must not be called while rendering, nor concurrently with
+ * fluid_synth_read_trace().
+ */
+int
+fluid_synth_set_tracing(fluid_synth_t *synth, int size)
+{
+    fluid_trace_t *trace = NULL;
+
+    fluid_return_val_if_fail(synth != NULL, FLUID_FAILED);
+    fluid_return_val_if_fail(size >= 0, FLUID_FAILED);
+
+    if(size > 0)
+    {
+        trace = new_fluid_trace(size);
+
+        if(trace == NULL)
+        {
+            return FLUID_FAILED;
+        }
+    }
+
+    fluid_synth_api_enter(synth);
+    fluid_rvoice_mixer_set_trace(synth->eventhandler->mixer, trace);
+
+    if(synth->trace != NULL)
+    {
+        delete_fluid_trace(synth->trace);
+    }
+
+    synth->trace = trace;
+    fluid_synth_api_exit(synth);
+
+    return FLUID_OK;
+}
+
+/**
+ * Read the oldest records of the trace of the synthesis thread.
+ * @param synth FluidSynth instance
+ * @param records Array to store the records to, oldest first
+ * @param count Length of 'records'
+ * @param dropped Set to the count of records dropped since the last read
+ *   because the buffer was full, may be NULL
+ * @return Count of records stored, or #FLUID_FAILED if tracing is disabled
+ *
+ * Never blocks the synthesis thread. Only one thread may read the trace.
+ */
+int
+fluid_synth_read_trace(fluid_synth_t *synth, fluid_trace_record_t *records, int count,
+                       unsigned int *dropped)
+{
+    fluid_return_val_if_fail(synth != NULL, FLUID_FAILED);
+    fluid_return_val_if_fail(records != NULL, FLUID_FAILED);
+    fluid_return_val_if_fail(count >= 0, FLUID_FAILED);
+
+    if(synth->trace == NULL)
+    {
+        return FLUID_FAILED;
+    }
+
+    return fluid_trace_read(synth->trace, records, count, dropped);
+}
+
+/**
+ * Get the current time stamp of the clock used by the rendering stage
+ * counters and the trace.
+ * @return Time stamp, see #fluid_stage_stats_t. Only differences are meaningful.
+ */
+unsigned long long
+fluid_synth_get_cycles(void)
+{
+    return fluid_cycles();
+}
+
+/**
+ * Get the memory allocated for a synth instance.
+ * @param synth FluidSynth instance
+ * @param stats Memory stats to fill
+ * @return #FLUID_OK on success, #FLUID_FAILED otherwise
+ *
+ * Sample data of the sample cache is counted in full by each synth that
+ * references it, see fluid_get_memory_stats() for the process-wide totals.
+ * Only SoundFonts of the default loader report their memory.
+ *
+ * @note Must not be called concurrently with fluid_synth_set_polyphony()
+ * or the loading and unloading of SoundFonts.
+ */
+int
+fluid_synth_get_memory_stats(fluid_synth_t *synth, fluid_memory_stats_t *stats)
+{
+    fluid_list_t *list;
+    fluid_sfont_t *sfont;
+
+    fluid_return_val_if_fail(synth != NULL, FLUID_FAILED);
+    fluid_return_val_if_fail(stats != NULL, FLUID_FAILED);
+    fluid_synth_api_enter(synth);
+
+    FLUID_MEMSET(stats, 0, sizeof(*stats));
+
+    for(list = synth->sfont; list; list = fluid_list_next(list))
+    {
+        sfont = fluid_list_get(list);
+
+        if(sfont->get_memory != NULL)
+        {
+            sfont->get_memory(sfont, stats);
+        }
+    }
+
+    stats->bytes[FLUID_MEMORY_VOICES] += synth->nvoice * sizeof(fluid_voice_t)
+                                         + fluid_rvoice_arena_get_memory(synth->rvoice_arena);
+
+    fluid_rvoice_eventhandler_get_memory(synth->eventhandler, stats);
+
+    if(synth->trace != NULL)
+    {
+        stats->bytes[FLUID_MEMORY_EVENTS] += fluid_ringbuffer_get_memory(synth->trace->queue);
+    }
+
+    FLUID_API_RETURN(FLUID_OK);
+}
+
+/* Accounts a pass of a rendering stage that started at cycles 'start' */
+static void
+fluid_synth_stage_done(fluid_synth_t *synth, int stage, uint64_t start)
+{
+    fluid_rvoice_mixer_stage_done(synth->eventhandler->mixer, stage, start);
+}
+
 /* Get tuning for a given bank:program */
 static fluid_tuning_t *
 fluid_synth_get_tuning(fluid_synth_t *synth, int bank, int prog)
@@ -6247,6 +6766,196 @@ fluid_synth_get_gen(fluid_synth_t *synth, int chan, int param)
     FLUID_API_RETURN(result);
 }
 
+/*
+ * Applies a raw MIDI channel message. Must be called within an API call
+ * (see fluid_synth_write_float_midi()): the channel is checked once and
+ * the message goes straight to the local variants of the API functions.
+ */
+static int
+fluid_synth_handle_midi_raw_LOCAL(fluid_synth_t *synth, const unsigned char *data)
+{
+    int chan = data[0] & 0x0f;
+    fluid_channel_t *channel;
+
+    if(chan >= synth->midi_channels)
+    {
+        return FLUID_FAILED;
+    }
+
+    channel = synth->channel[chan];
+
+    if(!(channel->mode & FLUID_CHANNEL_ENABLED))
+    {
+        /* only a control change may address the basic channel of a mono group */
+        if((data[0] & 0xf0) == CONTROL_CHANGE)
+        {
+            return fluid_synth_cc(synth, chan, data[1] & 0x7f, data[2] & 0x7f);
+        }
+
+        return FLUID_FAILED;
+    }
+
+    switch(data[0] & 0xf0)
+    {
+    case NOTE_ON:
+        return fluid_synth_noteon_LOCAL(synth, chan, data[1] & 0x7f, data[2] & 0x7f);
+
+    case NOTE_OFF:
+        return fluid_synth_noteoff_LOCAL(synth, chan, data[1] & 0x7f);
+
+    case CONTROL_CHANGE:
+        if(synth->verbose)
+        {
+            FLUID_LOG(FLUID_INFO, "cc\t%d\t%d\t%d", chan, data[1] & 0x7f, data[2] & 0x7f);
+        }
+
+        fluid_channel_set_cc(channel, data[1] & 0x7f, data[2] & 0x7f);
+        return fluid_synth_cc_LOCAL(synth, chan, data[1] & 0x7f);
+
+    case PROGRAM_CHANGE:
+        return fluid_synth_program_change_LOCAL(synth, chan, data[1] & 0x7f);
+
+    case CHANNEL_PRESSURE:
+        if(synth->verbose)
+        {
+            FLUID_LOG(FLUID_INFO, "channelpressure\t%d\t%d", chan, data[1] & 0x7f);
+        }
+
+        fluid_channel_set_channel_pressure(channel, data[1] & 0x7f);
+        return fluid_synth_update_channel_pressure_LOCAL(synth, chan);
+
+    case KEY_PRESSURE:
+        if(synth->verbose)
+        {
+            FLUID_LOG(FLUID_INFO, "keypressure\t%d\t%d\t%d", chan, data[1] & 0x7f, data[2] & 0x7f);
+        }
+
+        fluid_channel_set_key_pressure(channel, data[1] & 0x7f, data[2] & 0x7f);
+        return fluid_synth_update_key_pressure_LOCAL(synth, chan, data[1] & 0x7f);
+
+    case PITCH_BEND:
+        if(synth->verbose)
+        {
+            FLUID_LOG(FLUID_INFO, "pitchb\t%d\t%d", chan, ((data[2] & 0x7f) << 7) | (data[1] & 0x7f));
+        }
+
+        fluid_channel_set_pitch_bend(channel, ((data[2] & 0x7f) << 7) | (data[1] & 0x7f));
+        return fluid_synth_update_pitch_bend_LOCAL(synth, chan);
+    }
+
+    return FLUID_FAILED;
+}
+
+/*
+ * Returns TRUE if a raw MIDI channel message only sets a continuous value,
+ * of which just the last one within a rendered block is audible. Switch
+ * pedals, bank select, breath note on/off, (N)RPN data entry, portamento
+ * control and channel mode messages have side effects on notes or on
+ * following messages and are never coalesced.
+ */
+static int
+fluid_synth_midi_raw_is_continuous(fluid_synth_t *synth, const unsigned char *data)
+{
+    int chan = data[0] & 0x0f;
+
+    if(chan >= synth->midi_channels
+            || !(synth->channel[chan]->mode & FLUID_CHANNEL_ENABLED))
+    {
+        return FALSE;
+    }
+
+    switch(data[0] & 0xf0)
+    {
+    case KEY_PRESSURE:
+    case CHANNEL_PRESSURE:
+    case PITCH_BEND:
+        return TRUE;
+
+    case CONTROL_CHANGE:
+        switch(data[1] & 0x7f)
+        {
+        case BANK_SELECT_MSB:
+        case BANK_SELECT_LSB:
+        case BREATH_MSB:
+        case DATA_ENTRY_MSB:
+        case DATA_ENTRY_LSB:
+        case PORTAMENTO_CTRL:
+        case DATA_ENTRY_INCR:
+        case DATA_ENTRY_DECR:
+        case NRPN_LSB:
+        case NRPN_MSB:
+        case RPN_LSB:
+        case RPN_MSB:
+            return FALSE;
+
+        default:
+            /* neither a switch nor a channel mode message */
+            return !((data[1] & 0x7f) >= SUSTAIN_SWITCH && (data[1] & 0x7f) <= HOLD2_SWITCH)
+                   && (data[1] & 0x7f) < ALL_SOUND_OFF;
+        }
+    }
+
+    return FALSE;
+}
+
+/*
+ * Replaces the pending value of a continuous message, or appends it to
+ * the pending ones. Must be called within an API call. Returns the new
+ * count of pending messages.
+ */
+static int
+fluid_synth_midi_raw_coalesce(fluid_synth_t *synth, fluid_midi_raw_event_t *pending,
+                              int npending, const unsigned char *data)
+{
+    int status = data[0] & 0xf0;
+    int i;
+
+    for(i = 0; i < npending; i++)
+    {
+        if(pending[i].data[0] == data[0]
+                && (status == PITCH_BEND || status == CHANNEL_PRESSURE
+                    || pending[i].data[1] == data[1]))
+        {
+            FLUID_MEMCPY(pending[i].data, data, sizeof(pending[i].data));
+            return npending;
+        }
+    }
+
+    if(npending == FLUID_MIDI_RAW_PENDING_MAX)
+    {
+        npending = fluid_synth_midi_raw_flush(synth, pending, npending, -1);
+    }
+
+    FLUID_MEMCPY(pending[npending].data, data, sizeof(pending[npending].data));
+    return npending + 1;
+}
+
+/*
+ * Applies the pending messages of a MIDI channel (of all channels if
+ * 'chan' is -1) in their order. Must be called within an API call.
+ * Returns the count of messages still pending.
+ */
+static int
+fluid_synth_midi_raw_flush(fluid_synth_t *synth, fluid_midi_raw_event_t *pending,
+                           int npending, int chan)
+{
+    int i, n = 0;
+
+    for(i = 0; i < npending; i++)
+    {
+        if(chan == -1 || (pending[i].data[0] & 0x0f) == chan)
+        {
+            fluid_synth_handle_midi_raw_LOCAL(synth, pending[i].data);
+        }
+        else
+        {
+            pending[n++] = pending[i];
+        }
+    }
+
+    return n;
+}
+
 /**
  * Handle MIDI event from MIDI router, used as a callback function.
  * @param data FluidSynth instance
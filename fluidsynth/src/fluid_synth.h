@@ -106,6 +106,7 @@ struct _fluid_synth_t
     fluid_settings_t *settings;        /**< the synthesizer settings */
     int device_id;                     /**< Device ID used for SYSEX messages */
     int polyphony;                     /**< Maximum polyphony */
+    int voice_cap;                     /**< Maximum number of voices sounding at once (<= polyphony) */
     int with_reverb;                   /**< Should the synth use the built-in reverb unit? */
     int with_chorus;                   /**< Should the synth use the built-in chorus unit? */
     int verbose;                       /**< Turn verbose mode on? */
@@ -130,11 +131,14 @@ struct _fluid_synth_t
     fluid_channel_t **channel;         /**< the channels */
     int nvoice;                        /**< the length of the synthesis process array (max polyphony allowed) */
     fluid_voice_t **voice;             /**< the synthesis voices */
+    fluid_rvoice_arena_t *rvoice_arena; /**< storage of the rvoices of all voices */
+    fluid_sinc_table_t *sinc_table;     /**< coefficients for FLUID_INTERP_SINC */
     int active_voice_count;            /**< count of active voices */
     unsigned int noteid;               /**< the id is incremented for every new note. it's used for noteoff's  */
     unsigned int storeid;
     int fromkey_portamento;			 /**< fromkey portamento */
     fluid_rvoice_eventhandler_t *eventhandler;
+    fluid_trace_t *trace;              /**< Trace of the synthesis thread or NULL, see fluid_synth_set_tracing() */
 
     double reverb_roomsize;             /**< Shadow of reverb roomsize */
     double reverb_damping;              /**< Shadow of reverb damping */
@@ -192,10 +192,15 @@ fluid_log(int level, const char *fmt, ...)
     return FLUID_FAILED;
 }
 
+/* count of calls to fluid_alloc() in this process */
+static fluid_atomic_int_t fluid_alloc_count = 0;
+
 void* fluid_alloc(size_t len)
 {
     void* ptr = malloc(len);
 
+    fluid_atomic_int_inc(&fluid_alloc_count);
+
 #if defined(DEBUG) && !defined(_MSC_VER)
     // garbage initialize allocated memory for debug builds to ease reproducing
     // bugs like 44453ff23281b3318abbe432fda90888c373022b .
@@ -215,6 +220,67 @@ void* fluid_alloc(size_t len)
     return ptr;
 }
 
+/**
+ * Get the count of memory allocations made by fluidsynth so far.
+ * @return Count of allocations of all synth instances of the process,
+ *   wrapping around at UINT_MAX. Only differences are meaningful.
+ *
+ * Counts the allocations of structures, arrays and sample data, not the
+ * resizing of existing ones.
+ */
+unsigned int fluid_get_alloc_count(void)
+{
+    return (unsigned int)fluid_atomic_int_get(&fluid_alloc_count);
+}
+
+/* bytes allocated by all synth instances of the process, by fluid_memory_type */
+static volatile size_t fluid_memory_bytes[FLUID_MEMORY_LAST];
+static volatile size_t fluid_memory_locked = 0;
+
+/*
+ * Account memory allocated (bytes > 0) or freed (bytes < 0) to the
+ * process-wide totals, see fluid_get_memory_stats(). Called by the
+ * allocating module, which knows what the memory is used for.
+ */
+void fluid_memory_account(int type, ptrdiff_t bytes)
+{
+    fluid_return_if_fail(type >= 0 && type < FLUID_MEMORY_LAST);
+
+    fluid_atomic_pointer_add(&fluid_memory_bytes[type], bytes);
+}
+
+/*
+ * Account memory pinned to RAM (bytes > 0) or unpinned (bytes < 0), in
+ * addition to fluid_memory_account().
+ */
+void fluid_memory_account_locked(ptrdiff_t bytes)
+{
+    fluid_atomic_pointer_add(&fluid_memory_locked, bytes);
+}
+
+/**
+ * Get the memory allocated by all synth instances of the process.
+ * @param stats Memory stats to fill
+ *
+ * Sample data shared by several synths is counted once. Memory is
+ * accounted by the modules allocating it, as opposed to
+ * fluid_synth_get_memory_stats() it includes synths that are being
+ * created or deleted.
+ */
+void fluid_get_memory_stats(fluid_memory_stats_t *stats)
+{
+    int i;
+
+    fluid_return_if_fail(stats != NULL);
+
+    for(i = 0; i < FLUID_MEMORY_LAST; i++)
+    {
+        stats->bytes[i] = (size_t)fluid_atomic_pointer_get(&fluid_memory_bytes[i]);
+    }
+
+    stats->locked = (size_t)fluid_atomic_pointer_get(&fluid_memory_locked);
+}
+
 /**
  * Convenience wrapper for free() that satisfies at least C90 requirements.
  * Especially useful when using fluidsynth with programming languages that do not provide malloc() and free().
@@ -212,6 +212,54 @@ typedef int socklen_t;
 unsigned int fluid_curtime(void);
 double fluid_utime(void);
 
+/**
+ * Cheap time stamp for the always-on rendering stage counters: the CPU time
+ * stamp counter where it can be read directly, nanoseconds otherwise.
+ * Only differences are meaningful.
+ */
+static FLUID_INLINE uint64_t fluid_cycles(void)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#elif defined(__GNUC__) && defined(__aarch64__)
+    uint64_t t;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+#else
+    return (uint64_t)(fluid_utime() * 1000.0);
+#endif
+}
+
+/* Accounts a pass of a rendering stage that started at cycles 'start',
+ * returns the time stamp of its end */
+static FLUID_INLINE uint64_t
+fluid_stage_stats_add(fluid_stage_stats_t *stats, uint64_t start)
+{
+    uint64_t end = fluid_cycles();
+    uint64_t cycles = end - start;
+
+    stats->cycles += cycles;
+    stats->count++;
+
+    if(cycles > stats->max_cycles)
+    {
+        stats->max_cycles = cycles;
+    }
+
+    return end;
+}
+
+
+/**
+    Memory accounting
+
+ */
+
+void fluid_memory_account(int type, ptrdiff_t bytes);
+void fluid_memory_account_locked(ptrdiff_t bytes);
+
 
 /**
     Timers
@@ -401,6 +449,7 @@ typedef GStaticPrivate fluid_private_t;
 #define fluid_atomic_pointer_set(_pp, val)      g_atomic_pointer_set(_pp, val)
 #define fluid_atomic_pointer_compare_and_exchange(_pp, _old, _new) \
   g_atomic_pointer_compare_and_exchange(_pp, _old, _new)
+#define fluid_atomic_pointer_add(_pp, _add)     g_atomic_pointer_add(_pp, _add)
 
 static FLUID_INLINE void
 fluid_atomic_float_set(volatile float *fptr, float val)
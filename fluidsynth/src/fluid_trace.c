@@ -0,0 +1,106 @@
+/* FluidSynth - A Software Synthesizer
+ *
+ * Copyright (C) 2003  Peter Hanappe and others.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA
+ */
+
+#include "fluid_trace.h"
+#include "fluid_sys.h"
+
+
+/**
+ * Create a trace buffer.
+ * @param size Count of records the buffer holds until they are read
+ * @return New trace buffer or NULL if out of memory (error message logged)
+ */
+fluid_trace_t *
+new_fluid_trace(int size)
+{
+    fluid_trace_t *trace;
+
+    fluid_return_val_if_fail(size > 0, NULL);
+
+    trace = FLUID_NEW(fluid_trace_t);
+
+    if(trace == NULL)
+    {
+        FLUID_LOG(FLUID_ERR, "Out of memory");
+        return NULL;
+    }
+
+    trace->queue = new_fluid_ringbuffer(size, sizeof(fluid_trace_record_t));
+
+    if(trace->queue == NULL)
+    {
+        FLUID_FREE(trace);
+        return NULL;
+    }
+
+    fluid_atomic_int_set(&trace->dropped, 0);
+
+    return trace;
+}
+
+/**
+ * Free a trace buffer.
+ * @param trace Trace buffer
+ *
+ * Neither the synthesis thread nor the reader may access it any longer.
+ */
+void
+delete_fluid_trace(fluid_trace_t *trace)
+{
+    fluid_return_if_fail(trace != NULL);
+    delete_fluid_ringbuffer(trace->queue);
+    FLUID_FREE(trace);
+}
+
+/**
+ * Pop records from a trace buffer, called by the (single) reader thread.
+ * @param trace Trace buffer
+ * @param records Array to store the records to, oldest first
+ * @param count Length of 'records'
+ * @param dropped Set to the count of records dropped since the last read, may be NULL
+ * @return Count of records stored
+ */
+int
+fluid_trace_read(fluid_trace_t *trace, fluid_trace_record_t *records, int count,
+                 unsigned int *dropped)
+{
+    int i, n = fluid_ringbuffer_get_outcount(trace->queue);
+
+    if(n > count)
+    {
+        n = count;
+    }
+
+    for(i = 0; i < n; i++)
+    {
+        records[i] = *(fluid_trace_record_t *)fluid_ringbuffer_get_outptr_at(trace->queue, i);
+    }
+
+    fluid_ringbuffer_next_outptrs(trace->queue, n);
+
+    if(dropped != NULL)
+    {
+        int d = fluid_atomic_int_get(&trace->dropped);
+        fluid_atomic_int_add(&trace->dropped, -d);
+        *dropped = d;
+    }
+
+    return n;
+}
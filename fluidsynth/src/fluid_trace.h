@@ -0,0 +1,83 @@
+/* FluidSynth - A Software Synthesizer
+ *
+ * Copyright (C) 2003  Peter Hanappe and others.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA
+ */
+
+#ifndef _FLUID_TRACE_H
+#define _FLUID_TRACE_H
+
+#include "fluid_ringbuffer.h"
+
+/*
+ * Trace of the synthesis thread: fixed-size records are pushed into a
+ * lockless queue by the thread that dispatches MIDI and renders, and popped
+ * by fluid_synth_read_trace() in another thread. Records that don't fit are
+ * counted and dropped, the synthesis thread never waits.
+ */
+typedef struct _fluid_trace_t
+{
+    fluid_ringbuffer_t *queue;
+    fluid_atomic_int_t dropped; /**< Records lost since the last read */
+} fluid_trace_t;
+
+fluid_trace_t *new_fluid_trace(int size);
+void delete_fluid_trace(fluid_trace_t *trace);
+int fluid_trace_read(fluid_trace_t *trace, fluid_trace_record_t *records, int count,
+                     unsigned int *dropped);
+
+/* Adds a record, a no-op if tracing is disabled ('trace' is NULL) */
+static FLUID_INLINE void
+fluid_trace_add(fluid_trace_t *trace, int type, int chan, int arg,
+                uint64_t start, uint64_t end)
+{
+    fluid_trace_record_t *record;
+
+    if(trace == NULL)
+    {
+        return;
+    }
+
+    record = fluid_ringbuffer_get_inptr(trace->queue, 0);
+
+    if(record == NULL)
+    {
+        fluid_atomic_int_inc(&trace->dropped);
+        return;
+    }
+
+    record->start = start;
+    record->end = end;
+    record->type = type;
+    record->chan = chan;
+    record->arg = arg;
+
+    fluid_ringbuffer_next_inptr(trace->queue, 1);
+}
+
+/* Adds a record of something that happened now */
+static FLUID_INLINE void
+fluid_trace_mark(fluid_trace_t *trace, int type, int chan, int arg)
+{
+    if(trace != NULL)
+    {
+        uint64_t now = fluid_cycles();
+        fluid_trace_add(trace, type, chan, arg, now, now);
+    }
+}
+
+#endif /* _FLUID_TRACE_H */
@@ -86,7 +86,7 @@ fluid_voice_get_lower_boundary_for_attenuation(fluid_voice_t *voice);
 #define UPDATE_RVOICE_R1(proc, arg1) UPDATE_RVOICE_GENERIC_R1(proc, voice->rvoice, arg1)
 #define UPDATE_RVOICE_I1(proc, arg1) UPDATE_RVOICE_GENERIC_I1(proc, voice->rvoice, arg1)
 
-#define UPDATE_RVOICE_BUFFERS_AMP(proc, iarg, rarg) UPDATE_RVOICE_GENERIC_IR(proc, &voice->rvoice->buffers, iarg, rarg)
+#define UPDATE_RVOICE_BUFFERS_AMP(proc, iarg, rarg) UPDATE_RVOICE_GENERIC_IR(proc, &voice->rvoice->cold->buffers, iarg, rarg)
 #define UPDATE_RVOICE_ENVLFO_R1(proc, envp, rarg) UPDATE_RVOICE_GENERIC_R1(proc, &voice->rvoice->envlfo.envp, rarg)
 #define UPDATE_RVOICE_ENVLFO_I1(proc, envp, iarg) UPDATE_RVOICE_GENERIC_I1(proc, &voice->rvoice->envlfo.envp, iarg)
 
@@ -179,8 +179,11 @@ static void fluid_voice_swap_rvoice(fluid_voice_t *voice)
 static void fluid_voice_initialize_rvoice(fluid_voice_t *voice, fluid_real_t output_rate)
 {
     fluid_rvoice_param_t param[MAX_EVENT_PARAMS];
+    fluid_rvoice_cold_t *cold = voice->rvoice->cold;
 
     FLUID_MEMSET(voice->rvoice, 0, sizeof(fluid_rvoice_t));
+    FLUID_MEMSET(cold, 0, sizeof(fluid_rvoice_cold_t));
+    voice->rvoice->cold = cold;
 
     /* The 'sustain' and 'finished' segments of the volume / modulation
      * envelope are constant. They are never affected by any modulator
@@ -201,7 +204,7 @@ static void fluid_voice_initialize_rvoice(fluid_voice_t *voice, fluid_real_t out
     fluid_iir_filter_init(&voice->rvoice->resonant_filter, param);
 
     param[0].i = FLUID_IIR_DISABLED;
-    fluid_iir_filter_init(&voice->rvoice->resonant_custom_filter, param);
+    fluid_iir_filter_init(&voice->rvoice->cold->resonant_custom_filter, param);
 
     param[0].real = output_rate;
     fluid_rvoice_set_output_rate(voice->rvoice, param);
@@ -211,7 +214,8 @@ static void fluid_voice_initialize_rvoice(fluid_voice_t *voice, fluid_real_t out
  * new_fluid_voice
  */
 fluid_voice_t *
-new_fluid_voice(fluid_rvoice_eventhandler_t *handler, fluid_real_t output_rate)
+new_fluid_voice(fluid_rvoice_eventhandler_t *handler, fluid_rvoice_arena_t *arena,
+                fluid_real_t output_rate)
 {
     fluid_voice_t *voice;
     voice = FLUID_NEW(fluid_voice_t);
@@ -222,11 +226,14 @@ new_fluid_voice(fluid_rvoice_eventhandler_t *handler, fluid_real_t output_rate)
         return NULL;
     }
 
+    fluid_memory_account(FLUID_MEMORY_VOICES, sizeof(fluid_voice_t));
+
     voice->can_access_rvoice = TRUE;
     voice->can_access_overflow_rvoice = TRUE;
 
-    voice->rvoice = FLUID_NEW(fluid_rvoice_t);
-    voice->overflow_rvoice = FLUID_NEW(fluid_rvoice_t);
+    /* the rvoices are owned by the arena */
+    voice->rvoice = fluid_rvoice_arena_alloc(arena);
+    voice->overflow_rvoice = fluid_rvoice_arena_alloc(arena);
 
     if(voice->rvoice == NULL || voice->overflow_rvoice == NULL)
     {
@@ -265,8 +272,7 @@ delete_fluid_voice(fluid_voice_t *voice)
         FLUID_LOG(FLUID_WARN, "Deleting voice %u which has locked rvoices!", voice->id);
     }
 
-    FLUID_FREE(voice->overflow_rvoice);
-    FLUID_FREE(voice->rvoice);
+    fluid_memory_account(FLUID_MEMORY_VOICES, -(ptrdiff_t)sizeof(fluid_voice_t));
     FLUID_FREE(voice);
 }
 
@@ -288,6 +294,8 @@ fluid_voice_init(fluid_voice_t *voice, fluid_sample_t *sample,
      * generators have been retrieved from the sound font. Here, only
      * the 'working memory' of the voice (position in envelopes, history
      * of IIR filters, position in sample etc) is initialized. */
+    fluid_rvoice_param_t param[MAX_EVENT_PARAMS];
+    fluid_preset_t *preset;
     int i;
 
     if(!voice->can_access_rvoice)
@@ -329,8 +337,9 @@ fluid_voice_init(fluid_voice_t *voice, fluid_sample_t *sample,
     fluid_sample_incr_ref(sample);
     voice->sample = sample;
 
-    i = fluid_channel_get_interp_method(channel);
-    UPDATE_RVOICE_I1(fluid_rvoice_set_interp_method, i);
+    param[0].i = fluid_channel_get_interp_method(channel);
+    param[1].ptr = channel->synth->sinc_table;
+    fluid_rvoice_eventhandler_push(voice->eventhandler, fluid_rvoice_set_interp_method, voice->rvoice, param);
 
     /* Set all the generators to their default value, according to SF
      * 2.01 section 8.1.3 (page 48). The value of NRPN messages are
@@ -354,12 +363,16 @@ fluid_voice_init(fluid_voice_t *voice, fluid_sample_t *sample,
     /* Set up buffer mapping, should be done more flexible in the future. */
     i = 2 * channel->synth->audio_groups;
     i += (voice->chan % channel->synth->effects_groups) * channel->synth->effects_channels;
-    UPDATE_RVOICE_GENERIC_I2(fluid_rvoice_buffers_set_mapping, &voice->rvoice->buffers, 2, i + SYNTH_REVERB_CHANNEL);
-    UPDATE_RVOICE_GENERIC_I2(fluid_rvoice_buffers_set_mapping, &voice->rvoice->buffers, 3, i + SYNTH_CHORUS_CHANNEL);
+    UPDATE_RVOICE_GENERIC_I2(fluid_rvoice_buffers_set_mapping, &voice->rvoice->cold->buffers, 2, i + SYNTH_REVERB_CHANNEL);
+    UPDATE_RVOICE_GENERIC_I2(fluid_rvoice_buffers_set_mapping, &voice->rvoice->cold->buffers, 3, i + SYNTH_CHORUS_CHANNEL);
 
     i = 2 * (voice->chan % channel->synth->audio_groups);
-    UPDATE_RVOICE_GENERIC_I2(fluid_rvoice_buffers_set_mapping, &voice->rvoice->buffers, 0, i);
-    UPDATE_RVOICE_GENERIC_I2(fluid_rvoice_buffers_set_mapping, &voice->rvoice->buffers, 1, i + 1);
+    UPDATE_RVOICE_GENERIC_I2(fluid_rvoice_buffers_set_mapping, &voice->rvoice->cold->buffers, 0, i);
+    UPDATE_RVOICE_GENERIC_I2(fluid_rvoice_buffers_set_mapping, &voice->rvoice->cold->buffers, 1, i + 1);
+
+    preset = fluid_channel_get_preset(channel);
+    UPDATE_RVOICE_GENERIC_I2(fluid_rvoice_set_owner, voice->rvoice, voice->chan,
+                             preset ? (fluid_preset_get_banknum(preset) << 7) | fluid_preset_get_num(preset) : -1);
 
     return FLUID_OK;
 }
@@ -862,11 +875,11 @@ fluid_voice_update_param(fluid_voice_t *voice, int gen)
 
     /* same as the two above, only for the custom filter */
     case GEN_CUSTOM_FILTERFC:
-        UPDATE_RVOICE_GENERIC_R1(fluid_iir_filter_set_fres, &voice->rvoice->resonant_custom_filter, x);
+        UPDATE_RVOICE_GENERIC_R1(fluid_iir_filter_set_fres, &voice->rvoice->cold->resonant_custom_filter, x);
         break;
 
     case GEN_CUSTOM_FILTERQ:
-        UPDATE_RVOICE_GENERIC_R1(fluid_iir_filter_set_q, &voice->rvoice->resonant_custom_filter, x);
+        UPDATE_RVOICE_GENERIC_R1(fluid_iir_filter_set_q, &voice->rvoice->cold->resonant_custom_filter, x);
         break;
 
     case GEN_MODLFOTOPITCH:
@@ -1575,6 +1588,20 @@ int fluid_voice_is_playing(const fluid_voice_t *voice)
 
 }
 
+/*
+ * Rough estimate of the current linear amplitude of a voice past its attack
+ * phase, from its volume envelope and attenuation (see
+ * fluid_rvoice_calc_amp()). Only meant for heuristics like voice culling,
+ * it reads the rvoice without synchronization.
+ */
+fluid_real_t
+fluid_voice_get_amplitude(const fluid_voice_t *voice)
+{
+    fluid_real_t env_val = fluid_adsr_env_get_val(&voice->rvoice->envlfo.volenv);
+
+    return fluid_cb2amp(voice->attenuation) * fluid_cb2amp(FLUID_PEAK_ATTENUATION * (1.0f - env_val));
+}
+
 /**
  * Check if a voice is ON. A voice is ON, if it has not yet received a noteoff event.
  * @param voice Voice instance
@@ -1987,6 +2014,6 @@ fluid_voice_get_overflow_prio(fluid_voice_t *voice,
 
 void fluid_voice_set_custom_filter(fluid_voice_t *voice, enum fluid_iir_filter_type type, enum fluid_iir_filter_flags flags)
 {
-    UPDATE_RVOICE_GENERIC_I2(fluid_iir_filter_init, &voice->rvoice->resonant_custom_filter, type, flags);
+    UPDATE_RVOICE_GENERIC_I2(fluid_iir_filter_init, &voice->rvoice->cold->resonant_custom_filter, type, flags);
 }
 
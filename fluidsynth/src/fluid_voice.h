@@ -115,7 +115,8 @@ struct _fluid_voice_t
 };
 
 
-fluid_voice_t *new_fluid_voice(fluid_rvoice_eventhandler_t *handler, fluid_real_t output_rate);
+fluid_voice_t *new_fluid_voice(fluid_rvoice_eventhandler_t *handler, fluid_rvoice_arena_t *arena,
+                               fluid_real_t output_rate);
 void delete_fluid_voice(fluid_voice_t *voice);
 
 void fluid_voice_start(fluid_voice_t *voice);
@@ -160,6 +161,7 @@ void fluid_voice_add_mod_local(fluid_voice_t *voice, fluid_mod_t *mod, int mode,
 void fluid_voice_overflow_rvoice_finished(fluid_voice_t *voice);
 
 int fluid_voice_kill_excl(fluid_voice_t *voice);
+fluid_real_t fluid_voice_get_amplitude(const fluid_voice_t *voice);
 float fluid_voice_get_overflow_prio(fluid_voice_t *voice,
                                     fluid_overflow_prio_t *score,
                                     unsigned int cur_time);
@@ -45,6 +45,8 @@
 #include <string.h>
 #endif
 
+#include <stddef.h> // ptrdiff_t
+
 
 #include "fluidsynth.h"
 
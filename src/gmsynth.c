@@ -24,13 +24,23 @@
 #include <pthread.h>
 #include <stdlib.h>
 #include <math.h>
+#include <time.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#ifdef WITH_RTCHECK
+#include <execinfo.h>
+#endif
 
 #define GFS_URN "http://gareus.org/oss/lv2/gmsynth"
 
 #ifdef HAVE_LV2_1_18_6
 #include <lv2/atom/atom.h>
+#include <lv2/atom/forge.h>
 #include <lv2/atom/util.h>
 #include <lv2/core/lv2.h>
 #include <lv2/log/logger.h>
@@ -39,6 +49,7 @@
 #else
 #include <lv2/lv2plug.in/ns/lv2core/lv2.h>
 #include <lv2/lv2plug.in/ns/ext/atom/atom.h>
+#include <lv2/lv2plug.in/ns/ext/atom/forge.h>
 #include <lv2/lv2plug.in/ns/ext/atom/util.h>
 #include <lv2/lv2plug.in/ns/ext/log/logger.h>
 #include <lv2/lv2plug.in/ns/ext/midi/midi.h>
@@ -47,9 +58,15 @@
 
 #include "midnam_lv2.h"
 #include "bankpatch_lv2.h"
+#include "gmsynth_stats_lv2.h"
+#include "gmsynth_rtcheck.h"
 
 #include "fluidsynth.h"
 
+#ifndef HAVE_LV2_1_8
+#define lv2_atom_forge_object(forge, frame, id, otype) lv2_atom_forge_blank (forge, frame, id, otype)
+#endif
+
 #ifdef _WIN32
 #define PATH_SEP "\\"
 #else
@@ -60,6 +77,10 @@ enum {
 	GFS_PORT_CONTROL = 0,
 	GFS_PORT_OUT_L,
 	GFS_PORT_OUT_R,
+	GFS_PORT_FREEWHEEL,
+	GFS_PORT_NOTIFY,
+	GFS_PORT_DEADLINE,
+	GFS_PORT_COSTS,
 	GFS_PORT_LAST
 };
 
@@ -68,6 +89,49 @@ enum {
 	CMD_FREE     = 1,
 };
 
+/* voices allocated once in instantiate (), the governor only caps them */
+#define POLYPHONY 256
+
+/* load governor: rendering quality steps, from best to cheapest */
+static const struct {
+	int interp;
+	int voice_cap;
+} gov_steps[] = {
+	{ FLUID_INTERP_DEFAULT, POLYPHONY },
+	{ FLUID_INTERP_LINEAR,  POLYPHONY },
+	{ FLUID_INTERP_LINEAR,  160 },
+	{ FLUID_INTERP_NONE,     96 },
+	{ FLUID_INTERP_NONE,     48 },
+};
+
+#define GOV_STEPS (sizeof (gov_steps) / sizeof (gov_steps[0]))
+#define GOV_LOAD_HIGH   60.f   // render time in % of the period: degrade above
+#define GOV_LOAD_LOW    25.f   // restore quality below
+#define GOV_CULL_LEVEL  .001f  // -60dBFS, released voices below this are stopped
+#define GOV_SETTLE_TIME .1     // seconds between two steps down
+#define GOV_RECOVER_TIME 2.    // seconds of low load before stepping up
+
+/* MIDI events queued per call to fluid_synth_write_float_midi () */
+#define MAX_MIDI_EVENTS 1024
+
+/* seconds between two reports of the rendering stage counters */
+#define PROF_INTERVAL 1.
+
+/* render time histogram: duration of run () as fraction of the period,
+ * in log-spaced bins starting at 2^HIST_MIN_LOG2 (~0.1%) */
+#define HIST_BINS_PER_OCTAVE 4
+#define HIST_MIN_LOG2        (-10)
+#define HIST_BINS            (12 * HIST_BINS_PER_OCTAVE) // up to 400%, the last bin collects all above
+#define HIST_DEADLINE        .8f  // default fraction of the period counted as deadline miss
+
+/* interpolation used while the host is freewheeling (offline bounce) */
+#define OFFLINE_INTERP FLUID_INTERP_SINC
+
+/* Chrome trace export, enabled by setting GMSYNTH_TRACE to a directory */
+#define TRACE_RECORDS  65536  // records buffered between two writes
+#define TRACE_INTERVAL 50000  // microseconds between two writes
+#define TRACE_BATCH    1024   // records read at once
+
 struct Program {
 	char* name;
 	int program;
@@ -162,6 +226,7 @@ is_drum_program (int bank, uint8_t pgm)
 typedef struct {
 	/* ports */
 	const LV2_Atom_Sequence* control;
+	LV2_Atom_Sequence*       notify;
 
 	float* p_ports[GFS_PORT_LAST];
 
@@ -172,6 +237,18 @@ typedef struct {
 
 	/* LV2 URID */
 	LV2_URID midi_MidiEvent;
+	LV2_URID gfs_Profile;
+	LV2_URID gfs_frames;
+	LV2_URID gfs_passes;
+	LV2_URID gfs_cycles;
+	LV2_URID gfs_maxCycles;
+	LV2_URID gfs_renderLoad;
+	LV2_URID gfs_deadlineMisses;
+	LV2_URID gfs_channelShare;
+	LV2_URID gfs_channelPeakVoices;
+	LV2_URID gfs_channelProgram;
+
+	LV2_Atom_Forge forge;
 
 	/* LV2 extensions */
 	LV2_Log_Log*         log;
@@ -188,24 +265,91 @@ typedef struct {
 	/* state */
 	bool panic;
 	bool send_bankpgm;
+	bool freewheel;
 
 	uint8_t last_bank_lsb[16];
 	uint8_t last_bank_msb[16];
 	uint8_t last_program[16];
 	bool    is_drums[16];
 
-	fluid_midi_event_t* fmidi_event;
+	/* MIDI events of the current run () cycle */
+	fluid_midi_raw_event_t midi_events[MAX_MIDI_EVENTS];
+	uint32_t               n_midi_events;
+
+	/* load governor */
+	double   rate;
+	uint32_t gov_step;
+	uint32_t gov_settle;
+	uint32_t gov_recover;
+
+	/* rendering stage counters */
+	uint32_t prof_frames;
+	bool     cost_accounting; // per channel costs, enabled by GFS_PORT_COSTS
+
+	/* render time histogram, written by run (), read from any thread */
+	uint32_t hist_bins[HIST_BINS];
+	uint32_t hist_misses;
+	uint32_t hist_max;   // longest run, in millionths of the period
+	int      hist_reset; // set by stats_reset (), cleared by run ()
 
+#ifdef WITH_RTCHECK
+	RTCheck rtcheck;
+#endif
+
+	/* Chrome trace export, NULL unless enabled */
+	struct Trace* trace;
+
+	/* time and memory taken by instantiate () */
+	GMSynth_Startup_Stats startup;
 } GFSSynth;
 
 /* *****************************************************************************
  * helpers
  */
 
+static double
+mono_us (void)
+{
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+/* milliseconds since *t, which is set to now */
+static float
+lap_ms (double* t)
+{
+	const double now = mono_us ();
+	const float  ms  = (now - *t) * 1e-3;
+	*t = now;
+	return ms;
+}
+
+/* peak resident set size of the process in KiB, or -1 */
+static long
+peak_rss_kib (void)
+{
+#ifdef _WIN32
+	return -1;
+#else
+	struct rusage ru;
+	if (getrusage (RUSAGE_SELF, &ru)) {
+		return -1;
+	}
+#ifdef __APPLE__
+	return ru.ru_maxrss / 1024;
+#else
+	return ru.ru_maxrss;
+#endif
+#endif
+}
+
 static bool
 load_sf2 (GFSSynth* self, const char* fn)
 {
+	double    t        = mono_us ();
 	const int synth_id = fluid_synth_sfload (self->synth, fn, 1);
+	self->startup.sfload = lap_ms (&t);
 
 	pthread_mutex_lock (&self->bp_lock);
 	clear_banks (self->presets);
@@ -253,9 +397,62 @@ load_sf2 (GFSSynth* self, const char* fn)
 		return false;
 	}
 
+	self->startup.presets = lap_ms (&t);
 	return true;
 }
 
+static void
+set_gov_step (GFSSynth* self, uint32_t step)
+{
+	self->gov_step = step;
+	fluid_synth_set_interp_method (self->synth, -1, gov_steps[step].interp);
+	fluid_synth_set_voice_cap (self->synth, gov_steps[step].voice_cap);
+}
+
+/* Track the render time of the synth (averaged by fluidsynth itself)
+ * against the period. Under pressure, stop inaudible released voices and
+ * step down interpolation and the voice cap, one step per settle time.
+ * Quality is restored step by step once the load stayed low for a while.
+ */
+static void
+governor (GFSSynth* self, uint32_t n_samples)
+{
+	const double load = fluid_synth_get_cpu_load (self->synth);
+
+	self->gov_settle = self->gov_settle > n_samples ? self->gov_settle - n_samples : 0;
+
+	if (load > GOV_LOAD_HIGH) {
+		fluid_synth_stop_quiet_voices (self->synth, GOV_CULL_LEVEL, -1);
+		self->gov_recover = 0;
+		if (self->gov_settle == 0 && self->gov_step + 1 < GOV_STEPS) {
+			set_gov_step (self, self->gov_step + 1);
+			self->gov_settle = self->rate * GOV_SETTLE_TIME;
+		}
+	} else if (load < GOV_LOAD_LOW && self->gov_step > 0) {
+		self->gov_recover += n_samples;
+		if (self->gov_recover > self->rate * GOV_RECOVER_TIME) {
+			set_gov_step (self, self->gov_step - 1);
+			self->gov_recover = 0;
+		}
+	} else {
+		self->gov_recover = 0;
+	}
+}
+
+static void
+set_offline (GFSSynth* self, bool offline)
+{
+	self->freewheel = offline;
+	if (offline) {
+		/* no deadline: all voices, best interpolation on every channel */
+		self->gov_step = 0;
+		fluid_synth_set_interp_method (self->synth, -1, OFFLINE_INTERP);
+		fluid_synth_set_voice_cap (self->synth, POLYPHONY);
+	} else {
+		set_gov_step (self, 0);
+	}
+}
+
 static int file_exists (const char *filename) {
 	struct stat s;
 	if (!filename || strlen(filename) < 1) return 0;
@@ -265,6 +462,181 @@ static int file_exists (const char *filename) {
 	return 0;
 }
 
+/* *****************************************************************************
+ * Chrome trace export
+ *
+ * The synth records rendering stages, MIDI events and voice changes into a
+ * lock-free buffer (fluid_synth_set_tracing). A background thread drains it
+ * and writes the records in Chrome's trace event format, which can be
+ * loaded by chrome://tracing and Perfetto.
+ */
+
+struct Trace {
+	fluid_synth_t* synth;
+	FILE*          f;
+	pthread_t      thread;
+	int            run; // atomic, cleared to stop the thread
+	int            pid;
+	int            tid; // instance number
+
+	/* time stamps of the synth are converted to CLOCK_MONOTONIC */
+	unsigned long long c0;
+	double             t0; // microseconds
+	double             us_per_cycle;
+};
+
+static const char* trace_stage_names[] = {
+	"write", "blocks", "clear", "voices", "filter", "reverb", "chorus"
+};
+
+static const char*
+trace_midi_name (uint8_t status)
+{
+	switch (status & 0xf0) {
+		case 0x80: return "note-off";
+		case 0x90: return "note-on";
+		case 0xa0: return "key-pressure";
+		case 0xb0: return "control";
+		case 0xc0: return "program";
+		case 0xd0: return "channel-pressure";
+		case 0xe0: return "pitch-bend";
+		default:   return "system";
+	}
+}
+
+static void
+trace_write (struct Trace* tr, const fluid_trace_record_t* r)
+{
+	const double ts = tr->t0 + (double)(long long)(r->start - tr->c0) * tr->us_per_cycle;
+
+	switch (r->type) {
+		case FLUID_TRACE_STAGE:
+			if (r->arg < 0 || r->arg >= (int)(sizeof (trace_stage_names) / sizeof (trace_stage_names[0]))) {
+				return;
+			}
+			fprintf (tr->f, ",\n{\"name\":\"%s\",\"cat\":\"stage\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+			         trace_stage_names[r->arg], ts, (r->end - r->start) * tr->us_per_cycle, tr->pid, tr->tid);
+			break;
+		case FLUID_TRACE_EVENT:
+			fprintf (tr->f, ",\n{\"name\":\"%s\",\"cat\":\"midi\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+			         "\"args\":{\"chan\":%d,\"data\":[%d,%d,%d]}}",
+			         trace_midi_name (r->arg & 0xff), ts, tr->pid, tr->tid,
+			         r->chan, r->arg & 0xff, (r->arg >> 8) & 0xff, (r->arg >> 16) & 0xff);
+			break;
+		case FLUID_TRACE_VOICE_START:
+		case FLUID_TRACE_VOICE_STEAL:
+			fprintf (tr->f, ",\n{\"name\":\"%s\",\"cat\":\"voice\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+			         "\"args\":{\"chan\":%d,\"key\":%d}}",
+			         r->type == FLUID_TRACE_VOICE_START ? "voice start" : "voice steal", ts, tr->pid, tr->tid, r->chan, r->arg);
+			break;
+		case FLUID_TRACE_VOICE_STOP:
+			fprintf (tr->f, ",\n{\"name\":\"voice stop\",\"cat\":\"voice\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+			         "\"args\":{\"chan\":%d}}",
+			         ts, tr->pid, tr->tid, r->chan);
+			break;
+		default:
+			break;
+	}
+}
+
+static void
+trace_drain (struct Trace* tr)
+{
+	fluid_trace_record_t records[TRACE_BATCH];
+	unsigned int         dropped;
+	int                  n;
+
+	/* microseconds per cycle, averaged over the whole trace */
+	const unsigned long long c = fluid_synth_get_cycles ();
+	const double             t = mono_us ();
+	if (c > tr->c0 && t > tr->t0) {
+		tr->us_per_cycle = (t - tr->t0) / (double)(c - tr->c0);
+	}
+
+	do {
+		n = fluid_synth_read_trace (tr->synth, records, TRACE_BATCH, &dropped);
+		if (dropped > 0) {
+			fprintf (tr->f, ",\n{\"name\":\"dropped\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"records\":%u}}",
+			         mono_us (), tr->pid, tr->tid, dropped);
+		}
+		for (int i = 0; i < n; ++i) {
+			trace_write (tr, &records[i]);
+		}
+	} while (n == TRACE_BATCH);
+
+	fflush (tr->f);
+}
+
+static void*
+trace_thread (void* arg)
+{
+	struct Trace* tr = (struct Trace*)arg;
+	while (__atomic_load_n (&tr->run, __ATOMIC_ACQUIRE)) {
+		usleep (TRACE_INTERVAL);
+		trace_drain (tr);
+	}
+	return NULL;
+}
+
+static struct Trace*
+trace_start (GFSSynth* self, const char* dir)
+{
+	static int instance_count = 0;
+
+	struct Trace* tr = (struct Trace*)calloc (1, sizeof (struct Trace));
+	if (!tr) {
+		return NULL;
+	}
+
+	tr->synth = self->synth;
+	tr->pid   = getpid ();
+	tr->tid   = __atomic_add_fetch (&instance_count, 1, __ATOMIC_RELAXED);
+
+	char path[1024];
+	snprintf (path, sizeof (path), "%s" PATH_SEP "gmsynth-%d-%d.json", dir, tr->pid, tr->tid);
+	tr->f = fopen (path, "w");
+
+	if (!tr->f || fluid_synth_set_tracing (self->synth, TRACE_RECORDS) != FLUID_OK) {
+		lv2_log_error (&self->logger, "gmsynth.lv2: cannot trace to '%s'\n", path);
+		if (tr->f) {
+			fclose (tr->f);
+		}
+		free (tr);
+		return NULL;
+	}
+
+	/* reference of the clock conversion, the rate is measured by every
+	 * drain, the first one TRACE_INTERVAL later */
+	tr->c0 = fluid_synth_get_cycles ();
+	tr->t0 = mono_us ();
+
+	fprintf (tr->f, "[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"gmsynth #%d\"}}",
+	         tr->pid, tr->tid, tr->tid);
+
+	tr->run = 1;
+	if (pthread_create (&tr->thread, NULL, trace_thread, tr)) {
+		fluid_synth_set_tracing (self->synth, 0);
+		fclose (tr->f);
+		free (tr);
+		return NULL;
+	}
+
+	lv2_log_note (&self->logger, "gmsynth.lv2: tracing to '%s'\n", path);
+	return tr;
+}
+
+static void
+trace_stop (struct Trace* tr)
+{
+	__atomic_store_n (&tr->run, 0, __ATOMIC_RELEASE);
+	pthread_join (tr->thread, NULL);
+	trace_drain (tr);
+	fprintf (tr->f, "\n]\n");
+	fclose (tr->f);
+	fluid_synth_set_tracing (tr->synth, 0);
+	free (tr);
+}
+
 /* *****************************************************************************
  * LV2 Plugin
  */
@@ -275,6 +647,11 @@ instantiate (const LV2_Descriptor*     descriptor,
              const char*               bundle_path,
              const LV2_Feature* const* features)
 {
+	double         t_start  = mono_us ();
+	double         t        = t_start;
+	const uint32_t n_alloc  = fluid_get_alloc_count ();
+	const long     peak_rss = peak_rss_kib ();
+
 	GFSSynth* self = (GFSSynth*)calloc (1, sizeof (GFSSynth));
 
 	if (!self || !bundle_path) {
@@ -326,6 +703,9 @@ instantiate (const LV2_Descriptor*     descriptor,
 	fluid_settings_setint (self->settings, "synth.threadsafe-api", 0);
 	fluid_settings_setstr (self->settings, "synth.midi-bank-select", "mma");
 	fluid_settings_setint (self->settings, "synth.audio-channels", 1); // stereo pairs
+	fluid_settings_setint (self->settings, "synth.polyphony", POLYPHONY);
+
+	self->startup.settings = lap_ms (&t);
 
 	self->synth = new_fluid_synth (self->settings);
 
@@ -337,27 +717,32 @@ instantiate (const LV2_Descriptor*     descriptor,
 	}
 
 	fluid_synth_set_gain (self->synth, 1.0f);
-	fluid_synth_set_polyphony (self->synth, 256);
 	fluid_synth_set_sample_rate (self->synth, (float)rate);
 
-	self->fmidi_event = new_fluid_midi_event ();
-
-	if (!self->fmidi_event) {
-		lv2_log_error (&self->logger, "gmsynth.lv2: cannot allocate Fluid Event\n");
-		delete_fluid_synth (self->synth);
-		delete_fluid_settings (self->settings);
-		free (self);
-		return NULL;
-	}
+	self->startup.synth = lap_ms (&t);
 
 	/* initialize plugin state */
 
+	rtcheck_init ();
 	pthread_mutex_init (&self->bp_lock, NULL);
 	self->presets = calloc (1, sizeof (struct Bank));
 	self->midi_MidiEvent = map->map (map->handle, LV2_MIDI__MidiEvent);
+	self->gfs_Profile    = map->map (map->handle, GFS_URN "#Profile");
+	self->gfs_frames     = map->map (map->handle, GFS_URN "#frames");
+	self->gfs_passes     = map->map (map->handle, GFS_URN "#passes");
+	self->gfs_cycles     = map->map (map->handle, GFS_URN "#cycles");
+	self->gfs_maxCycles  = map->map (map->handle, GFS_URN "#maxCycles");
+	self->gfs_renderLoad = map->map (map->handle, GFS_URN "#renderLoad");
+	self->gfs_deadlineMisses = map->map (map->handle, GFS_URN "#deadlineMisses");
+	self->gfs_channelShare      = map->map (map->handle, GFS_URN "#channelShare");
+	self->gfs_channelPeakVoices = map->map (map->handle, GFS_URN "#channelPeakVoices");
+	self->gfs_channelProgram    = map->map (map->handle, GFS_URN "#channelProgram");
+
+	lv2_atom_forge_init (&self->forge, map);
 
 	self->panic = false;
 	self->send_bankpgm = true;
+	self->rate = rate;
 
 	for (uint8_t chn = 0; chn < 16; ++chn) {
 		self->last_program[chn] = 255;
@@ -371,7 +756,9 @@ instantiate (const LV2_Descriptor*     descriptor,
 		self->panic = false;
 		/* boostrap synth engine. */
 		float b[1024];
+		t = mono_us ();
 		fluid_synth_write_float (self->synth, 1024, b, 0, 1, b, 0, 1);
+		self->startup.bootstrap = lap_ms (&t);
 	} else {
 		lv2_log_error (&self->logger, "gmsynth.lv2: cannot load SoundFont\n");
 		delete_fluid_synth (self->synth);
@@ -381,6 +768,19 @@ instantiate (const LV2_Descriptor*     descriptor,
 		return NULL;
 	}
 
+	self->startup.total        = lap_ms (&t_start);
+	self->startup.allocations  = fluid_get_alloc_count () - n_alloc;
+	self->startup.peak_rss_kib = peak_rss < 0 ? -1 : peak_rss_kib () - peak_rss;
+
+	lv2_log_trace (&self->logger, "gmsynth.lv2: instantiate %.1f ms: settings %.1f, synth %.1f, sfload %.1f, presets %.1f, bootstrap %.1f; %u allocations, peak RSS +%d KiB\n",
+	               self->startup.total, self->startup.settings, self->startup.synth, self->startup.sfload,
+	               self->startup.presets, self->startup.bootstrap, self->startup.allocations, self->startup.peak_rss_kib);
+
+	const char* trace_dir = getenv ("GMSYNTH_TRACE");
+	if (trace_dir && *trace_dir) {
+		self->trace = trace_start (self, trace_dir);
+	}
+
 	return (LV2_Handle)self;
 }
 
@@ -395,6 +795,9 @@ connect_port (LV2_Handle instance,
 		case GFS_PORT_CONTROL:
 			self->control = (const LV2_Atom_Sequence*)data;
 			break;
+		case GFS_PORT_NOTIFY:
+			self->notify = (LV2_Atom_Sequence*)data;
+			break;
 		default:
 			if (port < GFS_PORT_LAST) {
 				self->p_ports[port] = (float*)data;
@@ -410,6 +813,167 @@ deactivate (LV2_Handle instance)
 	self->panic = true;
 }
 
+/* synthesize n_samples starting at offset, applying the queued MIDI events */
+static void
+render (GFSSynth* self, uint32_t offset, uint32_t n_samples)
+{
+	fluid_synth_write_float_midi (
+			self->synth, n_samples,
+			self->midi_events, self->n_midi_events,
+			&self->p_ports[GFS_PORT_OUT_L][offset], 0, 1,
+			&self->p_ports[GFS_PORT_OUT_R][offset], 0, 1);
+	self->n_midi_events = 0;
+}
+
+/* Account a run () that took 'elapsed' seconds for n_samples.
+ * Only run () writes the histogram, so plain read-modify-write
+ * suffices; the atomic stores make it safe to read concurrently.
+ */
+static void
+hist_add (GFSSynth* self, double elapsed, uint32_t n_samples)
+{
+	if (__atomic_load_n (&self->hist_reset, __ATOMIC_ACQUIRE)) {
+		__atomic_store_n (&self->hist_reset, 0, __ATOMIC_RELAXED);
+		for (int i = 0; i < HIST_BINS; ++i) {
+			__atomic_store_n (&self->hist_bins[i], 0, __ATOMIC_RELAXED);
+		}
+		__atomic_store_n (&self->hist_misses, 0, __ATOMIC_RELAXED);
+		__atomic_store_n (&self->hist_max, 0, __ATOMIC_RELAXED);
+	}
+
+	if (n_samples == 0) {
+		return;
+	}
+
+	const float deadline = self->p_ports[GFS_PORT_DEADLINE] ? *self->p_ports[GFS_PORT_DEADLINE] : HIST_DEADLINE;
+	const float load     = elapsed * self->rate / n_samples;
+
+	int bin = 0;
+	if (load > 0) {
+		bin = floorf ((log2f (load) - HIST_MIN_LOG2) * HIST_BINS_PER_OCTAVE);
+		bin = bin < 0 ? 0 : bin >= HIST_BINS ? HIST_BINS - 1 : bin;
+	}
+	__atomic_store_n (&self->hist_bins[bin], self->hist_bins[bin] + 1, __ATOMIC_RELAXED);
+
+	if (load > deadline) {
+		__atomic_store_n (&self->hist_misses, self->hist_misses + 1, __ATOMIC_RELAXED);
+	}
+
+	const uint32_t ppm = load < 4000.f ? load * 1e6f : 4e9f;
+	if (ppm > self->hist_max) {
+		__atomic_store_n (&self->hist_max, ppm, __ATOMIC_RELAXED);
+	}
+}
+
+/* upper edge of the bin that holds quantile q, limited to the longest run */
+static float
+hist_percentile (const uint32_t* bins, uint32_t runs, float q, float max)
+{
+	const uint64_t target = ceil (q * runs);
+	uint64_t       sum    = 0;
+
+	for (int i = 0; i < HIST_BINS - 1 && runs > 0; ++i) {
+		sum += bins[i];
+		if (sum >= target) {
+			const float edge = exp2f (HIST_MIN_LOG2 + (i + 1.f) / HIST_BINS_PER_OCTAVE);
+			return edge < max ? edge : max;
+		}
+	}
+	return max;
+}
+
+static void
+hist_stats (GFSSynth* self, GMSynth_Render_Stats* stats)
+{
+	uint32_t bins[HIST_BINS];
+
+	stats->runs = 0;
+	for (int i = 0; i < HIST_BINS; ++i) {
+		bins[i] = __atomic_load_n (&self->hist_bins[i], __ATOMIC_RELAXED);
+		stats->runs += bins[i];
+	}
+
+	stats->deadline_misses = __atomic_load_n (&self->hist_misses, __ATOMIC_RELAXED);
+	stats->max             = __atomic_load_n (&self->hist_max, __ATOMIC_RELAXED) * 1e-6f;
+	stats->p50             = hist_percentile (bins, stats->runs, .5f, stats->max);
+	stats->p99             = hist_percentile (bins, stats->runs, .99f, stats->max);
+	stats->p999            = hist_percentile (bins, stats->runs, .999f, stats->max);
+}
+
+/* Once per PROF_INTERVAL, collect the rendering stage counters of the synth
+ * and publish them on the notify port: the frames rendered in the interval
+ * and per stage (see enum fluid_synth_stage) the passes, total cycles and
+ * the cycles of the longest pass. The render time statistics are appended,
+ * followed, while the channel costs are accounted, per MIDI channel by its
+ * share of the voice rendering cycles, the peak polyphony and the
+ * bank/program (bank * 128 + program, -1 if unknown) of the most recently
+ * started voice.
+ */
+static void
+send_profile (GFSSynth* self, uint32_t n_samples)
+{
+	self->prof_frames += n_samples;
+	if (self->prof_frames < self->rate * PROF_INTERVAL) {
+		return;
+	}
+
+	fluid_stage_stats_t stats[FLUID_SYNTH_STAGE_LAST];
+	const int n_stages = fluid_synth_get_stage_stats (self->synth, stats, FLUID_SYNTH_STAGE_LAST, 1);
+
+	int64_t passes[FLUID_SYNTH_STAGE_LAST];
+	int64_t cycles[FLUID_SYNTH_STAGE_LAST];
+	int64_t max_cycles[FLUID_SYNTH_STAGE_LAST];
+	for (int i = 0; i < n_stages; ++i) {
+		passes[i]     = stats[i].count;
+		cycles[i]     = stats[i].cycles;
+		max_cycles[i] = stats[i].max_cycles;
+	}
+
+	if (self->notify && n_stages > 0) {
+		LV2_Atom_Forge_Frame frame;
+		lv2_atom_forge_frame_time (&self->forge, 0);
+		lv2_atom_forge_object (&self->forge, &frame, 0, self->gfs_Profile);
+		lv2_atom_forge_key (&self->forge, self->gfs_frames);
+		lv2_atom_forge_long (&self->forge, self->prof_frames);
+		lv2_atom_forge_key (&self->forge, self->gfs_passes);
+		lv2_atom_forge_vector (&self->forge, sizeof (int64_t), self->forge.Long, n_stages, passes);
+		lv2_atom_forge_key (&self->forge, self->gfs_cycles);
+		lv2_atom_forge_vector (&self->forge, sizeof (int64_t), self->forge.Long, n_stages, cycles);
+		lv2_atom_forge_key (&self->forge, self->gfs_maxCycles);
+		lv2_atom_forge_vector (&self->forge, sizeof (int64_t), self->forge.Long, n_stages, max_cycles);
+
+		GMSynth_Render_Stats rs;
+		hist_stats (self, &rs);
+		const float load[4] = { rs.p50, rs.p99, rs.p999, rs.max };
+		lv2_atom_forge_key (&self->forge, self->gfs_renderLoad);
+		lv2_atom_forge_vector (&self->forge, sizeof (float), self->forge.Float, 4, load);
+		lv2_atom_forge_key (&self->forge, self->gfs_deadlineMisses);
+		lv2_atom_forge_long (&self->forge, rs.deadline_misses);
+
+		fluid_channel_cost_t costs[16];
+		const int n_channels = self->cost_accounting ? fluid_synth_get_channel_costs (self->synth, costs, 16, 1) : 0;
+		if (n_channels > 0) {
+			float   share[16];
+			int32_t peak_voices[16];
+			int32_t program[16];
+			for (int c = 0; c < n_channels; ++c) {
+				share[c]       = costs[c].share;
+				peak_voices[c] = costs[c].peak_voices;
+				program[c]     = costs[c].program < 0 ? -1 : costs[c].bank * 128 + costs[c].program;
+			}
+			lv2_atom_forge_key (&self->forge, self->gfs_channelShare);
+			lv2_atom_forge_vector (&self->forge, sizeof (float), self->forge.Float, n_channels, share);
+			lv2_atom_forge_key (&self->forge, self->gfs_channelPeakVoices);
+			lv2_atom_forge_vector (&self->forge, sizeof (int32_t), self->forge.Int, n_channels, peak_voices);
+			lv2_atom_forge_key (&self->forge, self->gfs_channelProgram);
+			lv2_atom_forge_vector (&self->forge, sizeof (int32_t), self->forge.Int, n_channels, program);
+		}
+		lv2_atom_forge_pop (&self->forge, &frame);
+	}
+
+	self->prof_frames = 0;
+}
+
 static void
 run (LV2_Handle instance, uint32_t n_samples)
 {
@@ -419,38 +983,53 @@ run (LV2_Handle instance, uint32_t n_samples)
 		return;
 	}
 
+	rtcheck_enter (&self->rtcheck);
+
+	struct timespec t_start;
+	clock_gettime (CLOCK_MONOTONIC, &t_start);
+
+	LV2_Atom_Forge_Frame notify_frame;
+	if (self->notify) {
+		const uint32_t capacity = self->notify->atom.size;
+		lv2_atom_forge_set_buffer (&self->forge, (uint8_t*)self->notify, capacity);
+		lv2_atom_forge_sequence_head (&self->forge, &notify_frame, 0);
+	}
+
 	if (self->panic) {
 		fluid_synth_all_notes_off (self->synth, -1);
 		fluid_synth_all_sounds_off (self->synth, -1);
 		self->panic = false;
 	}
 
+	const bool freewheel = self->p_ports[GFS_PORT_FREEWHEEL] && *self->p_ports[GFS_PORT_FREEWHEEL] > 0.5f;
+	if (freewheel != self->freewheel) {
+		set_offline (self, freewheel);
+	}
+
+	/* per channel costs read the cycle counter around every voice: only on request */
+	const bool cost_accounting = self->p_ports[GFS_PORT_COSTS] && *self->p_ports[GFS_PORT_COSTS] > 0.5f;
+	if (cost_accounting != self->cost_accounting) {
+		self->cost_accounting = cost_accounting;
+		fluid_synth_set_cost_accounting (self->synth, cost_accounting);
+	}
+
 	uint32_t offset = 0;
 
 	LV2_ATOM_SEQUENCE_FOREACH (self->control, ev) {
 		if (ev->body.type == self->midi_MidiEvent) {
-			if (ev->body.size > 3 || ev->time.frames >= n_samples) {
+			if (ev->body.size > 3 || ev->body.size == 0 || ev->time.frames >= n_samples) {
 				continue;
 			}
 
-			if (ev->time.frames > offset) {
-				fluid_synth_write_float (
-						self->synth,
-						ev->time.frames - offset,
-						&self->p_ports[GFS_PORT_OUT_L][offset], 0, 1,
-						&self->p_ports[GFS_PORT_OUT_R][offset], 0, 1);
+			if (self->n_midi_events == MAX_MIDI_EVENTS) {
+				render (self, offset, ev->time.frames - offset);
+				offset = ev->time.frames;
 			}
 
-			offset = ev->time.frames;
-
 			const uint8_t* const data = (const uint8_t*)(ev + 1);
-			fluid_midi_event_set_type (self->fmidi_event, data[0] & 0xf0);
-			fluid_midi_event_set_channel (self->fmidi_event, data[0] & 0x0f);
-			if (ev->body.size > 1) {
-				fluid_midi_event_set_key (self->fmidi_event, data[1]);
-			}
-			if (ev->body.size == 2 && 0xc0 /* Pgm */ == fluid_midi_event_get_type (self->fmidi_event)) {
-				int chn = fluid_midi_event_get_channel (self->fmidi_event);
+			const int chn = data[0] & 0x0f;
+
+			if (ev->body.size == 2 && 0xc0 /* Pgm */ == (data[0] & 0xf0)) {
 				self->last_program[chn] = data[1];
 				if (self->bankpatch) {
 					self->bankpatch->notify (self->bankpatch->handle, chn,
@@ -463,32 +1042,30 @@ run (LV2_Handle instance, uint32_t n_samples)
 				}
 				self->is_drums[chn] = is_drum;
 			}
-			if (ev->body.size > 2) {
-				if (0xe0 /*PITCH_BEND*/ == fluid_midi_event_get_type (self->fmidi_event)) {
-					fluid_midi_event_set_value (self->fmidi_event, 0);
-					fluid_midi_event_set_pitch (self->fmidi_event, ((data[2] & 0x7f) << 7) | (data[1] & 0x7f));
-				} else {
-					fluid_midi_event_set_value (self->fmidi_event, data[2]);
-				}
-				if (0xb0 /* CC */ == fluid_midi_event_get_type (self->fmidi_event)) {
-					int chn = fluid_midi_event_get_channel (self->fmidi_event);
-					if (data[1] == 0x00) { self->last_bank_msb[chn] = data[2]; }
-					if (data[1] == 0x20) { self->last_bank_lsb[chn] = data[2]; }
-				}
+			if (ev->body.size > 2 && 0xb0 /* CC */ == (data[0] & 0xf0)) {
+				if (data[1] == 0x00) { self->last_bank_msb[chn] = data[2]; }
+				if (data[1] == 0x20) { self->last_bank_lsb[chn] = data[2]; }
 			}
 
-			fluid_synth_handle_midi_event (self->synth, self->fmidi_event);
+			fluid_midi_raw_event_t* me = &self->midi_events[self->n_midi_events++];
+			me->frame = ev->time.frames - offset;
+			memset (me->data, 0, sizeof (me->data));
+			memcpy (me->data, data, ev->body.size);
 		}
 	}
 
-	if (n_samples > offset) {
-		fluid_synth_write_float (
-				self->synth,
-				n_samples - offset,
-				&self->p_ports[GFS_PORT_OUT_L][offset], 0, 1,
-				&self->p_ports[GFS_PORT_OUT_R][offset], 0, 1);
+	render (self, offset, n_samples - offset);
+
+	if (!self->freewheel) {
+		governor (self, n_samples);
 	}
 
+	struct timespec t_end;
+	clock_gettime (CLOCK_MONOTONIC, &t_end);
+	hist_add (self, (t_end.tv_sec - t_start.tv_sec) + 1e-9 * (t_end.tv_nsec - t_start.tv_nsec), n_samples);
+
+	send_profile (self, n_samples);
+
 	if (self->send_bankpgm && self->bankpatch) {
 		self->send_bankpgm = false;
 		for (uint8_t chn = 0; chn < 16; ++chn) {
@@ -497,14 +1074,52 @@ run (LV2_Handle instance, uint32_t n_samples)
 					self->last_program[chn] > 127 ? 255 : self->last_program[chn]);
 		}
 	}
+
+	if (self->notify) {
+		lv2_atom_forge_pop (&self->forge, &notify_frame);
+	}
+
+	rtcheck_leave ();
 }
 
+#ifdef WITH_RTCHECK
+static void
+rtcheck_log (GFSSynth* self)
+{
+	const uint32_t violations = rtcheck_violations (&self->rtcheck);
+	if (violations == 0) {
+		return;
+	}
+
+	lv2_log_error (&self->logger, "gmsynth.lv2: %u real-time safety violation(s) in run()\n", violations);
+
+	for (uint32_t i = 0; i < self->rtcheck.n_records; ++i) {
+		const RTCheckRecord* r = &self->rtcheck.records[i];
+		if (r->size > 0) {
+			lv2_log_error (&self->logger, "gmsynth.lv2: %s (%zu bytes), %u call(s) from:\n", r->call, r->size, r->count);
+		} else {
+			lv2_log_error (&self->logger, "gmsynth.lv2: %s, %u call(s) from:\n", r->call, r->count);
+		}
+		char** symbols = backtrace_symbols (r->frames, r->n_frames);
+		for (int f = 0; f < r->n_frames; ++f) {
+			lv2_log_error (&self->logger, "gmsynth.lv2:   #%d %s\n", f, symbols ? symbols[f] : "?");
+		}
+		free (symbols);
+	}
+}
+#endif
+
 static void cleanup (LV2_Handle instance)
 {
 	GFSSynth* self = (GFSSynth*)instance;
+#ifdef WITH_RTCHECK
+	rtcheck_log (self);
+#endif
+	if (self->trace) {
+		trace_stop (self->trace);
+	}
 	delete_fluid_synth (self->synth);
 	delete_fluid_settings (self->settings);
-	delete_fluid_midi_event (self->fmidi_event);
 	clear_banks (self->presets);
 	pthread_mutex_destroy (&self->bp_lock);
 	free (self);
@@ -514,6 +1129,62 @@ static void cleanup (LV2_Handle instance)
  * LV2 Extensions
  */
 
+static void
+stats_get (LV2_Handle instance, GMSynth_Render_Stats* stats)
+{
+	hist_stats ((GFSSynth*)instance, stats);
+}
+
+static void
+stats_reset (LV2_Handle instance)
+{
+	GFSSynth* self = (GFSSynth*)instance;
+	__atomic_store_n (&self->hist_reset, 1, __ATOMIC_RELEASE);
+}
+
+static void
+startup_get (LV2_Handle instance, GMSynth_Startup_Stats* stats)
+{
+	*stats = ((GFSSynth*)instance)->startup;
+}
+
+static void
+memory_copy (GMSynth_Memory_Stats* stats, const fluid_memory_stats_t* ms)
+{
+	stats->samples_shared  = ms->bytes[FLUID_MEMORY_SAMPLES_SHARED];
+	stats->samples_private = ms->bytes[FLUID_MEMORY_SAMPLES_PRIVATE];
+	stats->presets         = ms->bytes[FLUID_MEMORY_PRESETS];
+	stats->voices          = ms->bytes[FLUID_MEMORY_VOICES];
+	stats->mixer           = ms->bytes[FLUID_MEMORY_MIXER];
+	stats->fx              = ms->bytes[FLUID_MEMORY_FX];
+	stats->events          = ms->bytes[FLUID_MEMORY_EVENTS];
+	stats->locked          = ms->locked;
+}
+
+static void
+memory_get (LV2_Handle instance, GMSynth_Memory_Stats* stats)
+{
+	fluid_memory_stats_t ms;
+	fluid_synth_get_memory_stats (((GFSSynth*)instance)->synth, &ms);
+	memory_copy (stats, &ms);
+}
+
+static void
+memory_get_process (GMSynth_Memory_Stats* stats)
+{
+	fluid_memory_stats_t ms;
+	fluid_get_memory_stats (&ms);
+	memory_copy (stats, &ms);
+}
+
+#ifdef WITH_RTCHECK
+static uint32_t
+rtcheck_get (LV2_Handle instance)
+{
+	return rtcheck_violations (&((GFSSynth*)instance)->rtcheck);
+}
+#endif
+
 static char*
 mn_file (LV2_Handle instance)
 {
@@ -728,9 +1399,27 @@ static const void*
 extension_data (const char* uri)
 {
 	static const LV2_Midnam_Interface midnam = { mn_file, mn_model, mn_free };
+	static const GMSynth_Stats_Interface stats = { stats_get, stats_reset };
+	static const GMSynth_Startup_Interface startup = { startup_get };
+	static const GMSynth_Memory_Interface memory = { memory_get, memory_get_process };
 	if (!strcmp (uri, LV2_MIDNAM__interface)) {
 		return &midnam;
 	}
+	if (!strcmp (uri, GMSYNTH_STATS__interface)) {
+		return &stats;
+	}
+	if (!strcmp (uri, GMSYNTH_STATS__startup)) {
+		return &startup;
+	}
+	if (!strcmp (uri, GMSYNTH_STATS__memory)) {
+		return &memory;
+	}
+#ifdef WITH_RTCHECK
+	static const GMSynth_RTCheck_Interface rtcheck = { rtcheck_get };
+	if (!strcmp (uri, GMSYNTH_STATS__rtcheck)) {
+		return &rtcheck;
+	}
+#endif
 	return NULL;
 }
 
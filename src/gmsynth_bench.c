@@ -0,0 +1,616 @@
+/* gmsynth-bench -- micro-benchmarks of the gmsynth DSP kernels
+ *
+ * Copyright (C) 2016,2017 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <getopt.h>
+#include <math.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fluid_chorus.h"
+#include "fluid_rev.h"
+#include "fluid_rvoice.h"
+#include "fluid_rvoice_mixer.h"
+#include "fluid_synth.h"
+
+#define RATE        48000  // sample-rate the kernels are configured for
+#define BLOCKS      512    // FLUID_BUFSIZE blocks per timed run
+#define REPEATS     31     // timed runs per case, the fastest is reported
+#define SAMPLE_LEN  48000  // length of the test sample
+#define LOOP_START  1000   // loop of the test sample, ~109 Hz at unity pitch
+#define LOOP_END    1440
+#define THRESHOLD   10.0   // default regression threshold in percent
+#define MAX_CASES   64
+
+#define ALIGNED __attribute__ ((aligned (FLUID_DEFAULT_ALIGNMENT)))
+
+/* *****************************************************************************
+ * test signals
+ */
+
+static short         sample_data[SAMPLE_LEN];
+static fluid_sample_t sample;
+static fluid_real_t  noise[FLUID_BUFSIZE] ALIGNED;
+
+/* deterministic white noise in [-1, 1] */
+static double
+rand_noise (uint32_t* seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return (*seed >> 8) / (double)(1 << 23) - 1.0;
+}
+
+static void
+init_signals (void)
+{
+	uint32_t seed = 1;
+	for (int i = 0; i < SAMPLE_LEN; ++i) {
+		const double s = .5 * sin (2 * M_PI * 440 * i / RATE) + .25 * sin (2 * M_PI * 1234.5 * i / RATE) + .1 * rand_noise (&seed);
+		sample_data[i] = (short)(s * 32767);
+	}
+	for (int i = 0; i < FLUID_BUFSIZE; ++i) {
+		noise[i] = .5 * rand_noise (&seed);
+	}
+
+	memset (&sample, 0, sizeof (sample));
+	sample.data       = sample_data;
+	sample.start      = 0;
+	sample.end        = SAMPLE_LEN - 1;
+	sample.loopstart  = LOOP_START;
+	sample.loopend    = LOOP_END;
+	sample.samplerate = RATE;
+}
+
+/* *****************************************************************************
+ * cases
+ */
+
+typedef struct Case Case;
+
+struct Case {
+	char   name[48];
+	void (*run) (Case*, int n_blocks);
+	int    voices; // kernel instances processed per block
+
+	/* interpolation */
+	int (*interp) (fluid_rvoice_dsp_t*, fluid_real_t* FLUID_RESTRICT, int);
+	fluid_rvoice_dsp_t dsp;
+	int                looping;
+	double             ratio;
+
+	/* filter */
+	fluid_iir_filter_t filter[FLUID_IIR_FILTER_LANES];
+	bool               ramp;
+
+	/* effects */
+	fluid_revmodel_t* rev;
+	fluid_chorus_t*   chorus;
+	bool              mix;
+
+	/* mixdown */
+	fluid_rvoice_buffers_t buffers;
+
+	/* envelope */
+	fluid_adsr_env_t env;
+
+	fluid_real_t buf[FLUID_IIR_FILTER_LANES][FLUID_BUFSIZE] ALIGNED;
+	fluid_real_t out[FLUID_RVOICE_MAX_BUFS][FLUID_BUFSIZE] ALIGNED;
+
+	/* results */
+	double ns;
+	double baseline;
+};
+
+static Case*              cases[MAX_CASES];
+static int                n_cases = 0;
+static fluid_sinc_table_t* sinc_table = NULL;
+
+static Case*
+add_case (const char* name, void (*run) (Case*, int), int voices)
+{
+	if (n_cases == MAX_CASES) {
+		fprintf (stderr, "gmsynth-bench: too many cases\n");
+		exit (EXIT_FAILURE);
+	}
+	Case* c = aligned_alloc (FLUID_DEFAULT_ALIGNMENT, (sizeof (Case) + FLUID_DEFAULT_ALIGNMENT - 1) & ~(FLUID_DEFAULT_ALIGNMENT - 1));
+	memset (c, 0, sizeof (Case));
+	snprintf (c->name, sizeof (c->name), "%s", name);
+	c->run      = run;
+	c->voices   = voices;
+	c->baseline = -1;
+	cases[n_cases++] = c;
+	return c;
+}
+
+/* fluid_rvoice_dsp_interpolate_*, restarting the voice at the end of the sample */
+static void
+run_interp (Case* c, int n_blocks)
+{
+	for (int i = 0; i < n_blocks; ++i) {
+		if (c->interp (&c->dsp, c->buf[0], c->looping) < FLUID_BUFSIZE) {
+			fluid_phase_set_int (c->dsp.phase, c->dsp.start);
+		}
+	}
+}
+
+static void
+add_interp (const char* method, int (*interp) (fluid_rvoice_dsp_t*, fluid_real_t* FLUID_RESTRICT, int), double ratio, int looping)
+{
+	char name[48];
+	snprintf (name, sizeof (name), "interp_%s_%.2f_%s", method, ratio, looping ? "loop" : "oneshot");
+
+	Case* c = add_case (name, run_interp, 1);
+	c->interp  = interp;
+	c->ratio   = ratio;
+	c->looping = looping;
+
+	fluid_rvoice_dsp_t* dsp = &c->dsp;
+	dsp->sample     = &sample;
+	dsp->sinc_table = sinc_table;
+	dsp->samplemode = looping ? FLUID_LOOP_DURING_RELEASE : FLUID_UNLOOPED;
+	dsp->start      = sample.start;
+	dsp->end        = sample.end;
+	dsp->loopstart  = sample.loopstart;
+	dsp->loopend    = sample.loopend;
+	dsp->amp        = .5;
+	dsp->amp_incr   = 0;
+	dsp->phase_incr = ratio;
+	fluid_phase_set_int (dsp->phase, dsp->start);
+}
+
+static void
+init_filter (fluid_iir_filter_t* filter, fluid_real_t fres, fluid_real_t q)
+{
+	fluid_rvoice_param_t param[MAX_EVENT_PARAMS];
+
+	param[0].i = FLUID_IIR_LOWPASS;
+	param[1].i = 0;
+	fluid_iir_filter_init (filter, param);
+	param[0].real = fres;
+	fluid_iir_filter_set_fres (filter, param);
+	param[0].real = q;
+	fluid_iir_filter_set_q (filter, param);
+	fluid_iir_filter_calc (filter, RATE, 0);
+}
+
+/* fluid_iir_filter_apply, with the cutoff alternating by an octave each
+ * block when ramping. Every block filters a fresh copy of the noise. */
+static void
+run_filter (Case* c, int n_blocks)
+{
+	for (int i = 0; i < n_blocks; ++i) {
+		if (c->ramp) {
+			fluid_iir_filter_calc (&c->filter[0], RATE, (i & 1) ? 1200 : 0);
+		}
+		memcpy (c->buf[0], noise, sizeof (noise));
+		fluid_iir_filter_apply (&c->filter[0], c->buf[0], FLUID_BUFSIZE);
+	}
+}
+
+static void
+run_filter_multi (Case* c, int n_blocks)
+{
+	fluid_iir_filter_t* filters[FLUID_IIR_FILTER_LANES];
+	fluid_real_t*       bufs[FLUID_IIR_FILTER_LANES];
+
+	for (int l = 0; l < FLUID_IIR_FILTER_LANES; ++l) {
+		filters[l] = &c->filter[l];
+		bufs[l]    = c->buf[l];
+	}
+
+	for (int i = 0; i < n_blocks; ++i) {
+		for (int l = 0; l < FLUID_IIR_FILTER_LANES; ++l) {
+			if (c->ramp) {
+				fluid_iir_filter_calc (&c->filter[l], RATE, ((i + l) & 1) ? 1200 : 0);
+			}
+			memcpy (c->buf[l], noise, sizeof (noise));
+		}
+		fluid_iir_filter_apply_multi (filters, bufs, FLUID_IIR_FILTER_LANES);
+	}
+}
+
+static void
+add_filter (bool multi, bool ramp)
+{
+	char name[48];
+	snprintf (name, sizeof (name), "iir_filter_apply%s_%s", multi ? "_multi" : "", ramp ? "ramp" : "static");
+
+	Case* c = add_case (name, multi ? run_filter_multi : run_filter, multi ? FLUID_IIR_FILTER_LANES : 1);
+	c->ramp = ramp;
+	for (int l = 0; l < FLUID_IIR_FILTER_LANES; ++l) {
+		/* ~1.6 kHz, 10 dB resonance, slightly detuned per lane */
+		init_filter (&c->filter[l], 8000 + 10 * l, 100);
+	}
+}
+
+static void
+run_reverb (Case* c, int n_blocks)
+{
+	for (int i = 0; i < n_blocks; ++i) {
+		if (c->mix) {
+			fluid_revmodel_processmix (c->rev, noise, c->out[0], c->out[1]);
+		} else {
+			fluid_revmodel_processreplace (c->rev, noise, c->out[0], c->out[1]);
+		}
+	}
+}
+
+static void
+add_reverb (bool mix)
+{
+	Case* c = add_case (mix ? "revmodel_processmix" : "revmodel_processreplace", run_reverb, 1);
+	c->mix = mix;
+	c->rev = new_fluid_revmodel (RATE);
+	fluid_revmodel_set (c->rev, FLUID_REVMODEL_SET_ALL, FLUID_REVERB_DEFAULT_ROOMSIZE,
+	                    FLUID_REVERB_DEFAULT_DAMP, FLUID_REVERB_DEFAULT_WIDTH, FLUID_REVERB_DEFAULT_LEVEL);
+}
+
+static void
+run_chorus (Case* c, int n_blocks)
+{
+	for (int i = 0; i < n_blocks; ++i) {
+		if (c->mix) {
+			fluid_chorus_processmix (c->chorus, noise, c->out[0], c->out[1]);
+		} else {
+			fluid_chorus_processreplace (c->chorus, noise, c->out[0], c->out[1]);
+		}
+	}
+}
+
+static void
+add_chorus (bool mix)
+{
+	Case* c = add_case (mix ? "chorus_processmix" : "chorus_processreplace", run_chorus, 1);
+	c->mix    = mix;
+	c->chorus = new_fluid_chorus (RATE);
+	fluid_chorus_set (c->chorus, FLUID_CHORUS_SET_ALL, FLUID_CHORUS_DEFAULT_N, FLUID_CHORUS_DEFAULT_LEVEL,
+	                  FLUID_CHORUS_DEFAULT_SPEED, FLUID_CHORUS_DEFAULT_DEPTH, FLUID_CHORUS_DEFAULT_TYPE);
+}
+
+/* fluid_rvoice_buffers_mix of one voice block to left, right, reverb and chorus */
+static void
+run_mix (Case* c, int n_blocks)
+{
+	fluid_real_t* dest_bufs[FLUID_RVOICE_MAX_BUFS];
+
+	for (int b = 0; b < FLUID_RVOICE_MAX_BUFS; ++b) {
+		dest_bufs[b] = c->out[b];
+	}
+
+	for (int i = 0; i < n_blocks; ++i) {
+		fluid_rvoice_buffers_mix (&c->buffers, noise, 0, FLUID_BUFSIZE, dest_bufs, FLUID_RVOICE_MAX_BUFS);
+	}
+}
+
+static void
+add_mix (void)
+{
+	Case* c = add_case ("rvoice_buffers_mix", run_mix, 1);
+	c->buffers.count = FLUID_RVOICE_MAX_BUFS;
+	for (int b = 0; b < FLUID_RVOICE_MAX_BUFS; ++b) {
+		c->buffers.bufs[b].amp     = .1 + .05 * b;
+		c->buffers.bufs[b].mapping = b;
+	}
+}
+
+static void
+set_env_data (fluid_adsr_env_t* env, fluid_adsr_env_section_t section, unsigned int count,
+              fluid_real_t coeff, fluid_real_t increment, fluid_real_t min, fluid_real_t max)
+{
+	fluid_rvoice_param_t param[MAX_EVENT_PARAMS];
+
+	param[0].i    = section;
+	param[1].i    = count;
+	param[2].real = coeff;
+	param[3].real = increment;
+	param[4].real = min;
+	param[5].real = max;
+	fluid_adsr_env_set_data (env, param);
+}
+
+/* fluid_adsr_env_calc is evaluated once per block, its cost is spread over
+ * the FLUID_BUFSIZE samples of the block. The envelope restarts when done. */
+static void
+run_env (Case* c, int n_blocks)
+{
+	for (int i = 0; i < n_blocks; ++i) {
+		if (fluid_adsr_env_get_section (&c->env) == FLUID_VOICE_ENVFINISHED) {
+			fluid_adsr_env_reset (&c->env);
+		}
+		fluid_adsr_env_calc (&c->env, 1);
+	}
+}
+
+static void
+add_env (void)
+{
+	Case* c = add_case ("adsr_env_calc", run_env, 1);
+	set_env_data (&c->env, FLUID_VOICE_ENVDELAY, 10, 0, 0, -1, 1);
+	set_env_data (&c->env, FLUID_VOICE_ENVATTACK, 100, 1, .01, -1, 1);
+	set_env_data (&c->env, FLUID_VOICE_ENVHOLD, 50, 1, 0, -1, 2);
+	set_env_data (&c->env, FLUID_VOICE_ENVDECAY, 400, .995, -.0001, .4, 2);
+	set_env_data (&c->env, FLUID_VOICE_ENVSUSTAIN, 300, 1, 0, -1, 2);
+	set_env_data (&c->env, FLUID_VOICE_ENVRELEASE, 200, .98, 0, 1e-4, 1);
+	set_env_data (&c->env, FLUID_VOICE_ENVFINISHED, 0x10000000, 0, 0, -1, 1);
+	fluid_adsr_env_reset (&c->env);
+}
+
+static void
+setup_cases (void)
+{
+	static const double ratios[] = { 0.5, 1.0, 1.5, 2.0 };
+	static const struct {
+		const char* name;
+		int (*fn) (fluid_rvoice_dsp_t*, fluid_real_t* FLUID_RESTRICT, int);
+	} methods[] = {
+		{ "none", fluid_rvoice_dsp_interpolate_none },
+		{ "linear", fluid_rvoice_dsp_interpolate_linear },
+		{ "4th", fluid_rvoice_dsp_interpolate_4th_order },
+		{ "7th", fluid_rvoice_dsp_interpolate_7th_order },
+		{ "sinc", fluid_rvoice_dsp_interpolate_sinc },
+	};
+
+	sinc_table = new_fluid_sinc_table (16);
+
+	for (size_t m = 0; m < sizeof (methods) / sizeof (methods[0]); ++m) {
+		for (size_t r = 0; r < sizeof (ratios) / sizeof (ratios[0]); ++r) {
+			add_interp (methods[m].name, methods[m].fn, ratios[r], 0);
+			add_interp (methods[m].name, methods[m].fn, ratios[r], 1);
+		}
+	}
+	add_interp ("unity", fluid_rvoice_dsp_copy_unity, 1.0, 0);
+	add_interp ("unity", fluid_rvoice_dsp_copy_unity, 1.0, 1);
+
+	add_filter (false, false);
+	add_filter (false, true);
+	add_filter (true, false);
+	add_filter (true, true);
+
+	add_reverb (false);
+	add_reverb (true);
+	add_chorus (false);
+	add_chorus (true);
+
+	add_mix ();
+	add_env ();
+}
+
+static void
+cleanup_cases (void)
+{
+	for (int i = 0; i < n_cases; ++i) {
+		delete_fluid_revmodel (cases[i]->rev);
+		delete_fluid_chorus (cases[i]->chorus);
+		free (cases[i]);
+	}
+	delete_fluid_sinc_table (sinc_table);
+}
+
+/* *****************************************************************************
+ * measurement
+ */
+
+static double
+now_ns (void)
+{
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* fastest of REPEATS runs after a warm-up, in ns per sample per voice */
+static void
+measure (Case* c)
+{
+	c->run (c, BLOCKS);
+
+	double best = -1;
+	for (int r = 0; r < REPEATS; ++r) {
+		const double t0 = now_ns ();
+		c->run (c, BLOCKS);
+		const double dt = now_ns () - t0;
+		if (best < 0 || dt < best) {
+			best = dt;
+		}
+	}
+	c->ns = best / ((double)BLOCKS * FLUID_BUFSIZE * c->voices);
+}
+
+/* *****************************************************************************
+ * baseline
+ */
+
+static bool
+read_baseline (const char* path)
+{
+	FILE* f = fopen (path, "r");
+	if (!f) {
+		fprintf (stderr, "gmsynth-bench: cannot open baseline '%s'\n", path);
+		return false;
+	}
+
+	char   line[256];
+	char   name[48];
+	double ns;
+	while (fgets (line, sizeof (line), f)) {
+		if (line[0] == '#' || sscanf (line, "%47s %lf", name, &ns) != 2) {
+			continue;
+		}
+		for (int i = 0; i < n_cases; ++i) {
+			if (!strcmp (cases[i]->name, name)) {
+				cases[i]->baseline = ns;
+			}
+		}
+	}
+	fclose (f);
+	return true;
+}
+
+static bool
+write_baseline (const char* path)
+{
+	FILE* f = fopen (path, "w");
+	if (!f) {
+		fprintf (stderr, "gmsynth-bench: cannot write baseline '%s'\n", path);
+		return false;
+	}
+
+	fprintf (f, "# gmsynth-bench baseline, ns per sample per voice\n");
+	for (int i = 0; i < n_cases; ++i) {
+		if (cases[i]->ns > 0) {
+			fprintf (f, "%-40s %.4f\n", cases[i]->name, cases[i]->ns);
+		}
+	}
+	fclose (f);
+	return true;
+}
+
+/* *****************************************************************************
+ * main
+ */
+
+static void
+usage (int status)
+{
+	printf ("gmsynth-bench - Micro-benchmarks of the gmsynth DSP kernels.\n\n");
+	printf ("Usage: gmsynth-bench [ OPTIONS ]\n\n");
+	printf ("Options:\n"
+	        "  -b, --baseline <file>      Compare with the results stored in file\n"
+	        "  -f, --filter <text>        Only run cases whose name contains text\n"
+	        "  -h, --help                 Display this help and exit\n"
+	        "  -t, --threshold <percent>  Slow-down reported as regression (default 10)\n"
+	        "  -w, --write <file>         Store the results as new baseline\n\n");
+	printf ("Reports the time spent per sample and voice of each kernel, the fastest\n"
+	        "of %d runs of %d blocks. With a baseline, the exit status is 1 if any\n"
+	        "case is slower than the baseline by more than the threshold.\n",
+	        REPEATS, BLOCKS);
+	exit (status);
+}
+
+static struct option const long_options[] = {
+	{ "baseline", required_argument, 0, 'b' },
+	{ "filter", required_argument, 0, 'f' },
+	{ "help", no_argument, 0, 'h' },
+	{ "threshold", required_argument, 0, 't' },
+	{ "write", required_argument, 0, 'w' },
+	{ NULL, 0, NULL, 0 }
+};
+
+int
+main (int argc, char** argv)
+{
+	const char* baseline  = NULL;
+	const char* output    = NULL;
+	const char* filter    = NULL;
+	double      threshold = THRESHOLD;
+
+	int c;
+	while ((c = getopt_long (argc, argv, "b:f:ht:w:", long_options, NULL)) != EOF) {
+		switch (c) {
+			case 'b':
+				baseline = optarg;
+				break;
+			case 'f':
+				filter = optarg;
+				break;
+			case 'h':
+				usage (EXIT_SUCCESS);
+				break;
+			case 't':
+				threshold = atof (optarg);
+				break;
+			case 'w':
+				output = optarg;
+				break;
+			default:
+				usage (EXIT_FAILURE);
+				break;
+		}
+	}
+
+	if (optind != argc || threshold <= 0) {
+		usage (EXIT_FAILURE);
+	}
+
+#ifdef __linux__
+	/* stay on one core, migrations spoil the timing */
+	cpu_set_t cpus;
+	if (sched_getaffinity (0, sizeof (cpus), &cpus) == 0) {
+		for (int i = 0; i < CPU_SETSIZE; ++i) {
+			if (CPU_ISSET (i, &cpus)) {
+				CPU_ZERO (&cpus);
+				CPU_SET (i, &cpus);
+				sched_setaffinity (0, sizeof (cpus), &cpus);
+				break;
+			}
+		}
+	}
+#endif
+
+	init_signals ();
+	setup_cases ();
+
+	if (baseline && !read_baseline (baseline)) {
+		cleanup_cases ();
+		return EXIT_FAILURE;
+	}
+
+	int n_regressions = 0;
+
+	printf ("%-40s %10s %10s %8s\n", "kernel", "ns/sample", "baseline", "change");
+	for (int i = 0; i < n_cases; ++i) {
+		Case* k = cases[i];
+		if (filter && !strstr (k->name, filter)) {
+			continue;
+		}
+
+		measure (k);
+
+		if (k->baseline <= 0) {
+			printf ("%-40s %10.4f %10s\n", k->name, k->ns, "-");
+			continue;
+		}
+
+		const double change = 100. * (k->ns - k->baseline) / k->baseline;
+		const bool   regression = change > threshold;
+		printf ("%-40s %10.4f %10.4f %+7.1f%%%s\n", k->name, k->ns, k->baseline, change,
+		        regression ? "  REGRESSION" : (change < -threshold ? "  faster" : ""));
+		if (regression) {
+			++n_regressions;
+		}
+	}
+
+	if (baseline) {
+		printf ("%d regression(s) above %.1f%%\n", n_regressions, threshold);
+	}
+
+	if (output && !write_baseline (output)) {
+		n_regressions = -1;
+	}
+
+	cleanup_cases ();
+	return n_regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,783 @@
+/* gmsynth-lv2bench -- polyphony scaling benchmark of the gmsynth.lv2 plugin
+ *
+ * Copyright (C) 2016,2017 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <dlfcn.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GFS_URN "http://gareus.org/oss/lv2/gmsynth"
+
+#ifdef HAVE_LV2_1_18_6
+#include <lv2/atom/atom.h>
+#include <lv2/atom/util.h>
+#include <lv2/core/lv2.h>
+#include <lv2/log/log.h>
+#include <lv2/midi/midi.h>
+#include <lv2/urid/urid.h>
+#else
+#include <lv2/lv2plug.in/ns/lv2core/lv2.h>
+#include <lv2/lv2plug.in/ns/ext/atom/atom.h>
+#include <lv2/lv2plug.in/ns/ext/atom/util.h>
+#include <lv2/lv2plug.in/ns/ext/log/log.h>
+#include <lv2/lv2plug.in/ns/ext/midi/midi.h>
+#include <lv2/lv2plug.in/ns/ext/urid/urid.h>
+#endif
+
+#include "gmsynth_stats_lv2.h"
+
+#ifndef LIB_EXT
+#define LIB_EXT ".so"
+#endif
+
+#define MAX_URIDS    64
+#define MAX_LIST     16
+#define SEQ_SIZE     65536  // bytes of the MIDI input and notify sequences
+#define MAX_NOTES    256    // note slots of the score
+#define WARMUP_SEC   1.     // excluded from the measurement
+#define RETRIGGER    .5     // seconds between two notes of a slot
+#define MAX_BLOCK    4096
+
+/* port indices, see gmsynth.ttl */
+enum {
+	PORT_CONTROL = 0,
+	PORT_OUT_L,
+	PORT_OUT_R,
+	PORT_FREEWHEEL,
+	PORT_NOTIFY,
+	PORT_DEADLINE,
+	PORT_COSTS,
+};
+
+enum {
+	PRESET_PIANO = 0,
+	PRESET_PADS,
+	PRESET_DRUMS,
+	PRESET_MIX,
+};
+
+static const char* preset_names[] = { "piano", "pads", "drums", "mix" };
+
+typedef struct {
+	/* options */
+	int    rates[MAX_LIST];
+	int    n_rates;
+	int    blocks[MAX_LIST];
+	int    n_blocks;
+	int    notes[MAX_LIST];
+	int    n_notes;
+	int    presets[MAX_LIST];
+	int    n_presets;
+	double duration;
+	bool   freewheel;
+	int    startup; // instances to create in the startup profile, 0: scaling benchmark
+
+	/* plugin */
+	const char*          bundle;
+	void*                lib;
+	const LV2_Descriptor* desc;
+} Bench;
+
+typedef struct {
+	double   rtf;       // audio time / render time
+	double   avg_us;    // mean run() time
+	double   worst_us;  // longest run()
+	double   worst_pct; // longest run() in % of the period
+	int      voices;    // peak voice count reported by the plugin
+	uint32_t rt_errors; // real-time safety violations (RTCHECK=yes builds)
+} Result;
+
+/* *****************************************************************************
+ * URID map
+ */
+
+static char*    uris[MAX_URIDS];
+static uint32_t n_uris = 0;
+
+static LV2_URID
+map_uri (LV2_URID_Map_Handle handle, const char* uri)
+{
+	for (uint32_t i = 0; i < n_uris; ++i) {
+		if (!strcmp (uris[i], uri)) {
+			return i + 1;
+		}
+	}
+	if (n_uris == MAX_URIDS) {
+		return 0;
+	}
+	uris[n_uris] = strdup (uri);
+	return ++n_uris;
+}
+
+static void
+free_uris (void)
+{
+	for (uint32_t i = 0; i < n_uris; ++i) {
+		free (uris[i]);
+	}
+	n_uris = 0;
+}
+
+/* *****************************************************************************
+ * Log, plugin messages but the trace level ones go to stderr
+ */
+
+static LV2_URID log_Trace;
+
+static int
+log_vprintf (LV2_Log_Handle handle, LV2_URID type, const char* fmt, va_list args)
+{
+	if (type == log_Trace) {
+		return 0;
+	}
+	return vfprintf (stderr, fmt, args);
+}
+
+static int
+log_printf (LV2_Log_Handle handle, LV2_URID type, const char* fmt, ...)
+{
+	va_list args;
+	va_start (args, fmt);
+	const int rv = log_vprintf (handle, type, fmt, args);
+	va_end (args);
+	return rv;
+}
+
+static LV2_URID_Map       map         = { NULL, map_uri };
+static LV2_Log_Log        log_        = { NULL, log_printf, log_vprintf };
+static LV2_Feature        map_feature = { LV2_URID__map, &map };
+static LV2_Feature        log_feature = { LV2_LOG__log, &log_ };
+static const LV2_Feature* features[]  = { &map_feature, &log_feature, NULL };
+
+/* *****************************************************************************
+ * score
+ *
+ * Every note slot plays a new note each RETRIGGER seconds, staggered over
+ * the slots, so that the number of sounding notes stays at the slot count.
+ * piano and pads play on channel 1 and 2, drums on channel 10.
+ */
+
+typedef struct {
+	int64_t frame;
+	uint8_t msg[3];
+	int     len;
+} Event;
+
+typedef struct {
+	int64_t next;    // frame of the next retrigger
+	int     chan;
+	int     key;     // sounding key or -1
+	int     count;   // notes played
+} Slot;
+
+typedef struct {
+	Slot    slots[MAX_NOTES];
+	int     n_slots;
+	int64_t period;  // RETRIGGER in frames
+	int     preset;
+} Score;
+
+static int
+slot_channel (int preset, int slot)
+{
+	switch (preset == PRESET_MIX ? slot % 3 : preset) {
+		case PRESET_PIANO:
+			return 0;
+		case PRESET_PADS:
+			return 1;
+		default:
+			return 9;
+	}
+}
+
+static void
+score_init (Score* s, int preset, int n_notes, double rate)
+{
+	s->preset  = preset;
+	s->n_slots = n_notes < MAX_NOTES ? n_notes : MAX_NOTES;
+	s->period  = rate * RETRIGGER;
+	for (int i = 0; i < s->n_slots; ++i) {
+		s->slots[i].next  = 1 + s->period * i / s->n_slots;
+		s->slots[i].chan  = slot_channel (preset, i);
+		s->slots[i].key   = -1;
+		s->slots[i].count = 0;
+	}
+}
+
+static void
+add_event (Event* ev, int* n_ev, int64_t frame, uint8_t b0, uint8_t b1, uint8_t b2, int len)
+{
+	ev[*n_ev].frame  = frame;
+	ev[*n_ev].msg[0] = b0;
+	ev[*n_ev].msg[1] = b1;
+	ev[*n_ev].msg[2] = b2;
+	ev[*n_ev].len    = len;
+	++*n_ev;
+}
+
+/* stable, a note-off must stay ahead of the note-on of the same slot */
+static void
+sort_events (Event* ev, int n_ev)
+{
+	for (int i = 1; i < n_ev; ++i) {
+		const Event e = ev[i];
+		int j = i;
+		for (; j > 0 && ev[j - 1].frame > e.frame; --j) {
+			ev[j] = ev[j - 1];
+		}
+		ev[j] = e;
+	}
+}
+
+/* events of the frames [pos, pos + n_samples), in time order */
+static int
+score_events (Score* s, Event* ev, int64_t pos, uint32_t n_samples)
+{
+	int n_ev = 0;
+
+	if (pos == 0) {
+		add_event (ev, &n_ev, 0, 0xc0, 0, 0, 2);  // Acoustic Grand Piano
+		add_event (ev, &n_ev, 0, 0xc1, 89, 0, 2); // Pad 2 (warm)
+		add_event (ev, &n_ev, 0, 0xc9, 0, 0, 2);  // Standard Kit
+	}
+
+	for (int i = 0; i < s->n_slots; ++i) {
+		Slot* slot = &s->slots[i];
+		while (slot->next < pos + n_samples) {
+			if (slot->key >= 0) {
+				add_event (ev, &n_ev, slot->next, 0x80 | slot->chan, slot->key, 0, 3);
+			}
+			if (slot->chan == 9) {
+				slot->key = 35 + (i * 5 + slot->count * 3) % 47;
+			} else {
+				slot->key = 36 + (i * 7 + slot->count * 5) % 48;
+			}
+			add_event (ev, &n_ev, slot->next, 0x90 | slot->chan, slot->key, 64 + (i * 13 + slot->count) % 63, 3);
+			++slot->count;
+			slot->next += s->period;
+		}
+	}
+
+	sort_events (ev, n_ev);
+	return n_ev;
+}
+
+/* *****************************************************************************
+ * atom sequences
+ */
+
+static void
+seq_clear (LV2_Atom_Sequence* seq)
+{
+	seq->atom.type = map_uri (NULL, LV2_ATOM__Sequence);
+	seq->atom.size = sizeof (LV2_Atom_Sequence_Body);
+	seq->body.unit = 0;
+	seq->body.pad  = 0;
+}
+
+static bool
+seq_append_midi (LV2_Atom_Sequence* seq, int64_t frames, const uint8_t* msg, int len)
+{
+	const uint32_t offset = lv2_atom_pad_size (seq->atom.size);
+	if (sizeof (LV2_Atom) + offset + sizeof (LV2_Atom_Event) + len > SEQ_SIZE) {
+		return false;
+	}
+	LV2_Atom_Event* ev = (LV2_Atom_Event*)((uint8_t*)&seq->body + offset);
+	ev->time.frames = frames;
+	ev->body.size   = len;
+	ev->body.type   = map_uri (NULL, LV2_MIDI__MidiEvent);
+	memcpy (ev + 1, msg, len);
+	seq->atom.size = offset + sizeof (LV2_Atom_Event) + len;
+	return true;
+}
+
+/* sum of the per channel peak voice count of the Profile objects on the notify port */
+static int
+notify_peak_voices (const LV2_Atom_Sequence* notify)
+{
+	const LV2_URID profile     = map_uri (NULL, GFS_URN "#Profile");
+	const LV2_URID peak_voices = map_uri (NULL, GFS_URN "#channelPeakVoices");
+	const LV2_URID atom_vector = map_uri (NULL, LV2_ATOM__Vector);
+	const LV2_URID atom_int    = map_uri (NULL, LV2_ATOM__Int);
+
+	int peak = -1;
+
+	LV2_ATOM_SEQUENCE_FOREACH (notify, ev) {
+		const LV2_Atom_Object* obj = (const LV2_Atom_Object*)&ev->body;
+		if (obj->body.otype != profile) {
+			continue;
+		}
+		LV2_ATOM_OBJECT_FOREACH (obj, prop) {
+			if (prop->key != peak_voices || prop->value.type != atom_vector) {
+				continue;
+			}
+			const LV2_Atom_Vector_Body* vec = (const LV2_Atom_Vector_Body*)(&prop->value + 1);
+			if (vec->child_type != atom_int) {
+				continue;
+			}
+			const int32_t* v = (const int32_t*)(vec + 1);
+			const uint32_t n = (prop->value.size - sizeof (LV2_Atom_Vector_Body)) / sizeof (int32_t);
+			peak = 0;
+			for (uint32_t c = 0; c < n; ++c) {
+				peak += v[c];
+			}
+		}
+	}
+	return peak;
+}
+
+/* *****************************************************************************
+ * benchmark
+ */
+
+static double
+now_us (void)
+{
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+static bool
+run_config (const Bench* b, double rate, uint32_t block, int preset, int notes, Result* r)
+{
+	static uint64_t control_buf[SEQ_SIZE / sizeof (uint64_t)];
+	static uint64_t notify_buf[SEQ_SIZE / sizeof (uint64_t)];
+	static float    out_l[MAX_BLOCK];
+	static float    out_r[MAX_BLOCK];
+	static Event    events[SEQ_SIZE / sizeof (LV2_Atom_Event)];
+
+	LV2_Atom_Sequence* control = (LV2_Atom_Sequence*)control_buf;
+	LV2_Atom_Sequence* notify  = (LV2_Atom_Sequence*)notify_buf;
+	float freewheel = b->freewheel ? 1.f : 0.f;
+	float deadline  = .8f;
+	float costs     = 1.f; // the per channel peak voices are part of the costs
+
+	LV2_Handle h = b->desc->instantiate (b->desc, rate, b->bundle, features);
+	if (!h) {
+		fprintf (stderr, "gmsynth-lv2bench: instantiate failed (rate %.0f)\n", rate);
+		return false;
+	}
+
+	b->desc->connect_port (h, PORT_CONTROL, control);
+	b->desc->connect_port (h, PORT_OUT_L, out_l);
+	b->desc->connect_port (h, PORT_OUT_R, out_r);
+	b->desc->connect_port (h, PORT_FREEWHEEL, &freewheel);
+	b->desc->connect_port (h, PORT_NOTIFY, notify);
+	b->desc->connect_port (h, PORT_DEADLINE, &deadline);
+	b->desc->connect_port (h, PORT_COSTS, &costs);
+
+	if (b->desc->activate) {
+		b->desc->activate (h);
+	}
+
+	Score score;
+	score_init (&score, preset, notes, rate);
+
+	const int64_t warmup = rate * WARMUP_SEC;
+	const int64_t end    = warmup + rate * b->duration;
+
+	double total = 0;
+	double worst = 0;
+	long   runs  = 0;
+
+	r->voices = 0;
+
+	for (int64_t pos = 0; pos < end; pos += block) {
+		seq_clear (control);
+		const int n_ev = score_events (&score, events, pos, block);
+		for (int i = 0; i < n_ev; ++i) {
+			seq_append_midi (control, events[i].frame - pos, events[i].msg, events[i].len);
+		}
+		notify->atom.size = SEQ_SIZE - sizeof (LV2_Atom);
+
+		const double t0 = now_us ();
+		b->desc->run (h, block);
+		const double dt = now_us () - t0;
+
+		const int peak = notify_peak_voices (notify);
+
+		if (pos < warmup) {
+			continue;
+		}
+
+		total += dt;
+		++runs;
+		if (dt > worst) {
+			worst = dt;
+		}
+		if (peak > r->voices) {
+			r->voices = peak;
+		}
+	}
+
+	const GMSynth_RTCheck_Interface* rtcheck = NULL;
+	if (b->desc->extension_data) {
+		rtcheck = (const GMSynth_RTCheck_Interface*)b->desc->extension_data (GMSYNTH_STATS__rtcheck);
+	}
+	r->rt_errors = rtcheck ? rtcheck->violations (h) : 0;
+
+	if (b->desc->deactivate) {
+		b->desc->deactivate (h);
+	}
+	/* a debug build of the plugin logs the call sites here */
+	b->desc->cleanup (h);
+
+	const double period_us = 1e6 * block / rate;
+	r->rtf       = total > 0 ? runs * period_us / total : 0;
+	r->avg_us    = runs > 0 ? total / runs : 0;
+	r->worst_us  = worst;
+	r->worst_pct = 100. * worst / period_us;
+	return true;
+}
+
+/* *****************************************************************************
+ * startup profile
+ */
+
+static void
+print_startup (const char* label, double host_ms, const GMSynth_Startup_Stats* st)
+{
+	printf ("%6s %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %8u %9d\n",
+	        label, host_ms, st->total, st->settings, st->synth, st->sfload, st->presets, st->bootstrap,
+	        st->allocations, st->peak_rss_kib);
+}
+
+static void
+print_memory (const char* label, const GMSynth_Memory_Stats* ms)
+{
+	const uint64_t total = ms->samples_shared + ms->samples_private + ms->presets
+	                       + ms->voices + ms->mixer + ms->fx + ms->events;
+	printf ("%8s %9.0f %9.0f %9.0f %9.0f %9.0f %9.0f %9.0f %9.0f %9.0f\n",
+	        label, ms->samples_shared / 1024., ms->samples_private / 1024., ms->presets / 1024.,
+	        ms->voices / 1024., ms->mixer / 1024., ms->fx / 1024., ms->events / 1024.,
+	        total / 1024., ms->locked / 1024.);
+}
+
+static void
+accumulate (float* sum, float* max, float val)
+{
+	*sum += val;
+	if (val > *max) {
+		*max = val;
+	}
+}
+
+/* create n instances one after another, as a host loading a session does */
+static bool
+run_startup (const Bench* b, double rate, int n)
+{
+	const GMSynth_Startup_Interface* si = NULL;
+	if (b->desc->extension_data) {
+		si = (const GMSynth_Startup_Interface*)b->desc->extension_data (GMSYNTH_STATS__startup);
+	}
+	if (!si) {
+		fprintf (stderr, "gmsynth-lv2bench: the plugin does not report its startup profile\n");
+		return false;
+	}
+
+	LV2_Handle* h = (LV2_Handle*)calloc (n, sizeof (LV2_Handle));
+	if (!h) {
+		return false;
+	}
+
+	GMSynth_Startup_Stats sum;
+	GMSynth_Startup_Stats max;
+	memset (&sum, 0, sizeof (sum));
+	memset (&max, 0, sizeof (max));
+	double sum_host = 0;
+	double max_host = 0;
+	bool   ok       = true;
+
+	printf ("%6s %9s %9s %9s %9s %9s %9s %9s %8s %9s\n",
+	        "inst", "host[ms]", "total", "settings", "synth", "sfload", "presets", "bootstrap", "allocs", "rss[KiB]");
+
+	for (int i = 0; i < n; ++i) {
+		const double t0 = now_us ();
+		h[i] = b->desc->instantiate (b->desc, rate, b->bundle, features);
+		const double host_ms = (now_us () - t0) * 1e-3;
+
+		if (!h[i]) {
+			fprintf (stderr, "gmsynth-lv2bench: instantiate failed (rate %.0f)\n", rate);
+			ok = false;
+			break;
+		}
+
+		GMSynth_Startup_Stats st;
+		si->get (h[i], &st);
+
+		char label[16];
+		snprintf (label, sizeof (label), "%d", i + 1);
+		print_startup (label, host_ms, &st);
+		fflush (stdout);
+
+		accumulate (&sum.total, &max.total, st.total);
+		accumulate (&sum.settings, &max.settings, st.settings);
+		accumulate (&sum.synth, &max.synth, st.synth);
+		accumulate (&sum.sfload, &max.sfload, st.sfload);
+		accumulate (&sum.presets, &max.presets, st.presets);
+		accumulate (&sum.bootstrap, &max.bootstrap, st.bootstrap);
+		sum.allocations += st.allocations;
+		max.allocations = st.allocations > max.allocations ? st.allocations : max.allocations;
+		sum.peak_rss_kib += st.peak_rss_kib;
+		max.peak_rss_kib = st.peak_rss_kib > max.peak_rss_kib ? st.peak_rss_kib : max.peak_rss_kib;
+		sum_host += host_ms;
+		if (host_ms > max_host) {
+			max_host = host_ms;
+		}
+	}
+
+	if (ok && n > 1) {
+		GMSynth_Startup_Stats mean = sum;
+		mean.total /= n;
+		mean.settings /= n;
+		mean.synth /= n;
+		mean.sfload /= n;
+		mean.presets /= n;
+		mean.bootstrap /= n;
+		mean.allocations /= n;
+		mean.peak_rss_kib /= n;
+		print_startup ("mean", sum_host / n, &mean);
+		print_startup ("max", max_host, &max);
+		print_startup ("sum", sum_host, &sum);
+	}
+
+	const GMSynth_Memory_Interface* mi = (const GMSynth_Memory_Interface*)b->desc->extension_data (GMSYNTH_STATS__memory);
+	if (ok && mi) {
+		GMSynth_Memory_Stats ms;
+		printf ("\n%8s %9s %9s %9s %9s %9s %9s %9s %9s %9s\n",
+		        "[KiB]", "samples", "mipmaps", "presets", "voices", "mixer", "fx", "events", "total", "locked");
+		mi->get (h[0], &ms);
+		print_memory ("inst", &ms);
+		mi->get_process (&ms);
+		print_memory ("process", &ms);
+	}
+
+	for (int i = 0; i < n && h[i]; ++i) {
+		b->desc->cleanup (h[i]);
+	}
+	free (h);
+	return ok;
+}
+
+/* *****************************************************************************
+ * main
+ */
+
+static void
+usage (int status)
+{
+	printf ("gmsynth-lv2bench - Polyphony scaling benchmark of the gmsynth.lv2 plugin.\n\n");
+	printf ("Usage: gmsynth-lv2bench [ OPTIONS ] [ <bundle-dir> ]\n\n");
+	printf ("Options:\n"
+	        "  -b, --blocks <list>      Block sizes (default 16,64,256,1024,4096)\n"
+	        "  -d, --duration <sec>     Measured audio per configuration (default 5)\n"
+	        "  -F, --freewheel          Freewheel: offline interpolation, no load governor\n"
+	        "  -h, --help               Display this help and exit\n"
+	        "  -n, --notes <list>       Simultaneous notes (default 16,64,128,256)\n"
+	        "  -p, --presets <list>     Any of piano,pads,drums,mix (default all)\n"
+	        "  -r, --rates <list>       Sample rates (default 44100,48000,96000)\n"
+	        "  -S, --startup <n>        Profile the startup of n instances instead,\n"
+	        "                           at the first sample rate of the list\n\n");
+	printf ("Loads gmsynth" LIB_EXT " from the bundle directory (default build/) and\n"
+	        "renders a synthetic score for every combination of the lists, without\n"
+	        "any audio or MIDI I/O. Per configuration the realtime factor, mean and\n"
+	        "worst-case time of run() are printed, along with the sum of the per\n"
+	        "channel peak voice counts reported by the plugin and the number of\n"
+	        "instances that fit one core if their worst cases coincide.\n\n"
+	        "With a debug build of the plugin (make RTCHECK=yes), allocations, locks\n"
+	        "and file I/O inside run() are reported and make the benchmark fail.\n\n"
+	        "The startup profile lists the time of each phase of instantiate() in\n"
+	        "milliseconds as reported by the plugin, along with the time seen by the\n"
+	        "host, the synth engine's allocations and the growth of the peak RSS,\n"
+	        "followed by the memory of one instance and of all instances in KiB.\n"
+	        "Sample data is shared by the instances, the process counts it once.\n");
+	exit (status);
+}
+
+static int
+parse_list (const char* arg, int* list)
+{
+	int   n   = 0;
+	char* tmp = strdup (arg);
+	char* save;
+
+	for (char* tok = strtok_r (tmp, ",", &save); tok && n < MAX_LIST; tok = strtok_r (NULL, ",", &save)) {
+		list[n] = atoi (tok);
+		for (int p = 0; p < 4; ++p) {
+			if (!strcmp (tok, preset_names[p])) {
+				list[n] = p;
+			}
+		}
+		++n;
+	}
+	free (tmp);
+	return n;
+}
+
+int
+main (int argc, char** argv)
+{
+	static const struct option long_options[] = {
+		{ "blocks",    required_argument, 0, 'b' },
+		{ "duration",  required_argument, 0, 'd' },
+		{ "freewheel", no_argument,       0, 'F' },
+		{ "help",      no_argument,       0, 'h' },
+		{ "notes",     required_argument, 0, 'n' },
+		{ "presets",   required_argument, 0, 'p' },
+		{ "rates",     required_argument, 0, 'r' },
+		{ "startup",   required_argument, 0, 'S' },
+		{ 0, 0, 0, 0 }
+	};
+
+	Bench b;
+	memset (&b, 0, sizeof (b));
+	b.n_rates   = parse_list ("44100,48000,96000", b.rates);
+	b.n_blocks  = parse_list ("16,64,256,1024,4096", b.blocks);
+	b.n_notes   = parse_list ("16,64,128,256", b.notes);
+	b.n_presets = parse_list ("piano,pads,drums,mix", b.presets);
+	b.duration  = 5;
+	b.bundle    = "build/";
+
+	int c;
+	while ((c = getopt_long (argc, argv, "b:d:Fhn:p:r:S:", long_options, NULL)) != -1) {
+		switch (c) {
+			case 'b':
+				b.n_blocks = parse_list (optarg, b.blocks);
+				break;
+			case 'd':
+				b.duration = atof (optarg);
+				break;
+			case 'F':
+				b.freewheel = true;
+				break;
+			case 'h':
+				usage (EXIT_SUCCESS);
+				break;
+			case 'n':
+				b.n_notes = parse_list (optarg, b.notes);
+				break;
+			case 'p':
+				b.n_presets = parse_list (optarg, b.presets);
+				break;
+			case 'r':
+				b.n_rates = parse_list (optarg, b.rates);
+				break;
+			case 'S':
+				b.startup = atoi (optarg);
+				if (b.startup < 1) {
+					usage (EXIT_FAILURE);
+				}
+				break;
+			default:
+				usage (EXIT_FAILURE);
+				break;
+		}
+	}
+
+	if (optind < argc) {
+		b.bundle = argv[optind++];
+	}
+
+	if (optind != argc || b.duration <= 0) {
+		usage (EXIT_FAILURE);
+	}
+
+	for (int i = 0; i < b.n_rates; ++i) {
+		if (b.rates[i] < 8000 || b.rates[i] > 192000) {
+			usage (EXIT_FAILURE);
+		}
+	}
+	for (int i = 0; i < b.n_blocks; ++i) {
+		if (b.blocks[i] < 1 || b.blocks[i] > MAX_BLOCK) {
+			usage (EXIT_FAILURE);
+		}
+	}
+	for (int i = 0; i < b.n_presets; ++i) {
+		if (b.presets[i] < PRESET_PIANO || b.presets[i] > PRESET_MIX) {
+			usage (EXIT_FAILURE);
+		}
+	}
+
+	char path[1024];
+	snprintf (path, sizeof (path), "%s/gmsynth" LIB_EXT, b.bundle);
+
+	b.lib = dlopen (path, RTLD_NOW | RTLD_LOCAL);
+	if (!b.lib) {
+		fprintf (stderr, "gmsynth-lv2bench: %s\n", dlerror ());
+		return EXIT_FAILURE;
+	}
+
+	LV2_Descriptor_Function lv2_descriptor = (LV2_Descriptor_Function)dlsym (b.lib, "lv2_descriptor");
+	b.desc = lv2_descriptor ? lv2_descriptor (0) : NULL;
+	if (!b.desc) {
+		fprintf (stderr, "gmsynth-lv2bench: '%s' has no plugin\n", path);
+		dlclose (b.lib);
+		return EXIT_FAILURE;
+	}
+
+	log_Trace = map_uri (NULL, LV2_LOG__Trace);
+
+	if (b.startup > 0) {
+		const bool ok = run_startup (&b, b.rates[0], b.startup);
+		dlclose (b.lib);
+		free_uris ();
+		return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	int n_failed = 0;
+
+	printf ("%6s %6s %6s %6s %6s %10s %10s %10s %8s %9s\n",
+	        "rate", "block", "preset", "notes", "voices", "rt-factor", "avg[us]", "worst[us]", "worst[%]", "inst/core");
+
+	for (int ri = 0; ri < b.n_rates; ++ri) {
+		for (int bi = 0; bi < b.n_blocks; ++bi) {
+			for (int pi = 0; pi < b.n_presets; ++pi) {
+				for (int ni = 0; ni < b.n_notes; ++ni) {
+					Result r;
+					if (!run_config (&b, b.rates[ri], b.blocks[bi], b.presets[pi], b.notes[ni], &r)) {
+						++n_failed;
+						continue;
+					}
+					printf ("%6d %6d %6s %6d %6d %10.1f %10.1f %10.1f %8.1f %9d\n",
+					        b.rates[ri], b.blocks[bi], preset_names[b.presets[pi]], b.notes[ni], r.voices,
+					        r.rtf, r.avg_us, r.worst_us, r.worst_pct, r.worst_pct > 0 ? (int)floor (100. / r.worst_pct) : 0);
+					fflush (stdout);
+					if (r.rt_errors > 0) {
+						fprintf (stderr, "gmsynth-lv2bench: %u real-time safety violation(s) in run()\n", r.rt_errors);
+						++n_failed;
+					}
+				}
+			}
+		}
+	}
+
+	dlclose (b.lib);
+	free_uris ();
+	return n_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,776 @@
+/* gmsynth-render -- render standard MIDI files with the gmsynth engine
+ *
+ * Copyright (C) 2016,2017 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <getopt.h>
+#include <libgen.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fluidsynth.h"
+
+#define BLOCK_SIZE    1024  // frames per fluid_synth_write_float() call
+#define MAX_TAIL_SEC  10    // max. release tail rendered after the last event
+
+/* default tolerances of the comparison with reference renders */
+#define TOL_MAX_ABS   1e-4  // -80 dBFS
+#define TOL_RMS       1e-5  // -100 dBFS
+#define TOL_SPECTRAL  -60.  // dB, magnitude spectrum error relative to the reference
+
+typedef struct {
+	char*  name;     // MIDI file name without extension, NULL for the defaults
+	double max_abs;  // largest error of any sample
+	double rms;      // RMS of the error
+	double spectral; // dB, see Compare
+} Tolerance;
+
+typedef struct {
+	/* options */
+	const char* sf2;
+	const char* outdir;
+	const char* refdir;
+	double      rate;
+	bool        wav;
+	int         interp;
+
+	/* comparison, per file tolerances from <refdir>/tolerances */
+	Tolerance  tol;
+	Tolerance* file_tol;
+	int        n_file_tol;
+
+	/* jobs */
+	char**          files;
+	int             n_files;
+	int             next_file;
+	int             n_failed;
+	pthread_mutex_t lock;
+} Renderer;
+
+/* *****************************************************************************
+ * output
+ */
+
+static void
+write_u32 (FILE* f, uint32_t v)
+{
+	const uint8_t b[4] = { v & 0xff, (v >> 8) & 0xff, (v >> 16) & 0xff, (v >> 24) & 0xff };
+	fwrite (b, 1, 4, f);
+}
+
+static void
+write_u16 (FILE* f, uint16_t v)
+{
+	const uint8_t b[2] = { v & 0xff, (v >> 8) & 0xff };
+	fwrite (b, 1, 2, f);
+}
+
+/* 32bit float stereo RIFF/WAVE header, called again with the final length */
+static void
+write_wav_header (FILE* f, uint32_t rate, uint32_t n_frames)
+{
+	const uint32_t data_size = n_frames * 2 * sizeof (float);
+	fseek (f, 0, SEEK_SET);
+	fwrite ("RIFF", 1, 4, f);
+	write_u32 (f, 36 + data_size);
+	fwrite ("WAVEfmt ", 1, 8, f);
+	write_u32 (f, 16);
+	write_u16 (f, 3); // WAVE_FORMAT_IEEE_FLOAT
+	write_u16 (f, 2);
+	write_u32 (f, rate);
+	write_u32 (f, rate * 2 * sizeof (float));
+	write_u16 (f, 2 * sizeof (float));
+	write_u16 (f, 32);
+	fwrite ("data", 1, 4, f);
+	write_u32 (f, data_size);
+}
+
+/* interleave and write, native endian */
+static void
+write_block (FILE* f, const float* l, const float* r, uint32_t n_frames)
+{
+	float buf[2 * BLOCK_SIZE];
+	for (uint32_t i = 0; i < n_frames; ++i) {
+		buf[2 * i]     = l[i];
+		buf[2 * i + 1] = r[i];
+	}
+	fwrite (buf, sizeof (float), 2 * n_frames, f);
+}
+
+/* name of the MIDI file without directory and extension */
+static char*
+file_name (const char* midi_file)
+{
+	char* tmp  = strdup (midi_file);
+	char* name = strdup (basename (tmp));
+	char* dot  = strrchr (name, '.');
+	if (dot && dot != name) {
+		*dot = '\0';
+	}
+	free (tmp);
+	return name;
+}
+
+static char*
+output_path (const Renderer* rr, const char* midi_file, const char* outdir)
+{
+	char* name = file_name (midi_file);
+
+	char* rv = NULL;
+	if (outdir) {
+		if (asprintf (&rv, "%s/%s.%s", outdir, name, rr->wav ? "wav" : "raw") < 0) {
+			rv = NULL;
+		}
+	} else {
+		char* tmp2 = strdup (midi_file);
+		if (asprintf (&rv, "%s/%s.%s", dirname (tmp2), name, rr->wav ? "wav" : "raw") < 0) {
+			rv = NULL;
+		}
+		free (tmp2);
+	}
+	free (name);
+	return rv;
+}
+
+/* *****************************************************************************
+ * comparison with reference renders
+ *
+ * Besides the sample errors, the magnitude spectra of the output and the
+ * reference are compared per FFT_SIZE block and channel (Hann window, no
+ * overlap). The spectral difference is the energy of the magnitude error
+ * relative to the energy of the reference spectrum, in dB. It is
+ * insensitive to small phase shifts that dominate the sample errors of
+ * e.g. a filter computed in a different precision.
+ */
+
+#define FFT_SIZE BLOCK_SIZE
+
+typedef struct {
+	FILE*     f;          // reference
+	uint64_t  ref_frames; // frames in the reference
+	uint64_t  pos;        // frames compared
+
+	double    max_err;
+	uint64_t  max_at;
+	bool      bad;        // a sample exceeded the max_abs tolerance
+	uint64_t  first_bad;
+	int       first_chn;
+	float     first_ref;
+	float     first_out;
+	double    sq_err;
+	double    spec_err;
+	double    spec_ref;
+
+	Tolerance tol;
+} Compare;
+
+/* in-place radix-2 complex FFT, n must be a power of two */
+static void
+fft (double* re, double* im, int n)
+{
+	for (int i = 1, j = 0; i < n; ++i) {
+		int bit = n >> 1;
+		for (; j & bit; bit >>= 1) {
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j) {
+			double t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+	for (int len = 2; len <= n; len <<= 1) {
+		const double a = -2 * M_PI / len;
+		for (int i = 0; i < n; i += len) {
+			for (int k = 0; k < len / 2; ++k) {
+				const double wr = cos (a * k);
+				const double wi = sin (a * k);
+				double* ur = &re[i + k];
+				double* ui = &im[i + k];
+				double* vr = &re[i + k + len / 2];
+				double* vi = &im[i + k + len / 2];
+				const double xr = *vr * wr - *vi * wi;
+				const double xi = *vr * wi + *vi * wr;
+				*vr = *ur - xr;
+				*vi = *ui - xi;
+				*ur += xr;
+				*ui += xi;
+			}
+		}
+	}
+}
+
+/* windowed magnitude spectrum of one channel of an interleaved block */
+static void
+magnitudes (const float* buf, int chn, uint32_t n_frames, double* mag)
+{
+	double re[FFT_SIZE];
+	double im[FFT_SIZE];
+	for (uint32_t i = 0; i < FFT_SIZE; ++i) {
+		const double w = .5 - .5 * cos (2 * M_PI * i / FFT_SIZE);
+		re[i] = i < n_frames ? w * buf[2 * i + chn] : 0;
+		im[i] = 0;
+	}
+	fft (re, im, FFT_SIZE);
+	for (uint32_t i = 0; i <= FFT_SIZE / 2; ++i) {
+		mag[i] = sqrt (re[i] * re[i] + im[i] * im[i]);
+	}
+}
+
+static const Tolerance*
+find_tolerance (const Renderer* rr, const char* name)
+{
+	for (int i = 0; i < rr->n_file_tol; ++i) {
+		if (!strcmp (rr->file_tol[i].name, name)) {
+			return &rr->file_tol[i];
+		}
+	}
+	return &rr->tol;
+}
+
+/* '<name> <max-abs> <rms> <spectral-dB>' per line, '#' starts a comment */
+static bool
+read_tolerances (Renderer* rr)
+{
+	char* path = NULL;
+	if (asprintf (&path, "%s/tolerances", rr->refdir) < 0) {
+		return false;
+	}
+	FILE* f = fopen (path, "r");
+	free (path);
+	if (!f) {
+		return true;
+	}
+
+	char line[1024];
+	char name[1024];
+	Tolerance t;
+	while (fgets (line, sizeof (line), f)) {
+		if (line[0] == '#' || sscanf (line, "%1023s %lf %lf %lf", name, &t.max_abs, &t.rms, &t.spectral) != 4) {
+			continue;
+		}
+		Tolerance* tmp = realloc (rr->file_tol, (rr->n_file_tol + 1) * sizeof (Tolerance));
+		if (!tmp) {
+			break;
+		}
+		t.name       = strdup (name);
+		rr->file_tol = tmp;
+		rr->file_tol[rr->n_file_tol++] = t;
+	}
+	fclose (f);
+	return true;
+}
+
+/* open the reference render and skip to its audio data */
+static bool
+compare_open (const Renderer* rr, Compare* cmp, const char* midi_file)
+{
+	memset (cmp, 0, sizeof (Compare));
+
+	char* name = file_name (midi_file);
+	char* path = output_path (rr, midi_file, rr->refdir);
+	cmp->tol   = *find_tolerance (rr, name);
+	cmp->f     = path ? fopen (path, "rb") : NULL;
+	free (name);
+
+	if (!cmp->f) {
+		fprintf (stderr, "gmsynth-render: cannot open reference '%s'\n", path ? path : midi_file);
+		free (path);
+		return false;
+	}
+
+	uint64_t data_size;
+	if (rr->wav) {
+		/* RIFF/WAVE, 32bit float stereo */
+		uint8_t  hdr[12];
+		uint8_t  chunk[8];
+		uint16_t fmt[8] = { 0 };
+		bool     fmt_ok = false;
+		if (fread (hdr, 1, 12, cmp->f) != 12 || memcmp (hdr, "RIFF", 4) || memcmp (hdr + 8, "WAVE", 4)) {
+			goto bad_format;
+		}
+		while (true) {
+			if (fread (chunk, 1, 8, cmp->f) != 8) {
+				goto bad_format;
+			}
+			const uint32_t size = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((uint32_t)chunk[7] << 24);
+			if (!memcmp (chunk, "fmt ", 4) && size >= 16) {
+				uint8_t b[16];
+				if (fread (b, 1, 16, cmp->f) != 16 || fseek (cmp->f, size - 16 + (size & 1), SEEK_CUR)) {
+					goto bad_format;
+				}
+				for (int i = 0; i < 8; ++i) {
+					fmt[i] = b[2 * i] | (b[2 * i + 1] << 8);
+				}
+				/* format 3 (float), 2 channels, 32 bits per sample */
+				fmt_ok = fmt[0] == 3 && fmt[1] == 2 && fmt[7] == 32;
+			} else if (!memcmp (chunk, "data", 4)) {
+				data_size = size;
+				break;
+			} else if (fseek (cmp->f, size + (size & 1), SEEK_CUR)) {
+				goto bad_format;
+			}
+		}
+		if (!fmt_ok) {
+			goto bad_format;
+		}
+	} else {
+		if (fseek (cmp->f, 0, SEEK_END)) {
+			goto bad_format;
+		}
+		data_size = ftell (cmp->f);
+		rewind (cmp->f);
+	}
+
+	cmp->ref_frames = data_size / (2 * sizeof (float));
+	free (path);
+	return true;
+
+bad_format:
+	fprintf (stderr, "gmsynth-render: '%s' is not a 32bit float stereo %s file\n", path, rr->wav ? "wav" : "raw");
+	fclose (cmp->f);
+	cmp->f = NULL;
+	free (path);
+	return false;
+}
+
+static void
+compare_block (Compare* cmp, const float* l, const float* r, uint32_t n_frames)
+{
+	float out[2 * BLOCK_SIZE];
+	float ref[2 * BLOCK_SIZE];
+
+	for (uint32_t i = 0; i < n_frames; ++i) {
+		out[2 * i]     = l[i];
+		out[2 * i + 1] = r[i];
+	}
+
+	/* the reference is padded with silence if it is shorter */
+	const size_t n_ref = fread (ref, sizeof (float), 2 * n_frames, cmp->f);
+	memset (&ref[n_ref], 0, (2 * n_frames - n_ref) * sizeof (float));
+
+	for (uint32_t i = 0; i < 2 * n_frames; ++i) {
+		const double err = fabs ((double)out[i] - ref[i]);
+		cmp->sq_err += err * err;
+		if (err > cmp->max_err) {
+			cmp->max_err = err;
+			cmp->max_at  = cmp->pos + i / 2;
+		}
+		if (err > cmp->tol.max_abs && !cmp->bad) {
+			cmp->bad       = true;
+			cmp->first_bad = cmp->pos + i / 2;
+			cmp->first_chn = i & 1;
+			cmp->first_ref = ref[i];
+			cmp->first_out = out[i];
+		}
+	}
+
+	double mag_out[FFT_SIZE / 2 + 1];
+	double mag_ref[FFT_SIZE / 2 + 1];
+	for (int c = 0; c < 2; ++c) {
+		magnitudes (out, c, n_frames, mag_out);
+		magnitudes (ref, c, n_frames, mag_ref);
+		for (int i = 0; i <= FFT_SIZE / 2; ++i) {
+			const double d = mag_out[i] - mag_ref[i];
+			cmp->spec_err += d * d;
+			cmp->spec_ref += mag_ref[i] * mag_ref[i];
+		}
+	}
+
+	cmp->pos += n_frames;
+}
+
+/* print the result, returns true if all tolerances are met */
+static bool
+compare_close (Compare* cmp, const char* midi_file)
+{
+	fclose (cmp->f);
+	cmp->f = NULL;
+
+	char* name = file_name (midi_file);
+
+	/* the remainder of a longer reference counts as error, too */
+	const bool   same_length = cmp->ref_frames == cmp->pos;
+	const double rms         = cmp->pos > 0 ? sqrt (cmp->sq_err / (2. * cmp->pos)) : 0;
+	double       spectral;
+	if (cmp->spec_err == 0) {
+		spectral = -INFINITY;
+	} else if (cmp->spec_ref == 0) {
+		spectral = INFINITY;
+	} else {
+		spectral = 10 * log10 (cmp->spec_err / cmp->spec_ref);
+	}
+
+	const bool ok = same_length && !cmp->bad && rms <= cmp->tol.rms && spectral <= cmp->tol.spectral;
+
+	/* keep the lines of a file together, workers finish concurrently */
+	flockfile (stdout);
+	printf ("%s %s: max-abs %.3g (frame %llu) rms %.3g spectral %.1f dB\n",
+	        ok ? "PASS" : "FAIL", name, cmp->max_err, (unsigned long long)cmp->max_at, rms, spectral);
+
+	if (!same_length) {
+		printf ("  length differs: %llu frames, reference %llu frames\n",
+		        (unsigned long long)cmp->pos, (unsigned long long)cmp->ref_frames);
+	}
+	if (cmp->bad) {
+		printf ("  first sample off by more than %g: frame %llu %s, %.9g instead of %.9g\n",
+		        cmp->tol.max_abs, (unsigned long long)cmp->first_bad, cmp->first_chn ? "right" : "left",
+		        cmp->first_out, cmp->first_ref);
+	}
+	if (rms > cmp->tol.rms) {
+		printf ("  rms error above %g\n", cmp->tol.rms);
+	}
+	if (spectral > cmp->tol.spectral) {
+		printf ("  spectral difference above %.1f dB\n", cmp->tol.spectral);
+	}
+	fflush (stdout);
+	funlockfile (stdout);
+
+	free (name);
+	return ok;
+}
+
+/* *****************************************************************************
+ * rendering
+ */
+
+static bool
+render_file (const Renderer* rr, fluid_synth_t* synth, const char* midi_file)
+{
+	if (!fluid_is_midifile (midi_file)) {
+		fprintf (stderr, "gmsynth-render: '%s' is not a MIDI file\n", midi_file);
+		return false;
+	}
+
+	/* compare with the reference instead of writing the output */
+	Compare cmp;
+	if (rr->refdir && !compare_open (rr, &cmp, midi_file)) {
+		return false;
+	}
+
+	char* out_file = rr->refdir ? NULL : output_path (rr, midi_file, rr->outdir);
+	FILE* f        = out_file ? fopen (out_file, "wb") : NULL;
+	if (!f && !rr->refdir) {
+		fprintf (stderr, "gmsynth-render: cannot open '%s' for writing\n", out_file ? out_file : midi_file);
+		free (out_file);
+		return false;
+	}
+
+	fluid_player_t* player = new_fluid_player (synth);
+	if (!player || fluid_player_add (player, midi_file) != FLUID_OK || fluid_player_play (player) != FLUID_OK) {
+		fprintf (stderr, "gmsynth-render: cannot play '%s'\n", midi_file);
+		delete_fluid_player (player);
+		if (f) {
+			fclose (f);
+		}
+		if (rr->refdir) {
+			fclose (cmp.f);
+		}
+		free (out_file);
+		return false;
+	}
+
+	if (f && rr->wav) {
+		write_wav_header (f, rr->rate, 0);
+	}
+
+	float    l[BLOCK_SIZE];
+	float    r[BLOCK_SIZE];
+	uint64_t n_frames = 0;
+	uint64_t tail     = 0;
+
+	/* the player is driven by the synth's sample timer: render until all
+	 * events are played, then until the last voice has decayed */
+	while (tail < MAX_TAIL_SEC * rr->rate) {
+		fluid_synth_write_float (synth, BLOCK_SIZE, l, 0, 1, r, 0, 1);
+		if (f) {
+			write_block (f, l, r, BLOCK_SIZE);
+		} else {
+			compare_block (&cmp, l, r, BLOCK_SIZE);
+		}
+		n_frames += BLOCK_SIZE;
+
+		if (fluid_player_get_status (player) == FLUID_PLAYER_PLAYING) {
+			continue;
+		}
+		if (fluid_synth_get_active_voice_count (synth) == 0) {
+			break;
+		}
+		tail += BLOCK_SIZE;
+	}
+
+	delete_fluid_player (player);
+	fluid_synth_system_reset (synth);
+	fluid_synth_set_interp_method (synth, -1, rr->interp);
+
+	if (rr->refdir) {
+		return compare_close (&cmp, midi_file);
+	}
+
+	if (rr->wav) {
+		write_wav_header (f, rr->rate, n_frames > UINT32_MAX / 8 ? UINT32_MAX / 8 : n_frames);
+	}
+
+	bool ok = !ferror (f);
+	if (fclose (f) || !ok) {
+		fprintf (stderr, "gmsynth-render: error writing '%s'\n", out_file);
+		ok = false;
+	}
+	free (out_file);
+	return ok;
+}
+
+/* one worker per core, each with its own synth instance */
+static void*
+worker (void* arg)
+{
+	Renderer* rr = (Renderer*)arg;
+
+	fluid_settings_t* settings = new_fluid_settings ();
+	if (!settings) {
+		return NULL;
+	}
+
+	fluid_settings_setnum (settings, "synth.sample-rate", rr->rate);
+	fluid_settings_setint (settings, "synth.threadsafe-api", 0);
+	fluid_settings_setstr (settings, "synth.midi-bank-select", "mma");
+	fluid_settings_setint (settings, "synth.audio-channels", 1);
+	fluid_settings_setstr (settings, "player.timing-source", "sample");
+	/* the synth is reset after each file, a reset by the player would
+	 * discard the interpolation method set below */
+	fluid_settings_setint (settings, "player.reset-synth", 0);
+
+	/* fluidsynth's one-time global initialization is not safe to race,
+	 * set up one synth at a time */
+	pthread_mutex_lock (&rr->lock);
+	fluid_synth_t* synth = new_fluid_synth (settings);
+
+	if (!synth || fluid_synth_sfload (synth, rr->sf2, 1) == FLUID_FAILED) {
+		fprintf (stderr, "gmsynth-render: cannot load SoundFont '%s'\n", rr->sf2);
+		rr->n_failed += rr->n_files - rr->next_file;
+		rr->next_file = rr->n_files;
+		pthread_mutex_unlock (&rr->lock);
+		delete_fluid_synth (synth);
+		delete_fluid_settings (settings);
+		return NULL;
+	}
+	pthread_mutex_unlock (&rr->lock);
+
+	fluid_synth_set_gain (synth, 1.0f);
+	fluid_synth_set_polyphony (synth, 256);
+	fluid_synth_set_interp_method (synth, -1, rr->interp);
+
+	while (true) {
+		pthread_mutex_lock (&rr->lock);
+		const int i = rr->next_file++;
+		pthread_mutex_unlock (&rr->lock);
+
+		if (i >= rr->n_files) {
+			break;
+		}
+
+		if (!render_file (rr, synth, rr->files[i])) {
+			pthread_mutex_lock (&rr->lock);
+			++rr->n_failed;
+			pthread_mutex_unlock (&rr->lock);
+		}
+	}
+
+	delete_fluid_synth (synth);
+	delete_fluid_settings (settings);
+	return NULL;
+}
+
+/* *****************************************************************************
+ * main
+ */
+
+static void
+usage (int status)
+{
+	printf ("gmsynth-render - render Standard MIDI Files using the gmsynth engine.\n\n"
+	        "Usage: gmsynth-render [ OPTIONS ] <file.mid> [<file.mid> ...]\n\n"
+	        "Options:\n"
+	        "  -c, --compare <dir>  compare with the reference renders in this\n"
+	        "                       directory instead of writing output files\n"
+	        "  -f, --format <fmt>   output format: 'wav' (32bit float) or 'raw'\n"
+	        "                       (interleaved stereo float), default: wav\n"
+	        "  -h, --help           display this help and exit\n"
+	        "  -i, --interp <n>     interpolation: 0, 1, 4, 7 or 16 (sinc), default: 16\n"
+	        "  -j, --jobs <n>       number of files rendered in parallel,\n"
+	        "                       default: number of CPU cores\n"
+	        "  -o, --outdir <dir>   write output files to this directory,\n"
+	        "                       default: next to each MIDI file\n"
+	        "  -r, --rate <hz>      sample rate, default: 48000\n"
+	        "  -s, --sf2 <file>     SoundFont, default: GeneralUser_LV2.sf2 next to\n"
+	        "                       this executable\n"
+	        "  -t, --tolerance <max-abs>,<rms>,<spectral-dB>\n"
+	        "                       default tolerances of the comparison,\n"
+	        "                       default: %g,%g,%g\n\n"
+	        "In compare mode every MIDI file is rendered and compared with the\n"
+	        "file of the same name and format in the reference directory. A file\n"
+	        "passes if the length matches, no sample is off by more than max-abs,\n"
+	        "and neither the RMS error nor the spectral difference exceed their\n"
+	        "tolerance. Per file tolerances may be given in <dir>/tolerances, one\n"
+	        "'<name> <max-abs> <rms> <spectral-dB>' line per file. The exit status\n"
+	        "is non-zero if any file fails.\n", TOL_MAX_ABS, TOL_RMS, TOL_SPECTRAL);
+	exit (status);
+}
+
+int
+main (int argc, char** argv)
+{
+	static const struct option long_options[] = {
+		{ "compare",   required_argument, 0, 'c' },
+		{ "format",    required_argument, 0, 'f' },
+		{ "help",      no_argument,       0, 'h' },
+		{ "interp",    required_argument, 0, 'i' },
+		{ "jobs",      required_argument, 0, 'j' },
+		{ "outdir",    required_argument, 0, 'o' },
+		{ "rate",      required_argument, 0, 'r' },
+		{ "sf2",       required_argument, 0, 's' },
+		{ "tolerance", required_argument, 0, 't' },
+		{ 0, 0, 0, 0 }
+	};
+
+	Renderer rr;
+	memset (&rr, 0, sizeof (rr));
+	rr.rate   = 48000;
+	rr.wav    = true;
+	rr.interp = FLUID_INTERP_SINC;
+	rr.tol.max_abs  = TOL_MAX_ABS;
+	rr.tol.rms      = TOL_RMS;
+	rr.tol.spectral = TOL_SPECTRAL;
+
+	long n_jobs = sysconf (_SC_NPROCESSORS_ONLN);
+	char* sf2   = NULL;
+
+	int c;
+	while ((c = getopt_long (argc, argv, "c:f:hi:j:o:r:s:t:", long_options, NULL)) != -1) {
+		switch (c) {
+			case 'c':
+				rr.refdir = optarg;
+				break;
+			case 'f':
+				if (!strcmp (optarg, "wav")) {
+					rr.wav = true;
+				} else if (!strcmp (optarg, "raw")) {
+					rr.wav = false;
+				} else {
+					usage (EXIT_FAILURE);
+				}
+				break;
+			case 'h':
+				usage (EXIT_SUCCESS);
+				break;
+			case 'i':
+				rr.interp = atoi (optarg);
+				break;
+			case 'j':
+				n_jobs = atol (optarg);
+				break;
+			case 'o':
+				rr.outdir = optarg;
+				break;
+			case 'r':
+				rr.rate = atof (optarg);
+				break;
+			case 's':
+				rr.sf2 = optarg;
+				break;
+			case 't':
+				if (sscanf (optarg, "%lf,%lf,%lf", &rr.tol.max_abs, &rr.tol.rms, &rr.tol.spectral) != 3) {
+					usage (EXIT_FAILURE);
+				}
+				break;
+			default:
+				usage (EXIT_FAILURE);
+				break;
+		}
+	}
+
+	if (optind >= argc || rr.rate < 8000 || rr.rate > 192000) {
+		usage (EXIT_FAILURE);
+	}
+
+	if (!rr.sf2) {
+		char* tmp = strdup (argv[0]);
+		if (asprintf (&sf2, "%s/GeneralUser_LV2.sf2", dirname (tmp)) < 0) {
+			sf2 = NULL;
+		}
+		free (tmp);
+		rr.sf2 = sf2;
+	}
+
+	if (rr.refdir && !read_tolerances (&rr)) {
+		return EXIT_FAILURE;
+	}
+
+	rr.files   = &argv[optind];
+	rr.n_files = argc - optind;
+
+	if (n_jobs < 1) {
+		n_jobs = 1;
+	}
+	if (n_jobs > rr.n_files) {
+		n_jobs = rr.n_files;
+	}
+
+	pthread_mutex_init (&rr.lock, NULL);
+
+	pthread_t* threads = calloc (n_jobs, sizeof (pthread_t));
+	long n_threads     = 0;
+
+	while (threads && n_threads < n_jobs) {
+		if (pthread_create (&threads[n_threads], NULL, worker, &rr)) {
+			break;
+		}
+		++n_threads;
+	}
+
+	if (n_threads == 0) {
+		/* no threads, render in this one */
+		worker (&rr);
+	}
+
+	for (long i = 0; i < n_threads; ++i) {
+		pthread_join (threads[i], NULL);
+	}
+
+	free (threads);
+	free (sf2);
+	for (int i = 0; i < rr.n_file_tol; ++i) {
+		free (rr.file_tol[i].name);
+	}
+	free (rr.file_tol);
+	pthread_mutex_destroy (&rr.lock);
+
+	if (rr.n_failed > 0) {
+		fprintf (stderr, "gmsynth-render: %d of %d file(s) failed\n", rr.n_failed, rr.n_files);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
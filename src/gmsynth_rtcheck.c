@@ -0,0 +1,341 @@
+/* real-time safety checker, debug builds only: make RTCHECK=yes
+ *
+ * Copyright (C) 2016,2017 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The plugin is linked with `ld --wrap=<fn>` for each function below:
+ * calls made by the plugin and the fluidsynth engine it contains are
+ * routed to __wrap_<fn>, which records the call when the thread is
+ * inside run (), and passes it on to the C library as __real_<fn>.
+ * Calls made by the host or other libraries are not affected.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <execinfo.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "gmsynth_rtcheck.h"
+
+#define SKIP_FRAMES 2 // rtcheck_record () and the wrapper
+
+static __thread RTCheck* rt_current = NULL;
+
+void
+rtcheck_init (void)
+{
+	/* the first backtrace () loads the unwinder, do that here
+	 * rather than on the realtime thread */
+	void* frame;
+	backtrace (&frame, 1);
+}
+
+void
+rtcheck_enter (RTCheck* rc)
+{
+	rt_current = rc;
+}
+
+void
+rtcheck_leave (void)
+{
+	rt_current = NULL;
+}
+
+uint32_t
+rtcheck_violations (const RTCheck* rc)
+{
+	return __atomic_load_n (&rc->violations, __ATOMIC_ACQUIRE);
+}
+
+static __attribute__ ((noinline)) void
+rtcheck_record (const char* call, size_t size)
+{
+	RTCheck* rc = rt_current;
+	if (!rc) {
+		return;
+	}
+
+	/* calls made while recording are not violations of their own */
+	rt_current = NULL;
+
+	void* frames[RTCHECK_MAX_FRAMES + SKIP_FRAMES];
+	int   n_frames = backtrace (frames, RTCHECK_MAX_FRAMES + SKIP_FRAMES) - SKIP_FRAMES;
+	if (n_frames < 0) {
+		n_frames = 0;
+	}
+
+	const uint32_t n_records = rc->n_records;
+	for (uint32_t i = 0; i < n_records; ++i) {
+		RTCheckRecord* r = &rc->records[i];
+		if (r->call == call && r->n_frames == n_frames && !memcmp (r->frames, &frames[SKIP_FRAMES], n_frames * sizeof (void*))) {
+			++r->count;
+			goto out;
+		}
+	}
+
+	if (n_records < RTCHECK_MAX_RECORDS) {
+		RTCheckRecord* r = &rc->records[n_records];
+		r->call     = call;
+		r->size     = size;
+		r->count    = 1;
+		r->n_frames = n_frames;
+		memcpy (r->frames, &frames[SKIP_FRAMES], n_frames * sizeof (void*));
+		__atomic_store_n (&rc->n_records, n_records + 1, __ATOMIC_RELEASE);
+	}
+
+out:
+	__atomic_add_fetch (&rc->violations, 1, __ATOMIC_RELEASE);
+	rt_current = rc;
+}
+
+/* *****************************************************************************
+ * memory
+ */
+
+extern void* __real_malloc (size_t);
+extern void* __real_calloc (size_t, size_t);
+extern void* __real_realloc (void*, size_t);
+extern void  __real_free (void*);
+extern char* __real_strdup (const char*);
+extern int   __real_mlock (const void*, size_t);
+extern int   __real_munlock (const void*, size_t);
+
+void*
+__wrap_malloc (size_t size)
+{
+	rtcheck_record ("malloc", size);
+	return __real_malloc (size);
+}
+
+void*
+__wrap_calloc (size_t n, size_t size)
+{
+	rtcheck_record ("calloc", n * size);
+	return __real_calloc (n, size);
+}
+
+void*
+__wrap_realloc (void* ptr, size_t size)
+{
+	rtcheck_record ("realloc", size);
+	return __real_realloc (ptr, size);
+}
+
+void
+__wrap_free (void* ptr)
+{
+	if (ptr) {
+		rtcheck_record ("free", 0);
+	}
+	__real_free (ptr);
+}
+
+char*
+__wrap_strdup (const char* s)
+{
+	rtcheck_record ("strdup", strlen (s) + 1);
+	return __real_strdup (s);
+}
+
+int
+__wrap_mlock (const void* addr, size_t len)
+{
+	rtcheck_record ("mlock", len);
+	return __real_mlock (addr, len);
+}
+
+int
+__wrap_munlock (const void* addr, size_t len)
+{
+	rtcheck_record ("munlock", len);
+	return __real_munlock (addr, len);
+}
+
+/* glib allocates with the C library from inside libglib, out of reach of
+ * the wrappers above; g_new () expands to g_malloc () or g_malloc_n () */
+extern void* __real_g_malloc (size_t);
+extern void* __real_g_malloc_n (size_t, size_t);
+
+void*
+__wrap_g_malloc (size_t size)
+{
+	rtcheck_record ("g_malloc", size);
+	return __real_g_malloc (size);
+}
+
+void*
+__wrap_g_malloc_n (size_t n, size_t size)
+{
+	rtcheck_record ("g_malloc_n", n * size);
+	return __real_g_malloc_n (n, size);
+}
+
+/* *****************************************************************************
+ * locks, sleep
+ */
+
+extern int __real_pthread_mutex_lock (pthread_mutex_t*);
+extern int __real_usleep (useconds_t);
+
+int
+__wrap_pthread_mutex_lock (pthread_mutex_t* mutex)
+{
+	rtcheck_record ("pthread_mutex_lock", 0);
+	return __real_pthread_mutex_lock (mutex);
+}
+
+/* fluid_mutex_lock () and fluid_rec_mutex_lock () expand to these, which
+ * lock inside libglib without calling the pthread_mutex_lock wrapper.
+ * The arguments are GMutex* and GRecMutex*, glib.h is not needed here. */
+extern void __real_g_mutex_lock (void*);
+extern int  __real_g_mutex_trylock (void*);
+extern void __real_g_rec_mutex_lock (void*);
+
+void
+__wrap_g_mutex_lock (void* mutex)
+{
+	rtcheck_record ("g_mutex_lock", 0);
+	__real_g_mutex_lock (mutex);
+}
+
+int
+__wrap_g_mutex_trylock (void* mutex)
+{
+	rtcheck_record ("g_mutex_trylock", 0);
+	return __real_g_mutex_trylock (mutex);
+}
+
+void
+__wrap_g_rec_mutex_lock (void* mutex)
+{
+	rtcheck_record ("g_rec_mutex_lock", 0);
+	__real_g_rec_mutex_lock (mutex);
+}
+
+int
+__wrap_usleep (useconds_t usec)
+{
+	rtcheck_record ("usleep", 0);
+	return __real_usleep (usec);
+}
+
+/* *****************************************************************************
+ * file I/O, FLUID_LOG
+ */
+
+extern FILE*   __real_fopen (const char*, const char*);
+extern int     __real_fclose (FILE*);
+extern size_t  __real_fread (void*, size_t, size_t, FILE*);
+extern int     __real_fseek (FILE*, long, int);
+extern long    __real_ftell (FILE*);
+extern int     __real_fflush (FILE*);
+extern ssize_t __real_read (int, void*, size_t);
+extern ssize_t __real_write (int, const void*, size_t);
+extern int     __real_vfprintf (FILE*, const char*, va_list);
+
+FILE*
+__wrap_fopen (const char* path, const char* mode)
+{
+	rtcheck_record ("fopen", 0);
+	return __real_fopen (path, mode);
+}
+
+int
+__wrap_fclose (FILE* f)
+{
+	rtcheck_record ("fclose", 0);
+	return __real_fclose (f);
+}
+
+size_t
+__wrap_fread (void* ptr, size_t size, size_t n, FILE* f)
+{
+	rtcheck_record ("fread", size * n);
+	return __real_fread (ptr, size, n, f);
+}
+
+int
+__wrap_fseek (FILE* f, long offset, int whence)
+{
+	rtcheck_record ("fseek", 0);
+	return __real_fseek (f, offset, whence);
+}
+
+long
+__wrap_ftell (FILE* f)
+{
+	rtcheck_record ("ftell", 0);
+	return __real_ftell (f);
+}
+
+int
+__wrap_fflush (FILE* f)
+{
+	rtcheck_record ("fflush", 0);
+	return __real_fflush (f);
+}
+
+ssize_t
+__wrap_read (int fd, void* buf, size_t count)
+{
+	rtcheck_record ("read", count);
+	return __real_read (fd, buf, count);
+}
+
+ssize_t
+__wrap_write (int fd, const void* buf, size_t count)
+{
+	rtcheck_record ("write", count);
+	return __real_write (fd, buf, count);
+}
+
+int
+__wrap_vfprintf (FILE* f, const char* fmt, va_list ap)
+{
+	rtcheck_record ("vfprintf", 0);
+	return __real_vfprintf (f, fmt, ap);
+}
+
+int
+__wrap_fprintf (FILE* f, const char* fmt, ...)
+{
+	rtcheck_record ("fprintf", 0);
+	va_list ap;
+	va_start (ap, fmt);
+	const int rv = __real_vfprintf (f, fmt, ap);
+	va_end (ap);
+	return rv;
+}
+
+int
+__wrap_printf (const char* fmt, ...)
+{
+	rtcheck_record ("printf", 0);
+	va_list ap;
+	va_start (ap, fmt);
+	const int rv = __real_vfprintf (stdout, fmt, ap);
+	va_end (ap);
+	return rv;
+}
@@ -0,0 +1,64 @@
+/* real-time safety checker, debug builds only: make RTCHECK=yes
+ *
+ * Copyright (C) 2016,2017 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GMSYNTH_RTCHECK_H
+#define GMSYNTH_RTCHECK_H
+
+#ifdef WITH_RTCHECK
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RTCHECK_MAX_RECORDS 16 // distinct call sites kept with backtrace
+#define RTCHECK_MAX_FRAMES  24
+
+typedef struct {
+	const char* call;  // name of the offending function
+	size_t      size;  // requested bytes, allocations only
+	uint32_t    count; // calls from this site
+	int         n_frames;
+	void*       frames[RTCHECK_MAX_FRAMES];
+} RTCheckRecord;
+
+/* violations of one plugin instance, written by the thread
+ * that is inside rtcheck_enter () / rtcheck_leave ()
+ */
+typedef struct {
+	uint32_t      violations;
+	uint32_t      n_records;
+	RTCheckRecord records[RTCHECK_MAX_RECORDS];
+} RTCheck;
+
+/* call once from a non-realtime thread before the first rtcheck_enter () */
+extern void rtcheck_init (void);
+
+/* until rtcheck_leave (), calls to allocation, lock and file I/O
+ * functions made by the calling thread are recorded in rc */
+extern void rtcheck_enter (RTCheck* rc);
+extern void rtcheck_leave (void);
+
+extern uint32_t rtcheck_violations (const RTCheck* rc);
+
+#else
+
+#define rtcheck_init()
+#define rtcheck_enter(rc)
+#define rtcheck_leave()
+
+#endif
+#endif
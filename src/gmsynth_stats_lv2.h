@@ -0,0 +1,118 @@
+#define GMSYNTH_STATS_URI "http://gareus.org/oss/lv2/gmsynth/stats"
+#define GMSYNTH_STATS_PREFIX GMSYNTH_STATS_URI "#"
+#define GMSYNTH_STATS__interface GMSYNTH_STATS_PREFIX "interface"
+
+/** Render time statistics of a plugin instance. Durations of run()
+ * are given as fraction of the period (n_samples / sample-rate).
+ */
+typedef struct {
+	/** Count of run() calls measured */
+	uint32_t runs;
+	/** Count of runs that took longer than the deadline fraction */
+	uint32_t deadline_misses;
+	/** Median, 99th and 99.9th percentile, upper bound of the
+	 * histogram bin they fall into.
+	 */
+	float p50;
+	float p99;
+	float p999;
+	/** Longest run */
+	float max;
+} GMSynth_Render_Stats;
+
+typedef struct {
+	/** Query the render time statistics since instantiation or
+	 * the last reset. May be called from any thread.
+	 */
+	void (*get)(LV2_Handle instance, GMSynth_Render_Stats* stats);
+
+	/** Clear the statistics. May be called from any thread,
+	 * takes effect with the next run().
+	 */
+	void (*reset)(LV2_Handle instance);
+} GMSynth_Stats_Interface;
+
+#define GMSYNTH_STATS__startup GMSYNTH_STATS_PREFIX "startup"
+
+/** Time spent in the phases of instantiate(), in milliseconds,
+ * and the memory it took.
+ */
+typedef struct {
+	/** Creating the synth settings */
+	float settings;
+	/** Creating the synth with all its channels and voices */
+	float synth;
+	/** Loading the SoundFont */
+	float sfload;
+	/** Iterating the presets, selecting the default programs */
+	float presets;
+	/** Rendering the first 1024 samples */
+	float bootstrap;
+	/** instantiate() as a whole */
+	float total;
+	/** Memory allocations of the synth engine. This is process-wide,
+	 * instances created concurrently by other threads are included.
+	 */
+	uint32_t allocations;
+	/** Growth of the peak resident set size of the process in KiB,
+	 * or -1 if unknown.
+	 */
+	int32_t peak_rss_kib;
+} GMSynth_Startup_Stats;
+
+typedef struct {
+	/** Query the startup profile of the instance. May be called
+	 * from any thread.
+	 */
+	void (*get)(LV2_Handle instance, GMSynth_Startup_Stats* stats);
+} GMSynth_Startup_Interface;
+
+#define GMSYNTH_STATS__rtcheck GMSYNTH_STATS_PREFIX "rtcheck"
+
+/** Real-time safety violations, only provided by debug builds
+ * of the plugin (make RTCHECK=yes).
+ */
+typedef struct {
+	/** Count of calls to allocation, lock or file I/O functions
+	 * made inside run() since instantiation. The call sites are
+	 * logged with a backtrace when the instance is cleaned up.
+	 * May be called from any thread.
+	 */
+	uint32_t (*violations)(LV2_Handle instance);
+} GMSynth_RTCheck_Interface;
+
+#define GMSYNTH_STATS__memory GMSYNTH_STATS_PREFIX "memory"
+
+/** Memory allocated by the synth engine, in bytes */
+typedef struct {
+	/** Sample data of the SoundFont, shared by all instances
+	 * which load the same file */
+	uint64_t samples_shared;
+	/** Sample data owned by one instance (mipmaps) */
+	uint64_t samples_private;
+	/** Presets, instruments and zones of the SoundFont */
+	uint64_t presets;
+	/** Voices, sized by the polyphony */
+	uint64_t voices;
+	/** Mixing buffers and voice lists */
+	uint64_t mixer;
+	/** Reverb and chorus delay lines */
+	uint64_t fx;
+	/** Event queues */
+	uint64_t events;
+	/** Part of all the above that is pinned to RAM (mlock),
+	 * the rest is pageable */
+	uint64_t locked;
+} GMSynth_Memory_Stats;
+
+typedef struct {
+	/** Query the memory of the instance, shared sample data is
+	 * counted in full. Must not be called concurrently with run().
+	 */
+	void (*get)(LV2_Handle instance, GMSynth_Memory_Stats* stats);
+
+	/** Query the memory of all instances in the process, shared
+	 * sample data is counted once. May be called from any thread.
+	 */
+	void (*get_process)(GMSynth_Memory_Stats* stats);
+} GMSynth_Memory_Interface;